@@ -216,9 +216,10 @@ class MockWriteStream : public WriteStream {
     callback_->OnWriteStreamHandshakeComplete();
   }
 
-  void WriteMutations(const std::vector<Mutation>& mutations) override {
+  size_t WriteMutations(const std::vector<Mutation>& mutations) override {
     datastore_->IncrementWriteStreamRequests();
     sent_mutations_.push(mutations);
+    return 0;
   }
 
   /** Injects a write ack as though it had come from the backend in response to a write. */
@@ -72,6 +72,10 @@ using firebase::firestore::util::ThrowInvalidArgument;
 }
 
 - (instancetype)initWithSizeBytes:(NSNumber *)size {
+  return [self initWithSizeBytes:size compressionEnabled:NO];
+}
+
+- (instancetype)initWithSizeBytes:(NSNumber *)size compressionEnabled:(BOOL)compressionEnabled {
   self = [super init];
   if (size.longLongValue != Settings::CacheSizeUnlimited &&
       size.longLongValue < Settings::MinimumCacheSizeBytes) {
@@ -79,7 +83,9 @@ using firebase::firestore::util::ThrowInvalidArgument;
                          Settings::MinimumCacheSizeBytes);
   }
 
-  self.internalSettings = PersistentCacheSettings{}.WithSizeBytes(size.longLongValue);
+  self.internalSettings = PersistentCacheSettings{}
+                              .WithSizeBytes(size.longLongValue)
+                              .WithCompressionEnabled(compressionEnabled);
   return self;
 }
 
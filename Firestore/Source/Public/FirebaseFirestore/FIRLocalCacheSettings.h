@@ -55,6 +55,16 @@ NS_SWIFT_NAME(PersistentCacheSettings)
  */
 - (instancetype)initWithSizeBytes:(NSNumber *)size;
 
+/**
+ * Creates `PersistentCacheSettings` with a custom cache size in bytes, optionally compressing
+ * cached documents on disk.
+ *
+ * Compression shrinks collections of similar documents at the cost of extra CPU time when
+ * documents are read and written. Documents that were compressed remain readable if compression is
+ * later turned off.
+ */
+- (instancetype)initWithSizeBytes:(NSNumber *)size compressionEnabled:(BOOL)compressionEnabled;
+
 @end
 
 /**
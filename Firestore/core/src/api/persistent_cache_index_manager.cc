@@ -41,6 +41,16 @@ void PersistentCacheIndexManager::DeleteAllFieldIndexes() const {
   client_->DeleteAllFieldIndexes();
 }
 
+void PersistentCacheIndexManager::SetIndexBackfillTimeBudget(
+    std::chrono::milliseconds time_budget) const {
+  client_->SetIndexBackfillTimeBudget(time_budget);
+}
+
+void PersistentCacheIndexManager::GetIndexBackfillProgress(
+    std::function<void(const local::IndexBackfillProgress&)> callback) const {
+  client_->GetIndexBackfillProgress(std::move(callback));
+}
+
 }  // namespace api
 }  // namespace firestore
 }  // namespace firebase
@@ -17,6 +17,8 @@
 #ifndef FIRESTORE_CORE_SRC_API_PERSISTENT_CACHE_INDEX_MANAGER_H_
 #define FIRESTORE_CORE_SRC_API_PERSISTENT_CACHE_INDEX_MANAGER_H_
 
+#include <chrono>  // NOLINT(build/c++11)
+#include <functional>
 #include <memory>
 
 namespace firebase {
@@ -26,6 +28,10 @@ namespace core {
 class FirestoreClient;
 }  // namespace core
 
+namespace local {
+struct IndexBackfillProgress;
+}  // namespace local
+
 namespace api {
 
 /**
@@ -62,6 +68,24 @@ class PersistentCacheIndexManager {
    */
   void DeleteAllFieldIndexes() const;
 
+  /**
+   * Sets how long the SDK may spend building indexes in bulk each time it
+   * backfills them, which it does about once a minute. Bulk building only
+   * happens when there are more documents left to index than a regular
+   * backfill handles, such as after an index is added over a large cache.
+   *
+   * Bulk building runs on the worker queue, so reads and writes wait for it.
+   * Defaults to zero, which disables bulk building.
+   */
+  void SetIndexBackfillTimeBudget(std::chrono::milliseconds time_budget) const;
+
+  /**
+   * Reports how many documents have been indexed and whether the indexes are
+   * up to date.
+   */
+  void GetIndexBackfillProgress(
+      std::function<void(const local::IndexBackfillProgress&)> callback) const;
+
  private:
   const std::shared_ptr<core::FirestoreClient> client_;
 };
@@ -23,6 +23,7 @@
 
 #include "Firestore/core/src/api/aggregate_query.h"
 #include "Firestore/core/src/api/firestore.h"
+#include "Firestore/core/src/api/query_cursor.h"
 #include "Firestore/core/src/api/query_listener_registration.h"
 #include "Firestore/core/src/api/query_snapshot.h"
 #include "Firestore/core/src/api/source.h"
@@ -116,6 +117,14 @@ size_t Query::Hash() const {
   return util::Hash(firestore_.get(), query());
 }
 
+QueryCursor Query::GetDocumentsFromCacheInPages(size_t page_size) const {
+  ValidateHasExplicitOrderByForLimitToLast();
+  if (page_size == 0) {
+    ThrowInvalidArgument("Invalid page size. The page size must be positive.");
+  }
+  return QueryCursor(firestore_, query_, page_size);
+}
+
 void Query::GetDocuments(Source source, QuerySnapshotListener&& callback) {
   ValidateHasExplicitOrderByForLimitToLast();
   if (source == Source::Cache) {
@@ -45,6 +45,7 @@ class CompositeFilter;
 namespace api {
 
 class AggregateQuery;
+class QueryCursor;
 
 /**
  * A `Query` refers to a Firestore Query which you can read or listen to. You
@@ -77,6 +78,16 @@ class Query {
    */
   void GetDocuments(Source source, QuerySnapshotListener&& callback);
 
+  /**
+   * Returns a cursor that reads the documents matching this query from the
+   * cache, in query order, `page_size` documents at a time.
+   *
+   * Unlike `GetDocuments(Source::Cache, ...)`, the results are never held in
+   * memory all at once, which makes the cursor suitable for very large result
+   * sets.
+   */
+  QueryCursor GetDocumentsFromCacheInPages(size_t page_size) const;
+
   /**
    * Attaches a listener for QuerySnapshot events.
    *
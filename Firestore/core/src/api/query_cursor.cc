@@ -0,0 +1,66 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/api/query_cursor.h"
+
+#include <utility>
+
+#include "Firestore/core/src/api/document_snapshot.h"
+#include "Firestore/core/src/api/firestore.h"
+#include "Firestore/core/src/core/firestore_client.h"
+#include "Firestore/core/src/core/query.h"
+#include "Firestore/core/src/local/query_cursor.h"
+#include "Firestore/core/src/model/document.h"
+#include "Firestore/core/src/util/statusor.h"
+
+namespace firebase {
+namespace firestore {
+namespace api {
+
+using model::Document;
+using util::StatusOr;
+
+QueryCursor::QueryCursor(std::shared_ptr<Firestore> firestore,
+                         core::Query query,
+                         size_t page_size)
+    : firestore_{std::move(firestore)},
+      cursor_{std::make_shared<local::QueryCursor>(
+          std::move(query), firestore_->database_id(), page_size)} {
+}
+
+void QueryCursor::GetNextPage(PageCallback&& callback) {
+  std::shared_ptr<Firestore> firestore = firestore_;
+  firestore_->client()->ReadQueryCursorPage(
+      cursor_, [firestore, callback](StatusOr<std::vector<Document>> page) {
+        if (!page.ok()) {
+          callback(page.status());
+          return;
+        }
+
+        std::vector<DocumentSnapshot> snapshots;
+        for (const Document& document : page.ValueOrDie()) {
+          SnapshotMetadata metadata(document->has_local_mutations(),
+                                    /*from_cache=*/true);
+          snapshots.push_back(
+              DocumentSnapshot::FromDocument(firestore, document, metadata));
+        }
+        callback(std::move(snapshots));
+      });
+}
+
+}  // namespace api
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_API_QUERY_CURSOR_H_
+#define FIRESTORE_CORE_SRC_API_QUERY_CURSOR_H_
+
+#include <memory>
+#include <vector>
+
+#include "Firestore/core/src/api/api_fwd.h"
+#include "Firestore/core/src/util/status_fwd.h"
+
+namespace firebase {
+namespace firestore {
+
+namespace core {
+class Query;
+}  // namespace core
+
+namespace local {
+class QueryCursor;
+}  // namespace local
+
+namespace api {
+
+/**
+ * Reads the documents matching a query from the cache in pages, in query
+ * order. See `Query::GetDocumentsFromCacheInPages`.
+ */
+class QueryCursor {
+ public:
+  using PageCallback = util::StatusOrCallback<std::vector<DocumentSnapshot>>;
+
+  QueryCursor(std::shared_ptr<Firestore> firestore,
+              core::Query query,
+              size_t page_size);
+
+  /**
+   * Reads the next page of documents via the indicated callback. Once all
+   * documents have been read, the callback receives an empty page.
+   */
+  void GetNextPage(PageCallback&& callback);
+
+ private:
+  std::shared_ptr<Firestore> firestore_;
+  std::shared_ptr<local::QueryCursor> cursor_;
+};
+
+}  // namespace api
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_API_QUERY_CURSOR_H_
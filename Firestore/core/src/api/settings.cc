@@ -106,6 +106,13 @@ MemoryLruGcSettings MemoryLruGcSettings::WithSizeBytes(int64_t size) const {
   return new_settings;
 }
 
+PersistentCacheSettings PersistentCacheSettings::WithCompressionEnabled(
+    bool enabled) const {
+  PersistentCacheSettings new_settings{*this};
+  new_settings.compression_enabled_ = enabled;
+  return new_settings;
+}
+
 MemoryCacheSettings MemoryCacheSettings::WithMemoryGarbageCollectorSettings(
     const MemoryGargabeCollectorSettings& settings) {
   MemoryCacheSettings new_settings(*this);
@@ -184,7 +191,7 @@ size_t MemoryCacheSettings::Hash() const {
 }
 
 size_t PersistentCacheSettings::Hash() const {
-  return util::Hash(kind_, size_bytes_);
+  return util::Hash(kind_, size_bytes_, compression_enabled_);
 }
 
 size_t MemoryEagerGcSettings::Hash() const {
@@ -207,7 +214,8 @@ bool operator!=(const MemoryCacheSettings& lhs,
 
 bool operator==(const PersistentCacheSettings& lhs,
                 const PersistentCacheSettings& rhs) {
-  return lhs.kind() == rhs.kind() && lhs.size_bytes() == rhs.size_bytes();
+  return lhs.kind() == rhs.kind() && lhs.size_bytes() == rhs.size_bytes() &&
+         lhs.compression_enabled() == rhs.compression_enabled();
 }
 
 bool operator!=(const PersistentCacheSettings& lhs,
@@ -299,6 +307,15 @@ bool Settings::gc_enabled() const {
   return persistence_enabled_ && cache_size_bytes_ != CacheSizeUnlimited;
 }
 
+bool Settings::compression_enabled() const {
+  if (cache_settings_ &&
+      cache_settings_->kind() == LocalCacheSettings::Kind::kPersistent) {
+    return static_cast<const PersistentCacheSettings*>(cache_settings_.get())
+        ->compression_enabled_;
+  }
+  return false;
+}
+
 const LocalCacheSettings* Settings::local_cache_settings() const {
   return cache_settings_.get();
 }
@@ -74,6 +74,7 @@ class Settings {
   void set_cache_size_bytes(int64_t value);
   int64_t cache_size_bytes() const;
   bool gc_enabled() const;
+  bool compression_enabled() const;
 
   const LocalCacheSettings* local_cache_settings() const;
   void set_local_cache_settings(const LocalCacheSettings& settings);
@@ -122,15 +123,21 @@ class PersistentCacheSettings : public LocalCacheSettings {
         size_bytes_(Settings::DefaultCacheSizeBytes) {
   }
   PersistentCacheSettings WithSizeBytes(int64_t size) const;
+  PersistentCacheSettings WithCompressionEnabled(bool enabled) const;
 
   int64_t size_bytes() const {
     return size_bytes_;
   }
 
+  bool compression_enabled() const {
+    return compression_enabled_;
+  }
+
   size_t Hash() const override;
 
  private:
   int64_t size_bytes_;
+  bool compression_enabled_ = false;
 };
 
 class MemoryGargabeCollectorSettings {
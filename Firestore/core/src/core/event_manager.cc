@@ -43,6 +43,8 @@ model::TargetId EventManager::AddQueryListener(
   QueryListenersInfo& query_info = inserted.first->second;
 
   query_info.listeners.push_back(listener);
+  listener->set_deferred_snapshot_callback(
+      [this] { RaiseDeferredSnapshotsInSyncEvent(); });
 
   bool raised_event = listener->OnOnlineStateChanged(online_state_);
   HARD_ASSERT(!raised_event,
@@ -64,6 +66,9 @@ model::TargetId EventManager::AddQueryListener(
 
 void EventManager::RemoveQueryListener(
     std::shared_ptr<core::QueryListener> listener) {
+  listener->CancelPendingSnapshot();
+  listener->set_deferred_snapshot_callback(nullptr);
+
   const Query& query = listener->query();
   bool last_listen = false;
 
@@ -78,6 +83,9 @@ void EventManager::RemoveQueryListener(
     queries_.erase(found_iter);
     query_event_source_->StopListening(query);
   }
+
+  // The removed listener may have been the last one holding back a snapshot.
+  RaiseDeferredSnapshotsInSyncEvent();
 }
 
 void EventManager::AddSnapshotsInSyncListener(
@@ -109,12 +117,35 @@ void EventManager::HandleOnlineStateChange(model::OnlineState online_state) {
 }
 
 void EventManager::RaiseSnapshotsInSyncEvent() {
+  if (HasPendingSnapshots()) {
+    snapshots_in_sync_deferred_ = true;
+    return;
+  }
+
+  snapshots_in_sync_deferred_ = false;
   Empty empty{};
   for (const auto& listener : snapshots_in_sync_listeners_) {
     listener->OnEvent(empty);
   }
 }
 
+void EventManager::RaiseDeferredSnapshotsInSyncEvent() {
+  if (snapshots_in_sync_deferred_) {
+    RaiseSnapshotsInSyncEvent();
+  }
+}
+
+bool EventManager::HasPendingSnapshots() const {
+  for (const auto& kv : queries_) {
+    for (const auto& listener : kv.second.listeners) {
+      if (listener->has_pending_snapshot()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 void EventManager::OnViewSnapshots(
     std::vector<core::ViewSnapshot>&& snapshots) {
   bool raised_event = false;
@@ -145,12 +176,14 @@ void EventManager::OnError(const core::Query& query,
 
   QueryListenersInfo& query_info = found_iter->second;
   for (const auto& listener : query_info.listeners) {
+    listener->set_deferred_snapshot_callback(nullptr);
     listener->OnError(error);
   }
 
   // Remove all listeners. NOTE: We don't need to call
   // `SyncEngine::StopListening()` after an error.
   queries_.erase(found_iter);
+  RaiseDeferredSnapshotsInSyncEvent();
 }
 
 bool EventManager::QueryListenersInfo::Erase(
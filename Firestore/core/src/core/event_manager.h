@@ -75,10 +75,22 @@ class EventManager : public SyncEngineCallback {
 
  private:
   /**
-   * Call all global snapshot listeners that have been set.
+   * Call all global snapshot listeners that have been set, unless a query
+   * listener holds back a snapshot because of its minimum snapshot interval.
+   * In that case the event is raised once no snapshot is held back anymore.
    */
   void RaiseSnapshotsInSyncEvent();
 
+  /**
+   * Raises the snapshots-in-sync event that was held back by
+   * `RaiseSnapshotsInSyncEvent()`, if no query listener holds back a snapshot
+   * anymore.
+   */
+  void RaiseDeferredSnapshotsInSyncEvent();
+
+  /** Whether any query listener holds back a snapshot. */
+  bool HasPendingSnapshots() const;
+
   /**
    * Holds the listeners and the last received ViewSnapshot for a query being
    * tracked by EventManager.
@@ -108,6 +120,12 @@ class EventManager : public SyncEngineCallback {
   std::unordered_map<core::Query, QueryListenersInfo> queries_;
   std::unordered_set<std::shared_ptr<EventListener<util::Empty>>>
       snapshots_in_sync_listeners_;
+
+  /**
+   * Whether a snapshots-in-sync event is owed to the listeners once no query
+   * listener holds back a snapshot anymore.
+   */
+  bool snapshots_in_sync_deferred_ = false;
 };
 
 }  // namespace core
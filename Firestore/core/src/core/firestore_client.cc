@@ -16,6 +16,7 @@
 
 #include "Firestore/core/src/core/firestore_client.h"
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <functional>
 #include <future>  // NOLINT(build/c++11)
 #include <memory>
@@ -34,6 +35,7 @@
 #include "Firestore/core/src/core/sync_engine.h"
 #include "Firestore/core/src/core/view.h"
 #include "Firestore/core/src/credentials/credentials_provider.h"
+#include "Firestore/core/src/local/index_backfiller.h"
 #include "Firestore/core/src/local/leveldb_opener.h"
 #include "Firestore/core/src/local/leveldb_persistence.h"
 #include "Firestore/core/src/local/local_documents_view.h"
@@ -42,6 +44,7 @@
 #include "Firestore/core/src/local/memory_lru_reference_delegate.h"
 #include "Firestore/core/src/local/memory_persistence.h"
 #include "Firestore/core/src/local/proto_sizer.h"
+#include "Firestore/core/src/local/query_cursor.h"
 #include "Firestore/core/src/local/query_engine.h"
 #include "Firestore/core/src/local/query_result.h"
 #include "Firestore/core/src/model/aggregate_field.h"
@@ -60,6 +63,7 @@
 #include "Firestore/core/src/util/exception.h"
 #include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/log.h"
+#include "Firestore/core/src/util/phase_timer.h"
 #include "Firestore/core/src/util/status.h"
 #include "Firestore/core/src/util/statusor.h"
 #include "Firestore/core/src/util/string_apple.h"
@@ -83,6 +87,7 @@ using local::LevelDbOpener;
 using local::LocalStore;
 using local::LruParams;
 using local::MemoryPersistence;
+using local::QueryCursor;
 using local::QueryEngine;
 using local::QueryResult;
 using model::AggregateField;
@@ -101,6 +106,7 @@ using remote::Serializer;
 using util::AsyncQueue;
 using util::Empty;
 using util::Executor;
+using util::PhaseTimer;
 using util::Status;
 using util::StatusCallback;
 using util::StatusOr;
@@ -112,6 +118,13 @@ namespace {
 
 static const size_t kMaxConcurrentLimboResolutions = 100;
 
+/**
+ * How many documents in limbo are resolved by a single document target. After
+ * a long offline period this turns thousands of single-document listens into a
+ * handful of round trips.
+ */
+static const size_t kMaxDocumentsPerLimboTarget = 100;
+
 static const auto kInitialGCDelay = std::chrono::minutes(1);
 static const auto kRegularGCDelay = std::chrono::minutes(5);
 
@@ -119,6 +132,12 @@ static const auto kRegularGCDelay = std::chrono::minutes(5);
 static const auto kInitialBackfillDelay = std::chrono::seconds(15);
 /** Minimum amount of time between backfill checks, after the first one. */
 static const auto kRegularBackfillDelay = std::chrono::minutes(1);
+/**
+ * How long each backfill may spend indexing documents in bulk, by default. Bulk
+ * indexing holds up the worker queue, so it is off unless the app opts in.
+ */
+static const auto kDefaultIndexBackfillTimeBudget =
+    std::chrono::milliseconds::zero();
 
 }  // namespace
 
@@ -193,7 +212,8 @@ FirestoreClient::FirestoreClient(
       auth_credentials_provider_(std::move(auth_credentials_provider)),
       worker_queue_(std::move(worker_queue)),
       user_executor_(std::move(user_executor)),
-      firebase_metadata_provider_(std::move(firebase_metadata_provider)) {
+      firebase_metadata_provider_(std::move(firebase_metadata_provider)),
+      index_backfill_time_budget_(kDefaultIndexBackfillTimeBudget) {
 }
 
 void FirestoreClient::Initialize(const User& user, const Settings& settings) {
@@ -204,6 +224,8 @@ void FirestoreClient::Initialize(const User& user, const Settings& settings) {
   // Note: The initialization work must all be synchronous (we can't dispatch
   // more work) since external write/listen operations could get queued to run
   // before that subsequent work completes.
+  PhaseTimer timer;
+
   if (settings.persistence_enabled()) {
     LevelDbOpener opener(database_info_);
 
@@ -218,6 +240,8 @@ void FirestoreClient::Initialize(const User& user, const Settings& settings) {
 
     auto ldb = std::move(created).ValueOrDie();
     lru_delegate_ = ldb->reference_delegate();
+    ldb->remote_document_cache()->set_compression_enabled(
+        settings.compression_enabled());
 
     persistence_ = std::move(ldb);
     if (settings.gc_enabled()) {
@@ -240,6 +264,7 @@ void FirestoreClient::Initialize(const User& user, const Settings& settings) {
   } else {
     persistence_ = MemoryPersistence::WithEagerGarbageCollector();
   }
+  std::chrono::microseconds open_persistence = timer.EndPhase();
 
   query_engine_ = absl::make_unique<QueryEngine>();
   local_store_ = absl::make_unique<LocalStore>(persistence_.get(),
@@ -258,7 +283,8 @@ void FirestoreClient::Initialize(const User& user, const Settings& settings) {
 
   sync_engine_ =
       absl::make_unique<SyncEngine>(local_store_.get(), remote_store_.get(),
-                                    user, kMaxConcurrentLimboResolutions);
+                                    user, kMaxConcurrentLimboResolutions,
+                                    kMaxDocumentsPerLimboTarget);
 
   event_manager_ = absl::make_unique<EventManager>(sync_engine_.get());
 
@@ -267,8 +293,20 @@ void FirestoreClient::Initialize(const User& user, const Settings& settings) {
 
   // NOTE: RemoteStore depends on LocalStore (for persisting stream tokens,
   // refilling mutation queue, etc.) so must be started after LocalStore.
+  // Wiring up the components above is cheap, so it is counted as part of
+  // starting the local store.
   local_store_->Start();
+  std::chrono::microseconds start_local_store = timer.EndPhase();
   remote_store_->Start();
+  std::chrono::microseconds start_remote_store = timer.EndPhase();
+
+  // The breakdown of starting the local store is logged by LocalStore.
+  LOG_DEBUG(
+      "Initialized in %s us (persistence: %s us, local store: %s us, remote "
+      "store: %s us)",
+      (open_persistence + start_local_store + start_remote_store).count(),
+      open_persistence.count(), start_local_store.count(),
+      start_remote_store.count());
 
   ScheduleIndexBackfiller();
 }
@@ -362,7 +400,7 @@ void FirestoreClient::ScheduleIndexBackfiller() {
 
   backfiller_callback_ = worker_queue_->EnqueueAfterDelay(
       delay, TimerId::IndexBackfillDelay, [this] {
-        local_store_->Backfill();
+        local_store_->Backfill(index_backfill_time_budget_);
         backfiller_has_run_ = true;
         ScheduleIndexBackfiller();
       });
@@ -426,6 +464,7 @@ std::shared_ptr<QueryListener> FirestoreClient::ListenToQuery(
 
   auto query_listener = QueryListener::Create(
       std::move(query), std::move(options), std::move(listener));
+  query_listener->set_worker_queue(worker_queue_);
 
   worker_queue_->Enqueue([this, query_listener] {
     event_manager_->AddQueryListener(std::move(query_listener));
@@ -575,6 +614,34 @@ void FirestoreClient::RunAggregateQuery(
   });
 }
 
+void FirestoreClient::ReadQueryCursorPage(
+    std::shared_ptr<QueryCursor> cursor,
+    StatusOrCallback<std::vector<Document>>&& callback) {
+  VerifyNotTerminated();
+
+  worker_queue_->Enqueue([this, cursor, callback] {
+    std::vector<Document> page = local_store_->ReadQueryCursorPage(*cursor);
+    if (callback) {
+      user_executor_->Execute([=] { callback(std::move(page)); });
+    }
+  });
+}
+
+void FirestoreClient::RunAggregateQueryFromLocalCache(
+    const Query& query,
+    const std::vector<AggregateField>& aggregates,
+    api::AggregateQueryCallback&& result_callback) {
+  VerifyNotTerminated();
+
+  worker_queue_->Enqueue([this, query, aggregates, result_callback] {
+    ObjectValue result = local_store_->ExecuteAggregation(query, aggregates);
+    if (result_callback) {
+      user_executor_->Execute(
+          [=] { result_callback(StatusOr<ObjectValue>(result)); });
+    }
+  });
+}
+
 void FirestoreClient::AddSnapshotsInSyncListener(
     const std::shared_ptr<EventListener<Empty>>& user_listener) {
   worker_queue_->Enqueue([this, user_listener] {
@@ -609,6 +676,22 @@ void FirestoreClient::DeleteAllFieldIndexes() {
   worker_queue_->Enqueue([this] { local_store_->DeleteAllFieldIndexes(); });
 }
 
+void FirestoreClient::SetIndexBackfillTimeBudget(
+    std::chrono::milliseconds time_budget) {
+  VerifyNotTerminated();
+  worker_queue_->Enqueue(
+      [this, time_budget] { index_backfill_time_budget_ = time_budget; });
+}
+
+void FirestoreClient::GetIndexBackfillProgress(
+    std::function<void(const local::IndexBackfillProgress&)> callback) {
+  VerifyNotTerminated();
+  worker_queue_->Enqueue([this, callback] {
+    local::IndexBackfillProgress progress = local_store_->backfill_progress();
+    user_executor_->Execute([=] { callback(progress); });
+  });
+}
+
 void FirestoreClient::LoadBundle(
     std::unique_ptr<util::ByteStream> bundle_data,
     std::shared_ptr<api::LoadBundleTask> result_task) {
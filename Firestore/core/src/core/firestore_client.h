@@ -17,6 +17,8 @@
 #ifndef FIRESTORE_CORE_SRC_CORE_FIRESTORE_CLIENT_H_
 #define FIRESTORE_CORE_SRC_CORE_FIRESTORE_CLIENT_H_
 
+#include <chrono>  // NOLINT(build/c++11)
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -40,9 +42,11 @@ namespace firebase {
 namespace firestore {
 
 namespace local {
+struct IndexBackfillProgress;
 class LocalStore;
 class LruDelegate;
 class Persistence;
+class QueryCursor;
 class QueryEngine;
 }  // namespace local
 
@@ -159,6 +163,24 @@ class FirestoreClient : public std::enable_shared_from_this<FirestoreClient> {
                          const std::vector<model::AggregateField>& aggregates,
                          api::AggregateQueryCallback&& result_callback);
 
+  /**
+   * Reads the next page of documents of a cursor over the cache via the
+   * indicated callback. An empty page is delivered once the cursor is
+   * exhausted.
+   */
+  void ReadQueryCursorPage(
+      std::shared_ptr<local::QueryCursor> cursor,
+      util::StatusOrCallback<std::vector<model::Document>>&& callback);
+
+  /**
+   * Computes the aggregations over the documents in the local cache that match
+   * the query, without contacting the backend.
+   */
+  void RunAggregateQueryFromLocalCache(
+      const Query& query,
+      const std::vector<model::AggregateField>& aggregates,
+      api::AggregateQueryCallback&& result_callback);
+
   /**
    * Adds a listener to be called when a snapshots-in-sync event fires.
    */
@@ -191,6 +213,17 @@ class FirestoreClient : public std::enable_shared_from_this<FirestoreClient> {
 
   void DeleteAllFieldIndexes();
 
+  /**
+   * Sets how long each scheduled index backfill may spend indexing documents
+   * in bulk once its regular batch leaves documents unindexed. Zero restricts
+   * backfills to their regular batch.
+   */
+  void SetIndexBackfillTimeBudget(std::chrono::milliseconds time_budget);
+
+  /** Reports the progress of index backfilling to `callback`. */
+  void GetIndexBackfillProgress(
+      std::function<void(const local::IndexBackfillProgress&)> callback);
+
   void LoadBundle(std::unique_ptr<util::ByteStream> bundle_data,
                   std::shared_ptr<api::LoadBundleTask> result_task);
 
@@ -200,6 +233,7 @@ class FirestoreClient : public std::enable_shared_from_this<FirestoreClient> {
   const std::shared_ptr<util::AsyncQueue>& worker_queue() const {
     return worker_queue_;
   }
+
   bool is_terminated() const;
 
  private:
@@ -258,6 +292,7 @@ class FirestoreClient : public std::enable_shared_from_this<FirestoreClient> {
 
   bool gc_has_run_ = false;
   bool backfiller_has_run_ = false;
+  std::chrono::milliseconds index_backfill_time_budget_;
   bool credentials_initialized_ = false;
   local::LruDelegate* _Nullable lru_delegate_;
   util::DelayedOperation lru_callback_;
@@ -17,6 +17,8 @@
 #ifndef FIRESTORE_CORE_SRC_CORE_LISTEN_OPTIONS_H_
 #define FIRESTORE_CORE_SRC_CORE_LISTEN_OPTIONS_H_
 
+#include <chrono>  // NOLINT(build/c++11)
+
 namespace firebase {
 namespace firestore {
 namespace core {
@@ -78,10 +80,27 @@ class ListenOptions {
     return wait_for_sync_when_online_;
   }
 
+  /**
+   * Returns a copy of these options that raises at most one event per
+   * `interval`. Snapshots that arrive sooner are merged and raised together
+   * once the interval has passed. A zero interval raises every snapshot.
+   */
+  ListenOptions WithMinSnapshotInterval(
+      std::chrono::milliseconds interval) const {
+    ListenOptions result = *this;
+    result.min_snapshot_interval_ = interval;
+    return result;
+  }
+
+  std::chrono::milliseconds min_snapshot_interval() const {
+    return min_snapshot_interval_;
+  }
+
  private:
   bool include_query_metadata_changes_ = false;
   bool include_document_metadata_changes_ = false;
   bool wait_for_sync_when_online_ = false;
+  std::chrono::milliseconds min_snapshot_interval_{0};
 };
 
 }  // namespace core
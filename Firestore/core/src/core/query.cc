@@ -280,16 +280,18 @@ model::DocumentComparator Query::Comparator() const {
       });
 }
 
-std::string Query::CanonicalId() const {
+const std::string& Query::CanonicalId() const {
   if (limit_type_ != LimitType::None) {
-    return absl::StrCat(ToTarget().CanonicalId(),
-                        "|lt:", (limit_type_ == LimitType::Last) ? "l" : "f");
+    return memoized_canonical_id_->memoize([&] {
+      return absl::StrCat(ToTarget().CanonicalId(), "|lt:",
+                          (limit_type_ == LimitType::Last) ? "l" : "f");
+    });
   }
   return ToTarget().CanonicalId();
 }
 
 size_t Query::Hash() const {
-  return util::Hash(CanonicalId());
+  return memoized_hash_->memoize([&] { return util::Hash(CanonicalId()); });
 }
 
 std::string Query::ToString() const {
@@ -340,7 +342,7 @@ std::ostream& operator<<(std::ostream& os, const Query& query) {
 }
 
 bool operator==(const Query& lhs, const Query& rhs) {
-  return (lhs.limit_type_ == rhs.limit_type_) &&
+  return (lhs.limit_type_ == rhs.limit_type_) && lhs.Hash() == rhs.Hash() &&
          (lhs.ToTarget() == rhs.ToTarget());
 }
 
@@ -238,7 +238,11 @@ class Query {
    */
   model::DocumentComparator Comparator() const;
 
-  std::string CanonicalId() const;
+  /**
+   * Returns a string that uniquely identifies this query, computed once and
+   * shared by all copies of this query.
+   */
+  const std::string& CanonicalId() const;
 
   std::string ToString() const;
 
@@ -259,6 +263,12 @@ class Query {
   friend std::ostream& operator<<(std::ostream& os, const Query& query);
 
   friend bool operator==(const Query& lhs, const Query& rhs);
+
+  /**
+   * Returns the hash of the canonical ID, computed once and shared by all
+   * copies of this query. Equal queries have equal hashes, so `operator==`
+   * compares hashes before comparing the queries' components.
+   */
   size_t Hash() const;
 
  private:
@@ -303,6 +313,16 @@ class Query {
   mutable std::shared_ptr<util::ThreadSafeMemoizer<Target>> memoized_target_{
       std::make_shared<util::ThreadSafeMemoizer<Target>>()};
 
+  // The canonical ID of this Query instance, if it differs from the canonical
+  // ID of its Target.
+  mutable std::shared_ptr<util::ThreadSafeMemoizer<std::string>>
+      memoized_canonical_id_{
+          std::make_shared<util::ThreadSafeMemoizer<std::string>>()};
+
+  // The hash of the canonical ID of this Query instance.
+  mutable std::shared_ptr<util::ThreadSafeMemoizer<size_t>> memoized_hash_{
+      std::make_shared<util::ThreadSafeMemoizer<size_t>>()};
+
   // The corresponding aggregate Target of this Query instance. Unlike targets
   // for non-aggregate queries, aggregate query targets do not contain
   // normalized order-bys, they only contain explicit order-bys.
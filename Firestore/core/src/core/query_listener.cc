@@ -31,6 +31,38 @@ namespace core {
 using model::OnlineState;
 using model::TargetId;
 using util::Status;
+using util::TimerId;
+
+namespace {
+
+/**
+ * Combines two consecutive snapshots of the same query into one that describes
+ * all of the changes from the state before `earlier` to the state after
+ * `later`.
+ */
+ViewSnapshot MergeSnapshots(const ViewSnapshot& earlier,
+                            const ViewSnapshot& later) {
+  DocumentViewChangeSet changes;
+  for (DocumentViewChange change : earlier.document_changes()) {
+    changes.AddChange(std::move(change));
+  }
+  for (DocumentViewChange change : later.document_changes()) {
+    changes.AddChange(std::move(change));
+  }
+
+  return ViewSnapshot{later.query(),
+                      later.documents(),
+                      earlier.old_documents(),
+                      changes.GetChanges(later.documents().comparator()),
+                      later.mutated_keys(),
+                      later.from_cache(),
+                      earlier.sync_state_changed() ||
+                          later.sync_state_changed(),
+                      later.excludes_metadata_changes(),
+                      later.has_cached_results()};
+}
+
+}  // namespace
 
 std::shared_ptr<QueryListener> QueryListener::Create(
     Query query, ListenOptions options, ViewSnapshotSharedListener&& listener) {
@@ -98,16 +130,75 @@ bool QueryListener::OnViewSnapshot(ViewSnapshot snapshot) {
       RaiseInitialEvent(snapshot);
       raised_event = true;
     }
+  } else if (pending_snapshot_) {
+    // An event is already waiting for the snapshot interval to pass, so this
+    // snapshot is raised along with it.
+    pending_snapshot_ = MergeSnapshots(*pending_snapshot_, snapshot);
   } else if (ShouldRaiseEvent(snapshot)) {
-    listener_->OnEvent(snapshot);
-    raised_event = true;
+    raised_event = RaiseOrDeferEvent(snapshot);
   }
 
   snapshot_ = std::move(snapshot);
   return raised_event;
 }
 
+bool QueryListener::RaiseOrDeferEvent(ViewSnapshot snapshot) {
+  if (snapshot_interval_) {
+    pending_snapshot_ = std::move(snapshot);
+    return false;
+  }
+
+  listener_->OnEvent(std::move(snapshot));
+  StartSnapshotInterval();
+  return true;
+}
+
+void QueryListener::StartSnapshotInterval() {
+  if (options_.min_snapshot_interval().count() == 0) {
+    return;
+  }
+
+  HARD_ASSERT(worker_queue_,
+              "A worker queue is required to limit the snapshot rate");
+  std::weak_ptr<QueryListener> weak_this = shared_from_this();
+  snapshot_interval_ = worker_queue_->EnqueueAfterDelay(
+      options_.min_snapshot_interval(), TimerId::ListenerSnapshotInterval,
+      [weak_this] {
+        if (auto strong_this = weak_this.lock()) {
+          strong_this->OnSnapshotIntervalEnded();
+        }
+      });
+}
+
+void QueryListener::OnSnapshotIntervalEnded() {
+  snapshot_interval_ = {};
+  if (!pending_snapshot_) {
+    return;
+  }
+
+  ViewSnapshot snapshot = std::move(*pending_snapshot_);
+  pending_snapshot_.reset();
+
+  // Merged changes can cancel out, e.g. a document that was added and then
+  // removed again. Metadata changes were only deferred if they are raised.
+  if (!snapshot.document_changes().empty() ||
+      options_.include_query_metadata_changes()) {
+    RaiseOrDeferEvent(std::move(snapshot));
+  }
+
+  if (deferred_snapshot_callback_) {
+    deferred_snapshot_callback_();
+  }
+}
+
+void QueryListener::CancelPendingSnapshot() {
+  snapshot_interval_.Cancel();
+  snapshot_interval_ = {};
+  pending_snapshot_.reset();
+}
+
 void QueryListener::OnError(Status error) {
+  CancelPendingSnapshot();
   listener_->OnEvent(std::move(error));
 }
 
@@ -185,6 +276,7 @@ void QueryListener::RaiseInitialEvent(const ViewSnapshot& snapshot) {
       snapshot.has_cached_results());
   raised_initial_event_ = true;
   listener_->OnEvent(std::move(modified_snapshot));
+  StartSnapshotInterval();
 }
 
 }  // namespace core
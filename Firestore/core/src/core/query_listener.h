@@ -17,6 +17,7 @@
 #ifndef FIRESTORE_CORE_SRC_CORE_QUERY_LISTENER_H_
 #define FIRESTORE_CORE_SRC_CORE_QUERY_LISTENER_H_
 
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -24,6 +25,7 @@
 #include "Firestore/core/src/core/query.h"
 #include "Firestore/core/src/core/view_snapshot.h"
 #include "Firestore/core/src/model/types.h"
+#include "Firestore/core/src/util/async_queue.h"
 #include "Firestore/core/src/util/status_fwd.h"
 #include "absl/types/optional.h"
 
@@ -35,7 +37,7 @@ namespace core {
  * QueryListener takes a series of internal view snapshots and determines when
  * to raise user-facing events.
  */
-class QueryListener {
+class QueryListener : public std::enable_shared_from_this<QueryListener> {
  public:
   static std::shared_ptr<QueryListener> Create(
       Query query,
@@ -63,6 +65,29 @@ class QueryListener {
     return query_;
   }
 
+  /**
+   * Sets the queue on which snapshots held back by
+   * `ListenOptions::min_snapshot_interval()` are raised. Must be called before
+   * the listener receives snapshots if the options limit the snapshot rate.
+   */
+  void set_worker_queue(std::shared_ptr<util::AsyncQueue> worker_queue) {
+    worker_queue_ = std::move(worker_queue);
+  }
+
+  /**
+   * Sets the function called after a snapshot held back by
+   * `ListenOptions::min_snapshot_interval()` was handled once the interval
+   * passed, whether it was raised or its changes cancelled out.
+   */
+  void set_deferred_snapshot_callback(std::function<void()> callback) {
+    deferred_snapshot_callback_ = std::move(callback);
+  }
+
+  /** Whether a snapshot is held back until the snapshot interval passes. */
+  bool has_pending_snapshot() const {
+    return pending_snapshot_.has_value();
+  }
+
   /** The last received view snapshot. */
   const absl::optional<ViewSnapshot>& snapshot() const {
     return snapshot_;
@@ -81,12 +106,34 @@ class QueryListener {
   /** Returns whether a snapshot was raised. */
   virtual bool OnOnlineStateChanged(model::OnlineState online_state);
 
+  /**
+   * Drops any snapshot held back by the rate limit. Called when the listener
+   * is removed.
+   */
+  void CancelPendingSnapshot();
+
  private:
   bool ShouldRaiseInitialEvent(const ViewSnapshot& snapshot,
                                model::OnlineState online_state) const;
   bool ShouldRaiseEvent(const ViewSnapshot& snapshot) const;
   void RaiseInitialEvent(const ViewSnapshot& snapshot);
 
+  /**
+   * Raises `snapshot` unless an event was raised less than
+   * `min_snapshot_interval` ago, in which case it is held back and raised once
+   * the interval has passed. Returns true if the event was raised now.
+   */
+  bool RaiseOrDeferEvent(ViewSnapshot snapshot);
+
+  /**
+   * Starts an interval during which further events are deferred, if the
+   * options limit the snapshot rate.
+   */
+  void StartSnapshotInterval();
+
+  /** Raises the snapshot deferred during the interval that just ended. */
+  void OnSnapshotIntervalEnded();
+
   Query query_;
   ListenOptions options_;
 
@@ -107,6 +154,16 @@ class QueryListener {
   model::OnlineState online_state_ = model::OnlineState::Unknown;
 
   absl::optional<ViewSnapshot> snapshot_;
+
+  /**
+   * The changes received since the last raised event, merged into a single
+   * snapshot, while waiting for `min_snapshot_interval` to pass.
+   */
+  absl::optional<ViewSnapshot> pending_snapshot_;
+
+  std::shared_ptr<util::AsyncQueue> worker_queue_;
+  util::DelayedOperation snapshot_interval_;
+  std::function<void()> deferred_snapshot_callback_;
 };
 
 }  // namespace core
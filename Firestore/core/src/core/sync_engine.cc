@@ -91,12 +91,16 @@ bool ErrorIsInteresting(const Status& error) {
 SyncEngine::SyncEngine(LocalStore* local_store,
                        remote::RemoteStore* remote_store,
                        const credentials::User& initial_user,
-                       size_t max_concurrent_limbo_resolutions)
+                       size_t max_concurrent_limbo_resolutions,
+                       size_t max_documents_per_limbo_target)
     : local_store_(local_store),
       remote_store_(remote_store),
       current_user_(initial_user),
       target_id_generator_(TargetIdGenerator::SyncEngineTargetIdGenerator()),
-      max_concurrent_limbo_resolutions_(max_concurrent_limbo_resolutions) {
+      max_concurrent_limbo_resolutions_(max_concurrent_limbo_resolutions),
+      max_documents_per_limbo_target_(max_documents_per_limbo_target) {
+  HARD_ASSERT(max_documents_per_limbo_target_ > 0,
+              "Limbo targets must resolve at least one document");
 }
 
 void SyncEngine::AssertCallbackExists(absl::string_view source) {
@@ -291,27 +295,23 @@ void SyncEngine::ApplyRemoteEvent(const RemoteEvent& remote_event) {
     }
 
     LimboResolution& limbo_resolution = it->second;
-    // Since this is a limbo resolution lookup, it's for a single document and
-    // it could be added, modified, or removed, but not a combination.
-    auto changed_documents_count = change.added_documents().size() +
-                                   change.modified_documents().size() +
-                                   change.removed_documents().size();
-    HARD_ASSERT(
-        changed_documents_count <= 1,
-        "Limbo resolution for single document contains multiple changes.");
-
-    if (!change.added_documents().empty()) {
-      limbo_resolution.document_received = true;
-    } else if (!change.modified_documents().empty()) {
-      HARD_ASSERT(limbo_resolution.document_received,
+    // Since this is a limbo resolution lookup, each of its documents could be
+    // added, modified, or removed, but not a combination.
+    for (const DocumentKey& key : change.added_documents()) {
+      limbo_resolution.received_documents =
+          limbo_resolution.received_documents.insert(key);
+    }
+    for (const DocumentKey& key : change.modified_documents()) {
+      HARD_ASSERT(limbo_resolution.received_documents.contains(key),
                   "Received change for limbo target document without add.");
-    } else if (!change.removed_documents().empty()) {
-      HARD_ASSERT(limbo_resolution.document_received,
+    }
+    for (const DocumentKey& key : change.removed_documents()) {
+      HARD_ASSERT(limbo_resolution.received_documents.contains(key),
                   "Received remove for limbo target document without add.");
-      limbo_resolution.document_received = false;
-    } else {
-      // This was probably just a CURRENT target change or similar.
+      limbo_resolution.received_documents =
+          limbo_resolution.received_documents.erase(key);
     }
+    // Otherwise this was probably just a CURRENT target change or similar.
   }
 
   DocumentMap changes = local_store_->ApplyRemoteEvent(remote_event);
@@ -323,30 +323,35 @@ void SyncEngine::HandleRejectedListen(TargetId target_id, Status error) {
 
   auto it = active_limbo_resolutions_by_target_.find(target_id);
   if (it != active_limbo_resolutions_by_target_.end()) {
-    DocumentKey limbo_key = it->second.key;
+    DocumentKeySet limbo_keys = it->second.keys;
     // Since this query failed, we won't want to manually unlisten to it.
     // So go ahead and remove it from bookkeeping.
-    active_limbo_targets_by_key_.erase(limbo_key);
+    for (const DocumentKey& limbo_key : limbo_keys) {
+      active_limbo_targets_by_key_.erase(limbo_key);
+    }
     active_limbo_resolutions_by_target_.erase(target_id);
     PumpEnqueuedLimboResolutions();
 
     // TODO(dimond): Retry on transient errors?
 
-    // It's a limbo doc. Create a synthetic event saying it was deleted. This is
-    // kind of a hack. Ideally, we would have a method in the local store to
-    // purge a document. However, it would be tricky to keep all of the local
-    // store's invariants with another method.
-    MutableDocument doc =
-        MutableDocument::NoDocument(limbo_key, SnapshotVersion::None());
+    // They're limbo docs. Create a synthetic event saying they were deleted.
+    // This is kind of a hack. Ideally, we would have a method in the local
+    // store to purge a document. However, it would be tricky to keep all of the
+    // local store's invariants with another method.
 
     // Explicitly instantiate these to work around a bug in the default
     // constructor of the std::unordered_map that comes with GCC 4.8. Without
     // this GCC emits a spurious "chosen constructor is explicit in
     // copy-initialization" error.
-    DocumentKeySet limbo_documents{limbo_key};
+    DocumentKeySet limbo_documents = limbo_keys;
     RemoteEvent::TargetChangeMap target_changes;
     RemoteEvent::TargetMismatchMap target_mismatches;
-    DocumentUpdateMap document_updates{{limbo_key, doc}};
+    DocumentUpdateMap document_updates;
+    for (const DocumentKey& limbo_key : limbo_keys) {
+      document_updates.emplace(
+          limbo_key,
+          MutableDocument::NoDocument(limbo_key, SnapshotVersion::None()));
+    }
 
     RemoteEvent event{SnapshotVersion::None(), std::move(target_changes),
                       std::move(target_mismatches), std::move(document_updates),
@@ -418,9 +423,8 @@ void SyncEngine::HandleOnlineStateChange(model::OnlineState online_state) {
 
 DocumentKeySet SyncEngine::GetRemoteKeys(TargetId target_id) const {
   auto it = active_limbo_resolutions_by_target_.find(target_id);
-  if (it != active_limbo_resolutions_by_target_.end() &&
-      it->second.document_received) {
-    return DocumentKeySet{it->second.key};
+  if (it != active_limbo_resolutions_by_target_.end()) {
+    return it->second.received_documents;
   } else {
     DocumentKeySet keys;
     if (queries_by_target_.count(target_id) == 0) {
@@ -566,15 +570,22 @@ void SyncEngine::TrackLimboChange(const LimboDocumentChange& limbo_change) {
 
 void SyncEngine::PumpEnqueuedLimboResolutions() {
   while (!enqueued_limbo_resolutions_.empty() &&
-         active_limbo_targets_by_key_.size() <
+         active_limbo_resolutions_by_target_.size() <
              max_concurrent_limbo_resolutions_) {
-    DocumentKey key = enqueued_limbo_resolutions_.front();
-    enqueued_limbo_resolutions_.pop_front();
+    DocumentKeySet keys;
+    while (!enqueued_limbo_resolutions_.empty() &&
+           keys.size() < max_documents_per_limbo_target_) {
+      keys = keys.insert(enqueued_limbo_resolutions_.front());
+      enqueued_limbo_resolutions_.pop_front();
+    }
+
     TargetId limbo_target_id = target_id_generator_.NextId();
+    for (const DocumentKey& key : keys) {
+      active_limbo_targets_by_key_.emplace(key, limbo_target_id);
+    }
     active_limbo_resolutions_by_target_.emplace(limbo_target_id,
-                                                LimboResolution{key});
-    active_limbo_targets_by_key_.emplace(key, limbo_target_id);
-    remote_store_->Listen(TargetData(Query(key.path()).ToTarget(),
+                                                LimboResolution{keys});
+    remote_store_->Listen(TargetData(Target::ForDocuments(keys),
                                      limbo_target_id, kIrrelevantSequenceNumber,
                                      QueryPurpose::LimboResolution));
   }
@@ -589,8 +600,18 @@ void SyncEngine::RemoveLimboTarget(const DocumentKey& key) {
   }
 
   TargetId limbo_target_id = it->second;
+  active_limbo_targets_by_key_.erase(it);
+
+  // A multi-document target keeps listening as long as any of its documents
+  // are still in limbo.
+  LimboResolution& limbo_resolution =
+      active_limbo_resolutions_by_target_.at(limbo_target_id);
+  limbo_resolution.keys = limbo_resolution.keys.erase(key);
+  if (!limbo_resolution.keys.empty()) {
+    return;
+  }
+
   remote_store_->StopListening(limbo_target_id);
-  active_limbo_targets_by_key_.erase(key);
   active_limbo_resolutions_by_target_.erase(limbo_target_id);
   PumpEnqueuedLimboResolutions();
 }
@@ -98,10 +98,19 @@ class QueryEventSource {
  */
 class SyncEngine : public remote::RemoteStoreCallback, public QueryEventSource {
  public:
+  /**
+   * @param max_concurrent_limbo_resolutions The maximum number of limbo
+   *     resolution targets that may be active at the same time.
+   * @param max_documents_per_limbo_target The maximum number of documents in
+   *     limbo that are resolved by a single target. Grouping documents into
+   *     a multi-document target reduces the number of round trips needed to
+   *     resolve large numbers of documents, e.g. after a long offline period.
+   */
   SyncEngine(local::LocalStore* local_store,
              remote::RemoteStore* remote_store,
              const credentials::User& initial_user,
-             size_t max_concurrent_limbo_resolutions);
+             size_t max_concurrent_limbo_resolutions,
+             size_t max_documents_per_limbo_target = 1);
 
   // Implements `QueryEventSource`.
   void SetCallback(SyncEngineCallback* callback) override {
@@ -217,23 +226,28 @@ class SyncEngine : public remote::RemoteStoreCallback, public QueryEventSource {
     View view_;
   };
 
-  /** Tracks a limbo resolution. */
+  /** Tracks a limbo resolution target, which may cover several documents. */
   class LimboResolution {
    public:
     LimboResolution() = default;
 
-    explicit LimboResolution(const model::DocumentKey& key) : key{key} {
+    explicit LimboResolution(model::DocumentKeySet keys)
+        : keys{std::move(keys)} {
     }
 
-    model::DocumentKey key;
+    /**
+     * The documents that are still in limbo and are being resolved by this
+     * target.
+     */
+    model::DocumentKeySet keys;
 
     /**
-     * Set to true once we've received a document. This is used in
+     * The documents we've received for this target. This is used in
      * RemoteKeysForTarget and ultimately used by `WatchChangeAggregator` to
-     * decide whether it needs to manufacture a delete event for the target once
+     * decide whether it needs to manufacture delete events for the target once
      * the target is CURRENT.
      */
-    bool document_received = false;
+    model::DocumentKeySet received_documents;
   };
 
   void AssertCallbackExists(absl::string_view source);
@@ -263,7 +277,8 @@ class SyncEngine : public remote::RemoteStoreCallback, public QueryEventSource {
    * subject to a maximum number of concurrent resolutions.
    *
    * The maximum number of concurrent limbo resolutions is defined in
-   * max_concurrent_limbo_resolutions_.
+   * max_concurrent_limbo_resolutions_. Up to max_documents_per_limbo_target_
+   * enqueued documents are resolved by each new target.
    *
    * Without bounding the number of concurrent resolutions, the server can fail
    * with "resource exhausted" errors which can lead to pathological client
@@ -320,6 +335,8 @@ class SyncEngine : public remote::RemoteStoreCallback, public QueryEventSource {
 
   const size_t max_concurrent_limbo_resolutions_;
 
+  const size_t max_documents_per_limbo_target_;
+
   /**
    * The keys of documents that are in limbo for which we haven't yet started a
    * limbo resolution query.
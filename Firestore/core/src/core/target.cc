@@ -22,12 +22,14 @@
 #include <vector>
 
 #include "Firestore/core/src/core/field_filter.h"
+#include "Firestore/core/src/core/query.h"
 #include "Firestore/core/src/model/document_key.h"
 #include "Firestore/core/src/model/field_path.h"
 #include "Firestore/core/src/model/resource_path.h"
 #include "Firestore/core/src/nanopb/message.h"
 #include "Firestore/core/src/nanopb/nanopb_util.h"
 #include "Firestore/core/src/util/equality.h"
+#include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/hashing.h"
 #include "Firestore/core/src/util/maps.h"
 #include "absl/strings/str_cat.h"
@@ -37,6 +39,7 @@ namespace firestore {
 namespace core {
 
 using model::DocumentKey;
+using model::DocumentKeySet;
 using model::FieldPath;
 using model::Segment;
 using util::MapWithInsertionOrder;
@@ -57,6 +60,22 @@ std::vector<google_firestore_v1_Value> MakeValueVector(
 
 }  // namespace
 
+Target Target::ForDocuments(const DocumentKeySet& keys) {
+  HARD_ASSERT(!keys.empty(), "A document target requires at least one key");
+
+  Target target = Query(keys.min()->path()).ToTarget();
+  if (keys.size() > 1) {
+    target.documents_ = keys;
+    // The copy shares its memoized values with the query's target, which does
+    // not include the other keys.
+    target.memoized_canonical_id_ =
+        std::make_shared<util::ThreadSafeMemoizer<std::string>>();
+    target.memoized_hash_ =
+        std::make_shared<util::ThreadSafeMemoizer<size_t>>();
+  }
+  return target;
+}
+
 // MARK: - Accessors
 
 bool Target::IsDocumentQuery() const {
@@ -64,6 +83,12 @@ bool Target::IsDocumentQuery() const {
          filters_.empty();
 }
 
+DocumentKeySet Target::GetDocumentKeys() const {
+  HARD_ASSERT(IsDocumentQuery(), "Target is not a document query: %s",
+              ToString());
+  return documents_.empty() ? DocumentKeySet{DocumentKey{path_}} : documents_;
+}
+
 size_t Target::GetSegmentCount() const {
   std::set<FieldPath> fields;
   bool has_array_segment = false;
@@ -338,11 +363,20 @@ Target::IndexBoundValue Target::GetDescendingBound(
 
 // MARK: - Utilities
 const std::string& Target::CanonicalId() const {
-  if (!canonical_id_.empty()) return canonical_id_;
+  return memoized_canonical_id_->memoize([&] { return ComputeCanonicalId(); });
+}
 
+std::string Target::ComputeCanonicalId() const {
   std::string result;
   absl::StrAppend(&result, path_.CanonicalString());
 
+  if (!documents_.empty()) {
+    absl::StrAppend(&result, "|docs:");
+    for (const DocumentKey& key : documents_) {
+      absl::StrAppend(&result, key.ToString(), ",");
+    }
+  }
+
   if (collection_group_) {
     absl::StrAppend(&result, "|cg:", *collection_group_);
   }
@@ -374,12 +408,11 @@ const std::string& Target::CanonicalId() const {
     absl::StrAppend(&result, end_at_->PositionString());
   }
 
-  canonical_id_ = std::move(result);
-  return canonical_id_;
+  return result;
 }
 
 size_t Target::Hash() const {
-  return util::Hash(CanonicalId());
+  return memoized_hash_->memoize([&] { return util::Hash(CanonicalId()); });
 }
 
 std::string Target::ToString() const {
@@ -391,11 +424,13 @@ std::ostream& operator<<(std::ostream& os, const Target& target) {
 }
 
 bool operator==(const Target& lhs, const Target& rhs) {
-  return lhs.path() == rhs.path() &&
+  return lhs.Hash() == rhs.Hash() && lhs.path() == rhs.path() &&
          util::Equals(lhs.collection_group(), rhs.collection_group()) &&
          lhs.filters() == rhs.filters() && lhs.order_bys() == rhs.order_bys() &&
          lhs.limit() == rhs.limit() && lhs.start_at() == rhs.start_at() &&
-         lhs.end_at() == rhs.end_at();
+         lhs.end_at() == rhs.end_at() &&
+         (!lhs.IsDocumentQuery() ||
+          lhs.GetDocumentKeys() == rhs.GetDocumentKeys());
 }
 
 }  // namespace core
@@ -28,9 +28,12 @@
 #include "Firestore/core/src/core/field_filter.h"
 #include "Firestore/core/src/core/filter.h"
 #include "Firestore/core/src/core/order_by.h"
+#include "Firestore/core/src/model/document_key_set.h"
 #include "Firestore/core/src/model/field_index.h"
 #include "Firestore/core/src/model/resource_path.h"
 #include "Firestore/core/src/remote/serializer.h"
+#include "Firestore/core/src/util/thread_safe_memoizer.h"
+#include "absl/types/optional.h"
 
 namespace firebase {
 namespace firestore {
@@ -39,8 +42,12 @@ namespace bundle {
 class BundleSerializer;
 }  // namespace bundle
 
+namespace core {
+class Target;
+}  // namespace core
+
 namespace local {
-class LevelDbIndexManager;
+std::vector<core::Target> ComputeSubTargets(const core::Target& target);
 }  // namespace local
 
 namespace core {
@@ -69,6 +76,15 @@ class Target {
 
   Target() = default;
 
+  /**
+   * Creates a document target that listens to all of the given documents at
+   * once. `keys` must not be empty.
+   *
+   * A target for a single key is identical to the target of the document query
+   * for that key.
+   */
+  static Target ForDocuments(const model::DocumentKeySet& keys);
+
   // MARK: - Accessors
 
   /** The base path of the target. */
@@ -81,9 +97,15 @@ class Target {
     return collection_group_;
   }
 
-  /** Returns true if this Target is for a specific document. */
+  /** Returns true if this Target is for one or more specific documents. */
   bool IsDocumentQuery() const;
 
+  /**
+   * Returns the keys of the documents targeted by a document query. Contains
+   * more than one key only for targets created by `ForDocuments`.
+   */
+  model::DocumentKeySet GetDocumentKeys() const;
+
   /** The filters on the documents returned by the target. */
   const std::vector<Filter>& filters() const {
     return filters_;
@@ -155,6 +177,11 @@ class Target {
 
   friend std::ostream& operator<<(std::ostream& os, const Target& target);
 
+  /**
+   * Returns the hash of the canonical ID, computed once per instance. Equal
+   * targets have equal hashes, so `operator==` compares hashes before
+   * comparing the targets' components.
+   */
   size_t Hash() const;
 
  private:
@@ -192,7 +219,7 @@ class Target {
   }
   friend class Query;
   friend class remote::Serializer;
-  friend class local::LevelDbIndexManager;
+  friend std::vector<Target> local::ComputeSubTargets(const Target& target);
 
   /** Returns the field filters that target the given field path. */
   std::vector<FieldFilter> GetFieldFiltersForPath(
@@ -217,6 +244,8 @@ class Target {
   IndexBoundValue GetDescendingBound(const model::Segment& segment,
                                      const absl::optional<Bound>& bound) const;
 
+  std::string ComputeCanonicalId() const;
+
   model::ResourcePath path_;
   std::shared_ptr<const std::string> collection_group_;
   std::vector<Filter> filters_;
@@ -225,7 +254,24 @@ class Target {
   absl::optional<Bound> start_at_;
   absl::optional<Bound> end_at_;
 
-  mutable std::string canonical_id_;
+  /**
+   * All of the targeted documents if this is a document target for more than
+   * one document, empty otherwise. `path_` holds the first of them.
+   */
+  model::DocumentKeySet documents_;
+
+  // For properties below, use a `std::shared_ptr<ThreadSafeMemoizer>` rather
+  // than using `ThreadSafeMemoizer` directly so that this class is copyable,
+  // like `Query` does.
+
+  // The canonical ID of this Target instance.
+  mutable std::shared_ptr<util::ThreadSafeMemoizer<std::string>>
+      memoized_canonical_id_{
+          std::make_shared<util::ThreadSafeMemoizer<std::string>>()};
+
+  // The hash of the canonical ID of this Target instance.
+  mutable std::shared_ptr<util::ThreadSafeMemoizer<size_t>> memoized_hash_{
+      std::make_shared<util::ThreadSafeMemoizer<size_t>>()};
 };
 
 bool operator==(const Target& lhs, const Target& rhs);
@@ -17,6 +17,7 @@
 #include "Firestore/core/src/core/transaction.h"
 
 #include <algorithm>
+#include <iterator>
 #include <memory>
 #include <unordered_set>
 #include <utility>
@@ -41,6 +42,7 @@ using firebase::firestore::model::Precondition;
 using firebase::firestore::model::SnapshotVersion;
 using firebase::firestore::model::VerifyMutation;
 using firebase::firestore::remote::Datastore;
+using firebase::firestore::util::AsyncQueue;
 using firebase::firestore::util::Status;
 using firebase::firestore::util::StatusOr;
 
@@ -48,8 +50,9 @@ namespace firebase {
 namespace firestore {
 namespace core {
 
-Transaction::Transaction(std::shared_ptr<Datastore> datastore)
-    : datastore_{datastore} {
+Transaction::Transaction(std::shared_ptr<Datastore> datastore,
+                         std::shared_ptr<AsyncQueue> worker_queue)
+    : datastore_{datastore}, worker_queue_{std::move(worker_queue)} {
 }
 
 Status Transaction::RecordVersion(const Document& doc) {
@@ -91,36 +94,180 @@ void Transaction::Lookup(const std::vector<DocumentKey>& keys,
     return;
   }
 
-  std::shared_ptr<Datastore> datastore = datastore_.lock();
-  if (!datastore) {
+  if (!datastore_.lock()) {
     callback(Status(Error::kErrorFailedPrecondition,
                     "The client has already been terminated."));
     return;
   }
 
+  // Lookups may be issued from any thread; all bookkeeping happens on the
+  // worker queue.
+  worker_queue_->EnqueueRelaxed(
+      [shared_this = shared_from_this(),
+       lookup = PendingLookup{keys, std::move(callback)}]() mutable {
+        shared_this->EnqueueLookup(std::move(lookup));
+      });
+}
+
+void Transaction::Prefetch(const std::vector<DocumentKey>& keys) {
+  worker_queue_->VerifyIsCurrentQueue();
+  FetchDocuments(keys, /*is_prefetch=*/true);
+}
+
+std::vector<DocumentKey> Transaction::GetReadKeys() const {
+  std::vector<DocumentKey> result;
+  result.reserve(read_versions_.size());
+  for (const auto& kv : read_versions_) {
+    result.push_back(kv.first);
+  }
+  return result;
+}
+
+void Transaction::EnqueueLookup(PendingLookup lookup) {
+  batched_lookups_.push_back(std::move(lookup));
+  if (!flush_scheduled_) {
+    flush_scheduled_ = true;
+    worker_queue_->EnqueueRelaxed(
+        [shared_this = shared_from_this()] { shared_this->FlushLookups(); });
+  }
+}
+
+void Transaction::FlushLookups() {
+  flush_scheduled_ = false;
+
+  std::vector<DocumentKey> keys;
+  for (PendingLookup& lookup : batched_lookups_) {
+    keys.insert(keys.end(), lookup.keys.begin(), lookup.keys.end());
+    waiting_lookups_.push_back(std::move(lookup));
+  }
+  batched_lookups_.clear();
+
+  FetchDocuments(keys, /*is_prefetch=*/false);
+  DispatchReadyLookups();
+}
+
+void Transaction::FetchDocuments(const std::vector<DocumentKey>& keys,
+                                 bool is_prefetch) {
+  std::vector<DocumentKey> to_fetch;
+  for (const DocumentKey& key : keys) {
+    if (read_cache_.count(key) == 0 && keys_in_flight_.insert(key).second) {
+      to_fetch.push_back(key);
+    }
+  }
+  if (to_fetch.empty()) return;
+
+  std::shared_ptr<Datastore> datastore = datastore_.lock();
+  if (!datastore) {
+    HandleFetchResult(to_fetch, is_prefetch,
+                      Status(Error::kErrorFailedPrecondition,
+                             "The client has already been terminated."));
+    return;
+  }
+
   datastore->LookupDocuments(
-      keys,
-      [this, callback](const StatusOr<std::vector<Document>>& maybe_documents) {
-        if (!maybe_documents.ok()) {
-          callback(maybe_documents.status());
-          return;
-        }
-
-        const auto& documents = maybe_documents.ValueOrDie();
-        for (const Document& doc : documents) {
-          Status record_error = RecordVersion(doc);
-          if (!record_error.ok()) {
-            callback(record_error);
-            return;
-          }
-        }
-
-        // TODO(varconst): see if `maybe_documents` can be moved into the
-        // callback.
-        callback(maybe_documents);
+      to_fetch, [shared_this = shared_from_this(), to_fetch, is_prefetch](
+                    const StatusOr<std::vector<Document>>& maybe_documents) {
+        shared_this->HandleFetchResult(to_fetch, is_prefetch, maybe_documents);
       });
 }
 
+void Transaction::HandleFetchResult(
+    const std::vector<DocumentKey>& keys,
+    bool is_prefetch,
+    const StatusOr<std::vector<Document>>& maybe_documents) {
+  for (const DocumentKey& key : keys) {
+    keys_in_flight_.erase(key);
+  }
+
+  if (!maybe_documents.ok()) {
+    std::unordered_set<DocumentKey, DocumentKeyHash> failed_keys(keys.begin(),
+                                                                 keys.end());
+    FailWaitingLookups(failed_keys, is_prefetch, maybe_documents.status());
+    return;
+  }
+
+  for (const Document& doc : maybe_documents.ValueOrDie()) {
+    read_cache_.emplace(doc->key(), doc);
+  }
+
+  // The backend answers every requested key with either a document or a
+  // missing result. Lookups waiting for a key that was left out of the
+  // response would otherwise never complete.
+  std::unordered_set<DocumentKey, DocumentKeyHash> missing_keys;
+  for (const DocumentKey& key : keys) {
+    if (read_cache_.count(key) == 0) {
+      missing_keys.insert(key);
+    }
+  }
+  if (!missing_keys.empty()) {
+    FailWaitingLookups(
+        missing_keys, is_prefetch,
+        Status(Error::kErrorInternal,
+               "BatchGetDocuments response is missing a requested document."));
+  }
+
+  DispatchReadyLookups();
+}
+
+void Transaction::FailWaitingLookups(
+    const std::unordered_set<DocumentKey, DocumentKeyHash>& keys,
+    bool is_prefetch,
+    const Status& status) {
+  auto needs_failed_key = [&](const PendingLookup& lookup) {
+    return std::any_of(
+        lookup.keys.begin(), lookup.keys.end(),
+        [&](const DocumentKey& key) { return keys.count(key) > 0; });
+  };
+
+  auto failed = std::stable_partition(
+      waiting_lookups_.begin(), waiting_lookups_.end(),
+      [&](const PendingLookup& lookup) { return !needs_failed_key(lookup); });
+  std::vector<PendingLookup> affected(std::make_move_iterator(failed),
+                                      std::make_move_iterator(
+                                          waiting_lookups_.end()));
+  waiting_lookups_.erase(failed, waiting_lookups_.end());
+
+  for (PendingLookup& lookup : affected) {
+    if (is_prefetch) {
+      // A failed prefetch is only an optimization that didn't work out; fetch
+      // the documents again on behalf of the lookups that were waiting.
+      EnqueueLookup(std::move(lookup));
+    } else {
+      lookup.callback(status);
+    }
+  }
+}
+
+void Transaction::DispatchReadyLookups() {
+  std::vector<PendingLookup> ready;
+  auto waiting = std::stable_partition(
+      waiting_lookups_.begin(), waiting_lookups_.end(),
+      [&](const PendingLookup& lookup) {
+        return !std::all_of(
+            lookup.keys.begin(), lookup.keys.end(),
+            [&](const DocumentKey& key) { return read_cache_.count(key) > 0; });
+      });
+  std::move(waiting, waiting_lookups_.end(), std::back_inserter(ready));
+  waiting_lookups_.erase(waiting, waiting_lookups_.end());
+
+  for (PendingLookup& lookup : ready) {
+    std::vector<Document> documents;
+    Status record_error;
+    for (const DocumentKey& key : lookup.keys) {
+      const Document& doc = read_cache_.at(key);
+      record_error = RecordVersion(doc);
+      if (!record_error.ok()) break;
+      documents.push_back(doc);
+    }
+
+    if (!record_error.ok()) {
+      lookup.callback(record_error);
+    } else {
+      lookup.callback(std::move(documents));
+    }
+  }
+}
+
 void Transaction::WriteMutations(std::vector<Mutation>&& mutations) {
   EnsureCommitNotCalled();
   // `move` will become appropriate once `Mutation` is replaced by the C++
@@ -23,9 +23,11 @@
 #include <unordered_set>
 #include <vector>
 
+#include "Firestore/core/src/model/document.h"
 #include "Firestore/core/src/model/document_key.h"
 #include "Firestore/core/src/model/mutation.h"
 #include "Firestore/core/src/model/snapshot_version.h"
+#include "Firestore/core/src/util/async_queue.h"
 #include "Firestore/core/src/util/status.h"
 #include "Firestore/core/src/util/statusor.h"
 #include "absl/types/any.h"
@@ -36,7 +38,6 @@ namespace firestore {
 
 namespace model {
 class Precondition;
-class Document;
 }  // namespace model
 
 namespace remote {
@@ -48,21 +49,49 @@ namespace core {
 class ParsedSetData;
 class ParsedUpdateData;
 
-class Transaction {
+/**
+ * Internal transaction object responsible for accumulating the mutations to
+ * perform and the base versions for any documents read.
+ *
+ * Transactions are always owned by a `shared_ptr`: work scheduled on the
+ * worker queue or waiting for the backend keeps the transaction alive until
+ * the lookup callbacks have been invoked.
+ */
+class Transaction : public std::enable_shared_from_this<Transaction> {
  public:
   using LookupCallback =
       std::function<void(const util::StatusOr<std::vector<model::Document>>&)>;
 
   Transaction() = default;
-  explicit Transaction(std::shared_ptr<remote::Datastore> datastore);
+  Transaction(std::shared_ptr<remote::Datastore> datastore,
+              std::shared_ptr<util::AsyncQueue> worker_queue);
 
   /**
    * Takes a set of keys and asynchronously attempts to fetch all the documents
    * from the backend, ignoring any local changes.
+   *
+   * Lookups issued within the same turn of the worker queue are coalesced into
+   * a single BatchGetDocuments request. Documents that have already been
+   * fetched by this transaction (or by `Prefetch`) are served without another
+   * round trip, so on a retried attempt reads that are awaited one after
+   * another are all answered by the prefetch request.
    */
   void Lookup(const std::vector<model::DocumentKey>& keys,
               LookupCallback&& callback);
 
+  /**
+   * Fetches the given documents with a single request and keeps them in the
+   * transaction's read cache, without recording them as read. Used by
+   * `TransactionRunner` to fetch the read set of a failed attempt up front
+   * when the transaction is retried.
+   *
+   * Must be called on the worker queue.
+   */
+  void Prefetch(const std::vector<model::DocumentKey>& keys);
+
+  /** Returns the keys of all the documents read by this transaction. */
+  std::vector<model::DocumentKey> GetReadKeys() const;
+
   /**
    * Stores mutation for the given key and set data, to be committed when
    * `Commit` is called.
@@ -100,6 +129,47 @@ class Transaction {
   bool IsPermanentlyFailed() const;
 
  private:
+  struct PendingLookup {
+    std::vector<model::DocumentKey> keys;
+    LookupCallback callback;
+  };
+
+  /**
+   * Adds the lookup to the current batch, scheduling the batch to be sent at
+   * the end of the current worker queue turn. Runs on the worker queue.
+   */
+  void EnqueueLookup(PendingLookup lookup);
+
+  /** Sends a single request for all keys of the current batch. */
+  void FlushLookups();
+
+  /**
+   * Sends a request for all of the `keys` that are neither cached nor already
+   * being fetched.
+   */
+  void FetchDocuments(const std::vector<model::DocumentKey>& keys,
+                      bool is_prefetch);
+
+  void HandleFetchResult(
+      const std::vector<model::DocumentKey>& keys,
+      bool is_prefetch,
+      const util::StatusOr<std::vector<model::Document>>& maybe_documents);
+
+  /**
+   * Removes the waiting lookups that need any of `keys` and either retries
+   * them (for a failed prefetch) or fails them with `status`.
+   */
+  void FailWaitingLookups(
+      const std::unordered_set<model::DocumentKey, model::DocumentKeyHash>&
+          keys,
+      bool is_prefetch,
+      const util::Status& status);
+
+  /**
+   * Completes all waiting lookups whose documents are all in the read cache.
+   */
+  void DispatchReadyLookups();
+
   /**
    * Every time a document is read, this should be called to record its version.
    * If we read two different versions of the same document, this will return an
@@ -130,6 +200,24 @@ class Transaction {
       const model::DocumentKey& key) const;
 
   std::weak_ptr<remote::Datastore> datastore_;
+  std::shared_ptr<util::AsyncQueue> worker_queue_;
+
+  /** Lookups collected during the current worker queue turn. */
+  std::vector<PendingLookup> batched_lookups_;
+  bool flush_scheduled_ = false;
+
+  /** Lookups waiting for some of their documents to be fetched. */
+  std::vector<PendingLookup> waiting_lookups_;
+
+  /** Keys that have been requested from the backend but not returned yet. */
+  std::unordered_set<model::DocumentKey, model::DocumentKeyHash>
+      keys_in_flight_;
+
+  /** Documents fetched by this transaction, by key. */
+  std::unordered_map<model::DocumentKey,
+                     model::Document,
+                     model::DocumentKeyHash>
+      read_cache_;
 
   std::vector<model::Mutation> mutations_;
   bool committed_ = false;
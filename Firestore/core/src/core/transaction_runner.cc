@@ -65,6 +65,9 @@ void TransactionRunner::Run() {
   backoff_.BackoffAndRun([shared_this] {
     std::shared_ptr<Transaction> transaction =
         shared_this->remote_store_->CreateTransaction();
+    if (!shared_this->previous_read_keys_.empty()) {
+      transaction->Prefetch(shared_this->previous_read_keys_);
+    }
     shared_this->update_callback_(
         transaction, [transaction, shared_this](const util::Status& status) {
           shared_this->queue_->Enqueue([transaction, shared_this, status] {
@@ -99,6 +102,7 @@ void TransactionRunner::HandleTransactionError(
     const std::shared_ptr<Transaction>& transaction, Status status) {
   if (attempts_remaining_ > 0 && IsRetryableTransactionError(status) &&
       !transaction->IsPermanentlyFailed()) {
+    previous_read_keys_ = transaction->GetReadKeys();
     Run();
   } else {
     result_callback_(std::move(status));
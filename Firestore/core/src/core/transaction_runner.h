@@ -18,6 +18,7 @@
 #define FIRESTORE_CORE_SRC_CORE_TRANSACTION_RUNNER_H_
 
 #include <memory>
+#include <vector>
 
 #include "Firestore/core/src/core/transaction.h"
 #include "Firestore/core/src/remote/exponential_backoff.h"
@@ -69,6 +70,12 @@ class TransactionRunner
   core::TransactionResultCallback result_callback_;
   remote::ExponentialBackoff backoff_;
   int attempts_remaining_;
+
+  /**
+   * The documents read by the previous, failed attempt. They are fetched with
+   * a single request when the transaction is retried.
+   */
+  std::vector<model::DocumentKey> previous_read_keys_;
 };
 
 }  // namespace core
@@ -61,27 +61,6 @@ ViewDocumentChanges::ViewDocumentChanges(model::DocumentSet new_documents,
 
 // MARK: - View
 
-namespace {
-
-int GetDocumentViewChangeTypePosition(DocumentViewChange::Type change_type) {
-  switch (change_type) {
-    case DocumentViewChange::Type::Removed:
-      return 0;
-    case DocumentViewChange::Type::Added:
-      return 1;
-    case DocumentViewChange::Type::Modified:
-      return 2;
-    case DocumentViewChange::Type::Metadata:
-      // A metadata change is converted to a modified change at the public API
-      // layer. Since we sort by document key and then change type, metadata and
-      // modified changes must be sorted equivalently.
-      return 2;
-  }
-  HARD_FAIL("Unknown DocumentViewChange::Type %s", change_type);
-}
-
-}  // namespace
-
 View::View(Query query, DocumentKeySet remote_documents)
     : query_(std::move(query)),
       document_set_(query_.Comparator()),
@@ -149,7 +128,13 @@ ViewDocumentChanges View::ComputeDocumentChanges(
     bool change_applied = false;
     // Calculate change
     if (old_doc && new_doc) {
-      bool docs_equal = (*old_doc)->value() == (*new_doc)->value();
+      // Fingerprints are cached with the documents, which are shared by all
+      // views that contain them, so most modified documents are detected
+      // without comparing their contents.
+      const model::ObjectValue& old_value = (*old_doc)->data();
+      const model::ObjectValue& new_value = (*new_doc)->data();
+      bool docs_equal = old_value.Fingerprint() == new_value.Fingerprint() &&
+                        old_value == new_value;
       if (!docs_equal) {
         if (!ShouldWaitForSyncedDocument(*new_doc, *old_doc)) {
           change_set.AddChange(
@@ -258,17 +243,7 @@ ViewChange View::ApplyChanges(const ViewDocumentChanges& doc_changes,
 
   // Sort changes based on type and query comparator.
   std::vector<DocumentViewChange> changes =
-      doc_changes.change_set().GetChanges();
-  std::sort(
-      changes.begin(), changes.end(),
-      [this](const DocumentViewChange& lhs, const DocumentViewChange& rhs) {
-        int pos1 = GetDocumentViewChangeTypePosition(lhs.type());
-        int pos2 = GetDocumentViewChangeTypePosition(rhs.type());
-        if (pos1 != pos2) {
-          return pos1 < pos2;
-        }
-        return util::Ascending(Compare(lhs.document(), rhs.document()));
-      });
+      doc_changes.change_set().GetChanges(document_set_.comparator());
 
   ApplyTargetChange(target_change);
   std::vector<LimboDocumentChange> limbo_changes =
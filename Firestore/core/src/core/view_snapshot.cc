@@ -16,9 +16,11 @@
 
 #include "Firestore/core/src/core/view_snapshot.h"
 
+#include <algorithm>
 #include <ostream>
 
 #include "Firestore/core/src/model/document_set.h"
+#include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/hashing.h"
 #include "Firestore/core/src/util/string_format.h"
 #include "Firestore/core/src/util/to_string.h"
@@ -130,6 +132,44 @@ std::vector<DocumentViewChange> DocumentViewChangeSet::GetChanges() const {
   return changes;
 }
 
+namespace {
+
+int GetDocumentViewChangeTypePosition(DocumentViewChange::Type change_type) {
+  switch (change_type) {
+    case DocumentViewChange::Type::Removed:
+      return 0;
+    case DocumentViewChange::Type::Added:
+      return 1;
+    case DocumentViewChange::Type::Modified:
+      return 2;
+    case DocumentViewChange::Type::Metadata:
+      // A metadata change is converted to a modified change at the public API
+      // layer. Since we sort by document key and then change type, metadata and
+      // modified changes must be sorted equivalently.
+      return 2;
+  }
+  HARD_FAIL("Unknown DocumentViewChange::Type %s", change_type);
+}
+
+}  // namespace
+
+std::vector<DocumentViewChange> DocumentViewChangeSet::GetChanges(
+    const model::DocumentComparator& comparator) const {
+  std::vector<DocumentViewChange> changes = GetChanges();
+  std::sort(changes.begin(), changes.end(),
+            [&comparator](const DocumentViewChange& lhs,
+                          const DocumentViewChange& rhs) {
+              int pos1 = GetDocumentViewChangeTypePosition(lhs.type());
+              int pos2 = GetDocumentViewChangeTypePosition(rhs.type());
+              if (pos1 != pos2) {
+                return pos1 < pos2;
+              }
+              return util::Ascending(
+                  comparator.Compare(lhs.document(), rhs.document()));
+            });
+  return changes;
+}
+
 std::string DocumentViewChangeSet::ToString() const {
   return util::ToString(change_map_);
 }
@@ -84,6 +84,14 @@ class DocumentViewChangeSet {
   /** Returns the set of all changes tracked in this set. */
   std::vector<DocumentViewChange> GetChanges() const;
 
+  /**
+   * Returns the set of all changes tracked in this set, in the order a view
+   * reports them: by type (removals, then additions, then modifications) and
+   * then by `comparator`.
+   */
+  std::vector<DocumentViewChange> GetChanges(
+      const model::DocumentComparator& comparator) const;
+
   std::string ToString() const;
 
  private:
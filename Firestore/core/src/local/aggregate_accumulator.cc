@@ -0,0 +1,141 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/aggregate_accumulator.h"
+
+#include <limits>
+#include <utility>
+
+#include "Firestore/core/src/model/document.h"
+#include "Firestore/core/src/model/field_path.h"
+#include "Firestore/core/src/model/object_value.h"
+#include "Firestore/core/src/model/value_util.h"
+#include "Firestore/core/src/nanopb/message.h"
+#include "Firestore/core/src/util/hard_assert.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+namespace {
+
+using model::AggregateField;
+using model::Document;
+using model::FieldPath;
+using model::ObjectValue;
+using nanopb::Message;
+
+bool AddWouldOverflow(int64_t lhs, int64_t rhs) {
+  if (rhs > 0) {
+    return lhs > std::numeric_limits<int64_t>::max() - rhs;
+  }
+  return lhs < std::numeric_limits<int64_t>::min() - rhs;
+}
+
+Message<google_firestore_v1_Value> IntegerValue(int64_t value) {
+  Message<google_firestore_v1_Value> result;
+  result->which_value_type = google_firestore_v1_Value_integer_value_tag;
+  result->integer_value = value;
+  return result;
+}
+
+Message<google_firestore_v1_Value> DoubleValue(double value) {
+  Message<google_firestore_v1_Value> result;
+  result->which_value_type = google_firestore_v1_Value_double_value_tag;
+  result->double_value = value;
+  return result;
+}
+
+}  // namespace
+
+AggregateAccumulator::AggregateAccumulator(
+    std::vector<AggregateField> aggregates)
+    : aggregates_{std::move(aggregates)}, states_(aggregates_.size()) {
+}
+
+bool AggregateAccumulator::counts_only() const {
+  for (const AggregateField& aggregate : aggregates_) {
+    if (aggregate.op != AggregateField::OpKind::Count) return false;
+  }
+  return true;
+}
+
+void AggregateAccumulator::Add(const Document& document) {
+  for (size_t i = 0; i < aggregates_.size(); ++i) {
+    const AggregateField& aggregate = aggregates_[i];
+    State& state = states_[i];
+    ++state.count;
+    if (aggregate.op == AggregateField::OpKind::Count) continue;
+
+    absl::optional<google_firestore_v1_Value> value =
+        document->field(aggregate.fieldPath);
+    if (model::IsInteger(value)) {
+      ++state.numeric_count;
+      int64_t integer = value->integer_value;
+      if (!state.is_double && !AddWouldOverflow(state.integer_sum, integer)) {
+        state.integer_sum += integer;
+      } else {
+        state.is_double = true;
+        state.double_sum += static_cast<double>(integer);
+      }
+    } else if (model::IsDouble(value)) {
+      ++state.numeric_count;
+      state.is_double = true;
+      state.double_sum += value->double_value;
+    }
+  }
+}
+
+void AggregateAccumulator::AddCount(int64_t count) {
+  HARD_ASSERT(counts_only(), "AddCount() requires count-only aggregations");
+  for (State& state : states_) {
+    state.count += count;
+  }
+}
+
+ObjectValue AggregateAccumulator::Result() const {
+  ObjectValue result;
+  for (size_t i = 0; i < aggregates_.size(); ++i) {
+    const AggregateField& aggregate = aggregates_[i];
+    const State& state = states_[i];
+    double sum = state.double_sum + static_cast<double>(state.integer_sum);
+
+    Message<google_firestore_v1_Value> value;
+    switch (aggregate.op) {
+      case AggregateField::OpKind::Count:
+        value = IntegerValue(state.count);
+        break;
+      case AggregateField::OpKind::Sum:
+        value = state.is_double ? DoubleValue(sum)
+                                : IntegerValue(state.integer_sum);
+        break;
+      case AggregateField::OpKind::Avg:
+        if (state.numeric_count == 0) {
+          value = Message<google_firestore_v1_Value>{model::NullValue()};
+        } else {
+          value = DoubleValue(sum / static_cast<double>(state.numeric_count));
+        }
+        break;
+    }
+
+    result.Set(FieldPath{aggregate.alias.StringValue()}, std::move(value));
+  }
+  return result;
+}
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_LOCAL_AGGREGATE_ACCUMULATOR_H_
+#define FIRESTORE_CORE_SRC_LOCAL_AGGREGATE_ACCUMULATOR_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Firestore/core/src/model/aggregate_field.h"
+#include "Firestore/core/src/model/model_fwd.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+/**
+ * Computes count, sum and average aggregations over a stream of documents
+ * without retaining the documents themselves.
+ *
+ * The results follow the backend's semantics: a sum over integers stays an
+ * integer unless it overflows, a sum that includes doubles is a double, and
+ * the average of a field without any numeric values is null. Non-numeric
+ * values are ignored by sum and average.
+ */
+class AggregateAccumulator {
+ public:
+  explicit AggregateAccumulator(std::vector<model::AggregateField> aggregates);
+
+  /**
+   * Returns whether all requested aggregations are counts, in which case the
+   * result can be computed from the number of matching documents alone.
+   */
+  bool counts_only() const;
+
+  /** Folds a document that matches the query into all aggregations. */
+  void Add(const model::Document& document);
+
+  /**
+   * Adds `count` matching documents without inspecting them. Only valid if
+   * `counts_only()` is true.
+   */
+  void AddCount(int64_t count);
+
+  /** Returns the aggregation results, keyed by each aggregation's alias. */
+  model::ObjectValue Result() const;
+
+ private:
+  struct State {
+    int64_t count = 0;
+
+    /** Number of numeric values seen for the aggregated field. */
+    int64_t numeric_count = 0;
+    int64_t integer_sum = 0;
+    double double_sum = 0;
+
+    /** Set once a double was seen or the integer sum overflowed. */
+    bool is_double = false;
+  };
+
+  std::vector<model::AggregateField> aggregates_;
+  std::vector<State> states_;
+};
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_LOCAL_AGGREGATE_ACCUMULATOR_H_
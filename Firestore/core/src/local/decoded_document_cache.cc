@@ -0,0 +1,101 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/decoded_document_cache.h"
+
+#include <utility>
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+using model::DocumentKey;
+using model::MutableDocument;
+
+constexpr size_t DecodedDocumentCache::kDefaultMaxBytes;
+
+absl::optional<MutableDocument> DecodedDocumentCache::Get(
+    const DocumentKey& key) {
+  MutableDocument document;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = entries_by_key_.find(key);
+    if (found == entries_by_key_.end()) {
+      ++stats_.misses;
+      return absl::nullopt;
+    }
+    ++stats_.hits;
+    entries_.splice(entries_.begin(), entries_, found->second);
+    // This shares the cached value, which is never modified. The deep copy
+    // below can therefore happen outside of the lock.
+    document = found->second->document;
+  }
+  return document.Clone();
+}
+
+void DecodedDocumentCache::Put(const MutableDocument& document,
+                               size_t encoded_size) {
+  if (encoded_size > max_bytes_) {
+    return;
+  }
+
+  MutableDocument stored = document.Clone();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = entries_by_key_.find(document.key());
+  if (found != entries_by_key_.end()) {
+    byte_size_ -= found->second->encoded_size;
+    entries_.erase(found->second);
+    entries_by_key_.erase(found);
+  }
+
+  entries_.push_front(Entry{std::move(stored), encoded_size});
+  entries_by_key_.emplace(document.key(), entries_.begin());
+  byte_size_ += encoded_size;
+  TrimLocked(max_bytes_);
+}
+
+void DecodedDocumentCache::Invalidate(const DocumentKey& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = entries_by_key_.find(key);
+  if (found != entries_by_key_.end()) {
+    byte_size_ -= found->second->encoded_size;
+    entries_.erase(found->second);
+    entries_by_key_.erase(found);
+  }
+}
+
+size_t DecodedDocumentCache::byte_size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return byte_size_;
+}
+
+DecodedDocumentCacheStats DecodedDocumentCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void DecodedDocumentCache::TrimLocked(size_t max_bytes) {
+  while (byte_size_ > max_bytes) {
+    const Entry& oldest = entries_.back();
+    byte_size_ -= oldest.encoded_size;
+    entries_by_key_.erase(oldest.document.key());
+    entries_.pop_back();
+  }
+}
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_LOCAL_DECODED_DOCUMENT_CACHE_H_
+#define FIRESTORE_CORE_SRC_LOCAL_DECODED_DOCUMENT_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <mutex>  // NOLINT(build/c++11)
+#include <unordered_map>
+
+#include "Firestore/core/src/model/document_key.h"
+#include "Firestore/core/src/model/mutable_document.h"
+#include "absl/types/optional.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+/** Hit and miss counts of a DecodedDocumentCache. */
+struct DecodedDocumentCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+};
+
+/**
+ * A size-bounded, least recently used cache of documents that were decoded
+ * from their stored form.
+ *
+ * The size of an entry is the size of the encoded document it was decoded
+ * from. Documents are returned as deep copies, so callers may modify them
+ * without affecting the cache. The cache is safe to use from multiple threads.
+ */
+class DecodedDocumentCache {
+ public:
+  /** The default capacity of the cache in bytes of encoded documents. */
+  static constexpr size_t kDefaultMaxBytes = 8 * 1024 * 1024;
+
+  explicit DecodedDocumentCache(size_t max_bytes = kDefaultMaxBytes)
+      : max_bytes_(max_bytes) {
+  }
+
+  /**
+   * Returns a copy of the cached document for `key`, or `nullopt` if the
+   * document has not been decoded since it was last invalidated.
+   */
+  absl::optional<model::MutableDocument> Get(const model::DocumentKey& key);
+
+  /**
+   * Caches `document`, which was decoded from `encoded_size` bytes. Evicts the
+   * least recently used documents until the cache fits its capacity.
+   */
+  void Put(const model::MutableDocument& document, size_t encoded_size);
+
+  /** Drops the cached document for `key`, if any. */
+  void Invalidate(const model::DocumentKey& key);
+
+  /** Returns the number of encoded bytes the cached documents represent. */
+  size_t byte_size() const;
+
+  DecodedDocumentCacheStats stats() const;
+
+ private:
+  struct Entry {
+    model::MutableDocument document;
+    size_t encoded_size;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  void TrimLocked(size_t max_bytes);
+
+  const size_t max_bytes_;
+
+  mutable std::mutex mutex_;
+
+  /** The cached documents, most recently used first. */
+  EntryList entries_;
+  std::unordered_map<model::DocumentKey,
+                     EntryList::iterator,
+                     model::DocumentKeyHash>
+      entries_by_key_;
+  size_t byte_size_ = 0;
+  DecodedDocumentCacheStats stats_;
+};
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_LOCAL_DECODED_DOCUMENT_CACHE_H_
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/document_compression.h"
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <string>
+
+#include "Firestore/core/src/util/status.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+namespace {
+
+using util::Status;
+using util::StatusOr;
+
+/**
+ * The first byte of a compressed document. An encoded `MaybeDocument` always
+ * starts with a field tag, and no field has the number zero, so this byte
+ * tells compressed and uncompressed documents apart.
+ */
+constexpr char kCompressedMarker = '\0';
+
+void WriteVarint(std::string* dest, uint64_t value) {
+  while (value >= 0x80) {
+    dest->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  dest->push_back(static_cast<char>(value));
+}
+
+bool ReadVarint(absl::string_view* src, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64 && !src->empty(); shift += 7) {
+    auto byte = static_cast<uint8_t>(src->front());
+    src->remove_prefix(1);
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Bytef* ToBytes(absl::string_view bytes) {
+  // zlib only declares its inputs const when ZLIB_CONST is defined.
+  return reinterpret_cast<Bytef*>(const_cast<char*>(bytes.data()));
+}
+
+Status DataLoss(absl::string_view message) {
+  return Status(Error::kErrorDataLoss,
+                "Failed to decompress document: " + std::string(message));
+}
+
+}  // namespace
+
+std::string BuildCompressionDictionary(
+    const std::vector<std::string>& samples) {
+  // zlib prefers the most useful strings at the end of the dictionary, so keep
+  // the most recent samples.
+  std::string result;
+  for (const std::string& sample : samples) {
+    result += sample;
+  }
+  if (result.size() > kMaxCompressionDictionarySize) {
+    result.erase(0, result.size() - kMaxCompressionDictionarySize);
+  }
+  return result;
+}
+
+bool IsCompressedDocument(absl::string_view stored) {
+  return !stored.empty() && stored.front() == kCompressedMarker;
+}
+
+absl::optional<std::string> CompressDocument(absl::string_view encoded,
+                                             absl::string_view dictionary) {
+  if (encoded.size() > kMaxCompressedDocumentSize) {
+    return absl::nullopt;
+  }
+
+  z_stream stream{};
+  if (deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+    return absl::nullopt;
+  }
+  if (deflateSetDictionary(&stream, ToBytes(dictionary),
+                           static_cast<uInt>(dictionary.size())) != Z_OK) {
+    deflateEnd(&stream);
+    return absl::nullopt;
+  }
+
+  std::string result(1, kCompressedMarker);
+  WriteVarint(&result, encoded.size());
+  size_t header_size = result.size();
+  result.resize(header_size +
+                deflateBound(&stream, static_cast<uLong>(encoded.size())));
+
+  stream.next_in = ToBytes(encoded);
+  stream.avail_in = static_cast<uInt>(encoded.size());
+  stream.next_out = reinterpret_cast<Bytef*>(&result[header_size]);
+  stream.avail_out = static_cast<uInt>(result.size() - header_size);
+  int status = deflate(&stream, Z_FINISH);
+  deflateEnd(&stream);
+  if (status != Z_STREAM_END) {
+    return absl::nullopt;
+  }
+
+  result.resize(header_size + stream.total_out);
+  if (result.size() >= encoded.size()) {
+    return absl::nullopt;
+  }
+  return result;
+}
+
+StatusOr<std::string> DecompressDocument(absl::string_view stored,
+                                         absl::string_view dictionary) {
+  if (!IsCompressedDocument(stored)) {
+    return DataLoss("missing compression marker");
+  }
+  stored.remove_prefix(1);
+
+  uint64_t size;
+  if (!ReadVarint(&stored, &size)) {
+    return DataLoss("invalid decompressed size");
+  }
+  if (size > kMaxCompressedDocumentSize) {
+    return DataLoss("decompressed size is too large");
+  }
+
+  z_stream stream{};
+  if (inflateInit(&stream) != Z_OK) {
+    return DataLoss("zlib could not be initialized");
+  }
+
+  std::string result(static_cast<size_t>(size), '\0');
+  stream.next_in = ToBytes(stored);
+  stream.avail_in = static_cast<uInt>(stored.size());
+  stream.next_out = reinterpret_cast<Bytef*>(&result[0]);
+  stream.avail_out = static_cast<uInt>(result.size());
+  int status = inflate(&stream, Z_FINISH);
+  if (status == Z_NEED_DICT) {
+    // Fails if `dictionary` is not the one the document was compressed with.
+    status = inflateSetDictionary(&stream, ToBytes(dictionary),
+                                  static_cast<uInt>(dictionary.size()));
+    if (status == Z_OK) {
+      status = inflate(&stream, Z_FINISH);
+    }
+  }
+  bool ok = status == Z_STREAM_END && stream.total_out == size;
+  std::string error = stream.msg ? stream.msg : "corrupt data";
+  inflateEnd(&stream);
+
+  if (!ok) {
+    return DataLoss(error);
+  }
+  return result;
+}
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_LOCAL_DOCUMENT_COMPRESSION_H_
+#define FIRESTORE_CORE_SRC_LOCAL_DOCUMENT_COMPRESSION_H_
+
+#include <string>
+#include <vector>
+
+#include "Firestore/core/src/util/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+/**
+ * The largest useful compression dictionary. zlib only looks back this far,
+ * so any earlier bytes of a dictionary are never referenced.
+ */
+constexpr size_t kMaxCompressionDictionarySize = 32 * 1024;
+
+/**
+ * The largest encoded document that is compressed. Firestore documents are at
+ * most 1 MiB, which leaves room for the document name and metadata. The size
+ * stored in a compressed document is rejected above this bound, so corrupt
+ * data cannot cause a huge allocation.
+ */
+constexpr size_t kMaxCompressedDocumentSize = 2 * 1024 * 1024;
+
+/**
+ * Builds a compression dictionary from encoded sample documents of a single
+ * collection. Documents of a collection tend to share field names and many
+ * string values, which can then be referenced from the dictionary instead of
+ * being repeated in every stored document.
+ */
+std::string BuildCompressionDictionary(const std::vector<std::string>& samples);
+
+/**
+ * Returns whether the stored bytes of a document were produced by
+ * `CompressDocument()` rather than being a plain encoded `MaybeDocument`.
+ */
+bool IsCompressedDocument(absl::string_view stored);
+
+/**
+ * Compresses an encoded document using `dictionary`. Returns nullopt if the
+ * compressed form would not be any smaller than `encoded`, or if `encoded` is
+ * larger than `kMaxCompressedDocumentSize`.
+ */
+absl::optional<std::string> CompressDocument(absl::string_view encoded,
+                                             absl::string_view dictionary);
+
+/**
+ * Restores the encoded document from bytes produced by `CompressDocument()`
+ * with the same `dictionary`.
+ */
+util::StatusOr<std::string> DecompressDocument(absl::string_view stored,
+                                               absl::string_view dictionary);
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_LOCAL_DOCUMENT_COMPRESSION_H_
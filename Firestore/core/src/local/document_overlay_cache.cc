@@ -31,6 +31,7 @@ using model::DocumentKey;
 using model::DocumentKeySet;
 using model::Overlay;
 using model::OverlayByDocumentKeyMap;
+using model::ResourcePath;
 
 void DocumentOverlayCache::GetOverlays(
     OverlayByDocumentKeyMap& dest, const std::set<DocumentKey>& keys) const {
@@ -42,6 +43,20 @@ void DocumentOverlayCache::GetOverlays(
   }
 }
 
+OverlayByDocumentKeyMap DocumentOverlayCache::GetOverlaysInRange(
+    const ResourcePath& collection,
+    const absl::optional<DocumentKey>& start_after,
+    const absl::optional<DocumentKey>& end_at) const {
+  OverlayByDocumentKeyMap result;
+  for (auto& entry : GetOverlays(collection, -1)) {
+    if ((!start_after.has_value() || entry.first > start_after.value()) &&
+        (!end_at.has_value() || entry.first <= end_at.value())) {
+      result.insert(std::move(entry));
+    }
+  }
+  return result;
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
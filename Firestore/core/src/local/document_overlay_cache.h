@@ -86,6 +86,18 @@ class DocumentOverlayCache {
   virtual model::OverlayByDocumentKeyMap GetOverlays(
       const model::ResourcePath& collection, int since_batch_id) const = 0;
 
+  /**
+   * Returns the saved overlays for the documents of the given collection whose
+   * keys sort after `start_after` and up to and including `end_at`.
+   *
+   * Unset bounds are unbounded. Overlays of documents in subcollections are not
+   * returned.
+   */
+  virtual model::OverlayByDocumentKeyMap GetOverlaysInRange(
+      const model::ResourcePath& collection,
+      const absl::optional<model::DocumentKey>& start_after,
+      const absl::optional<model::DocumentKey>& end_at) const;
+
   /**
    * Returns `count` overlays with a batch ID higher than `sinceBatchId` for the
    * provided collection group, processed by ascending batch ID.
@@ -106,6 +118,18 @@ class DocumentOverlayCache {
       int since_batch_id,
       std::size_t count) const = 0;
 
+  /**
+   * Returns whether any overlay exists for a document that is an immediate
+   * child of the given collection.
+   *
+   * This is answered from an in-memory summary and is meant to let readers
+   * skip overlay lookups entirely when there are no pending writes.
+   */
+  virtual bool HasOverlays(const model::ResourcePath& collection) const = 0;
+
+  /** Returns whether any overlay exists for the current user. */
+  virtual bool HasAnyOverlays() const = 0;
+
  private:
   friend class DocumentOverlayCacheTestHelper;
 
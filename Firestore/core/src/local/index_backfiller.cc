@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
 #include <unordered_set>
 #include <utility>
 
@@ -38,16 +39,45 @@ using model::IndexOffset;
  */
 static const size_t kMaxDocumentsToProcess = 50;
 
+/**
+ * The maximum number of documents to process in each transaction of
+ * WriteIndexEntriesInBulk().
+ */
+static const size_t kMaxDocumentsToProcessInBulk = 1000;
+
 }  // namespace
 
 IndexBackfiller::IndexBackfiller() {
   max_documents_to_process_ = kMaxDocumentsToProcess;
+  max_documents_to_process_in_bulk_ = kMaxDocumentsToProcessInBulk;
 }
 
 int IndexBackfiller::WriteIndexEntries(const LocalStore* local_store) {
+  return WriteIndexEntries(local_store, max_documents_to_process_);
+}
+
+int IndexBackfiller::WriteIndexEntriesInBulk(
+    const LocalStore* local_store, std::chrono::milliseconds time_budget) {
+  const auto deadline = std::chrono::steady_clock::now() + time_budget;
+  int documents_processed = 0;
+  do {
+    documents_processed += local_store->persistence_->Run(
+        "Backfill Indexes In Bulk", [&] {
+          return WriteIndexEntries(local_store,
+                                   max_documents_to_process_in_bulk_);
+        });
+  } while (!progress_.up_to_date &&
+           std::chrono::steady_clock::now() < deadline);
+
+  LOG_DEBUG("Backfilled %s documents in bulk", documents_processed);
+  return documents_processed;
+}
+
+int IndexBackfiller::WriteIndexEntries(const LocalStore* local_store,
+                                       size_t max_documents) {
   IndexManager* index_manager = local_store->index_manager();
   std::unordered_set<std::string> processed_collection_groups;
-  size_t documents_remaining = max_documents_to_process_;
+  size_t documents_remaining = max_documents;
   while (documents_remaining > 0) {
     const auto collection_group =
         index_manager->GetNextCollectionGroupToUpdate();
@@ -61,7 +91,12 @@ int IndexBackfiller::WriteIndexEntries(const LocalStore* local_store) {
         local_store, collection_group.value(), documents_remaining);
     processed_collection_groups.insert(collection_group.value());
   }
-  return max_documents_to_process_ - documents_remaining;
+
+  // Running out of documents before reaching the cap means that there were no
+  // more to index.
+  progress_.documents_processed += max_documents - documents_remaining;
+  progress_.up_to_date = documents_remaining > 0;
+  return max_documents - documents_remaining;
 }
 
 int IndexBackfiller::WriteEntriesForCollectionGroup(
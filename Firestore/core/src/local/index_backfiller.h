@@ -15,6 +15,8 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_INDEX_BACKFILLER_H_
 #define FIRESTORE_CORE_SRC_LOCAL_INDEX_BACKFILLER_H_
 
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
 #include <string>
 
 namespace firebase {
@@ -34,6 +36,18 @@ class LocalStore;
 class LocalWriteResult;
 class IndexManager;
 
+/** Progress of index backfilling, as reported by IndexBackfiller. */
+struct IndexBackfillProgress {
+  /** The number of documents indexed since the backfiller was created. */
+  int64_t documents_processed = 0;
+
+  /**
+   * Whether the last backfill indexed every document that needed indexing.
+   * False until the first backfill has run.
+   */
+  bool up_to_date = false;
+};
+
 /** Implements the steps for backfilling indexes. */
 class IndexBackfiller {
  public:
@@ -45,10 +59,32 @@ class IndexBackfiller {
    */
   int WriteIndexEntries(const LocalStore* local_store);
 
+  /**
+   * Writes index entries in transactions of a much larger cap than
+   * WriteIndexEntries(), until every document is indexed or `time_budget` has
+   * elapsed. Returns the number of documents processed.
+   *
+   * Unlike WriteIndexEntries(), this runs its own transactions, so that a new
+   * index over a large cache is built in one run without any one transaction
+   * growing unboundedly.
+   */
+  int WriteIndexEntriesInBulk(const LocalStore* local_store,
+                              std::chrono::milliseconds time_budget);
+
+  const IndexBackfillProgress& progress() const {
+    return progress_;
+  }
+
  private:
   friend class IndexBackfillerTest;
   friend class LocalStoreTestBase;
 
+  /**
+   * Writes index entries for up to `max_documents` documents. Returns the
+   * number of documents processed.
+   */
+  int WriteIndexEntries(const LocalStore* local_store, size_t max_documents);
+
   /**
    * Writes entries for the provided collection group. Returns the number of
    * documents processed.
@@ -66,7 +102,13 @@ class IndexBackfiller {
     max_documents_to_process_ = new_max;
   }
 
+  void SetMaxDocumentsToProcessInBulk(size_t new_max) {
+    max_documents_to_process_in_bulk_ = new_max;
+  }
+
   size_t max_documents_to_process_;
+  size_t max_documents_to_process_in_bulk_;
+  IndexBackfillProgress progress_;
 };
 
 }  // namespace local
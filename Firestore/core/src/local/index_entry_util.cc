@@ -0,0 +1,379 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/index_entry_util.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "Firestore/core/src/core/composite_filter.h"
+#include "Firestore/core/src/core/field_filter.h"
+#include "Firestore/core/src/index/firestore_index_value_writer.h"
+#include "Firestore/core/src/index/index_byte_encoder.h"
+#include "Firestore/core/src/model/document.h"
+#include "Firestore/core/src/model/target_index_matcher.h"
+#include "Firestore/core/src/model/value_util.h"
+#include "Firestore/core/src/util/comparison.h"
+#include "Firestore/core/src/util/logic_utils.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+using core::CompositeFilter;
+using core::Filter;
+using core::Target;
+using index::IndexEncodingBuffer;
+using index::IndexEntry;
+using model::DocumentKey;
+using model::FieldIndex;
+using model::TargetIndexMatcher;
+using util::LogicUtils;
+
+namespace {
+
+bool IsInFilter(const Target& target, const model::FieldPath& field_path) {
+  for (const auto& filter : target.filters()) {
+    if (filter.IsAFieldFilter()) {
+      const core::FieldFilter field_filter(filter);
+      if (field_filter.field() != field_path) {
+        continue;
+      }
+      if (field_filter.op() == core::FieldFilter::Operator::In ||
+          field_filter.op() == core::FieldFilter::Operator::NotIn) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Creates a separate encoder buffer for each element of an array.
+ *
+ * The method appends each value to all existing encoders (e.g. filter("a",
+ * "==", "a1").filter("b", "in", ["b1", "b2"]) becomes ["a1,b1", "a1,b2"]). A
+ * list of new encoders is returned.
+ */
+std::vector<IndexEncodingBuffer> ExpandIndexValues(
+    const std::vector<IndexEncodingBuffer>& buffers,
+    const model::Segment& segment,
+    const google_firestore_v1_Value& value) {
+  std::vector<IndexEncodingBuffer> results;
+  for (size_t idx = 0; idx < value.array_value.values_count; ++idx) {
+    for (const IndexEncodingBuffer& buf : buffers) {
+      IndexEncodingBuffer cloned_buf;
+      cloned_buf.Seed(buf.GetEncodedBytes());
+      WriteIndexValue(value.array_value.values[idx],
+                      cloned_buf.ForKind(segment.kind()));
+      results.push_back(std::move(cloned_buf));
+    }
+  }
+  return results;
+}
+
+/** Returns the byte representation for all encoders. */
+std::vector<std::string> GetEncodedBytes(
+    const std::vector<IndexEncodingBuffer>& buffers) {
+  std::vector<std::string> result;
+  for (const auto& buf : buffers) {
+    result.push_back(buf.GetEncodedBytes());
+  }
+  return result;
+}
+
+/** Generates the lower bound for `arrayValue` and `directionalValue`. */
+IndexEntry GenerateLowerBound(int32_t index_id,
+                              const std::string& array_value,
+                              const std::string& directional_value,
+                              bool inclusive) {
+  IndexEntry entry{index_id, DocumentKey::Empty(), array_value,
+                   directional_value};
+  return inclusive ? entry : entry.Successor();
+}
+
+/** Generates the upper bound for `arrayValue` and `directionalValue`. */
+IndexEntry GenerateUpperBound(int32_t index_id,
+                              const std::string& array_value,
+                              const std::string& directional_value,
+                              bool inclusive) {
+  IndexEntry entry{index_id, DocumentKey::Empty(), array_value,
+                   directional_value};
+  return inclusive ? entry.Successor() : entry;
+}
+
+/** Encodes a single value to the ascending index format. */
+std::string EncodeSingleElement(const google_firestore_v1_Value& value) {
+  IndexEncodingBuffer index_buffer;
+  index::WriteIndexValue(value,
+                         index_buffer.ForKind(model::Segment::kAscending));
+  return index_buffer.GetEncodedBytes();
+}
+
+/**
+ * Returns the byte encoded form of the directional values in the field index.
+ * Returns `nullopt` if the document does not have all fields specified in the
+ * index.
+ */
+absl::optional<std::string> EncodeDirectionalElements(
+    const FieldIndex& index, const model::Document& document) {
+  IndexEncodingBuffer index_buffer;
+  for (const auto& segment : index.GetDirectionalSegments()) {
+    auto field = document->field(segment.field_path());
+    if (!field.has_value()) {
+      return absl::nullopt;
+    }
+    index::WriteIndexValue(field.value(), index_buffer.ForKind(segment.kind()));
+  }
+  return index_buffer.GetEncodedBytes();
+}
+
+/**
+ * Encodes the given field values according to the specification in `target`.
+ * For IN queries, a list of possible values is returned.
+ */
+std::vector<std::string> EncodeValues(const FieldIndex& index,
+                                      const Target& target,
+                                      core::IndexedValues bound_values) {
+  if (!bound_values.has_value()) {
+    return {};
+  }
+
+  std::vector<IndexEncodingBuffer> buffers = {};
+  buffers.emplace_back();
+
+  size_t bound_idx = 0;
+  for (const auto& segment : index.GetDirectionalSegments()) {
+    const google_firestore_v1_Value& value = bound_values.value()[bound_idx++];
+    if (IsInFilter(target, segment.field_path()) && model::IsArray(value)) {
+      buffers = ExpandIndexValues(buffers, segment, value);
+    } else {
+      for (auto& buffer : buffers) {
+        auto* encoder = buffer.ForKind(segment.kind());
+        WriteIndexValue(value, encoder);
+      }
+    }
+  }
+  return GetEncodedBytes(buffers);
+}
+
+/**
+ * Returns a new set of ranges that splits the existing range and excludes any
+ * values that match the `not_in_values` from these ranges. As an example,
+ * '[foo > 2 && foo != 3]` becomes  `[foo > 2 && < 3, foo > 3]`.
+ */
+std::vector<IndexEntryRange> CreateRange(
+    const IndexEntry& lower_bound,
+    const IndexEntry& upper_bound,
+    std::vector<IndexEntry> not_in_values) {
+  // The `not_in_values` need to be sorted and unique so that we can return a
+  // sorted set of non-overlapping ranges.
+  std::sort(not_in_values.begin(), not_in_values.end(),
+            [](const IndexEntry& left, const IndexEntry& right) {
+              return left.CompareTo(right) == util::ComparisonResult::Ascending;
+            });
+  std::vector<IndexEntry> sorted_unique_not_in;
+  for (size_t idx = 0; idx < not_in_values.size(); ++idx) {
+    if (idx == 0 || not_in_values[idx].CompareTo(not_in_values[idx - 1]) !=
+                        util::ComparisonResult::Same) {
+      sorted_unique_not_in.push_back(not_in_values[idx]);
+    }
+  }
+
+  std::vector<IndexEntry> bounds;
+  bounds.push_back(lower_bound);
+  for (const auto& not_in_value : sorted_unique_not_in) {
+    auto cmp_to_lower = not_in_value.CompareTo(lower_bound);
+    auto cmp_to_upper = not_in_value.CompareTo(upper_bound);
+
+    if (cmp_to_lower == util::ComparisonResult::Same) {
+      // `notInValue` is the lower bound. We therefore need to raise the bound
+      // to the next value.
+      bounds[0] = lower_bound.Successor();
+    } else if (cmp_to_lower == util::ComparisonResult::Descending &&
+               cmp_to_upper == util::ComparisonResult::Ascending) {
+      // `notInValue` is in the middle of the range
+      bounds.push_back(not_in_value);
+      bounds.push_back(not_in_value.Successor());
+    } else if (cmp_to_upper == util::ComparisonResult::Descending) {
+      // `notInValue` (and all following values) are out of the range
+      break;
+    }
+  }
+  bounds.push_back(upper_bound);
+
+  std::vector<IndexEntryRange> ranges;
+  for (size_t i = 0; i < bounds.size(); i += 2) {
+    ranges.push_back(IndexEntryRange{bounds[i], bounds[i + 1]});
+  }
+  return ranges;
+}
+
+/** Constructs a vector of ranges that unions all bounds. */
+std::vector<IndexEntryRange> GenerateIndexRanges(
+    int32_t index_id,
+    core::IndexedValues array_values,
+    const std::vector<std::string>& lower_bounds,
+    bool lower_bounds_inclusive,
+    const std::vector<std::string>& upper_bounds,
+    bool upper_bounds_inclusive,
+    std::vector<std::string> not_in_values,
+    const absl::optional<DocumentKey>& start_after) {
+  // The number of total index scans we union together. This is similar to a
+  // disjunctive normal form, but adapted for array values. We create a single
+  // index range per value in an ARRAY_CONTAINS or ARRAY_CONTAINS_ANY filter
+  // combined with the values from the query bounds.
+  size_t total_scans = (array_values.has_value() ? array_values->size() : 1) *
+                       std::max(lower_bounds.size(), upper_bounds.size());
+  size_t scans_per_array_element =
+      total_scans / (array_values.has_value() ? array_values->size() : 1);
+
+  std::vector<IndexEntryRange> index_ranges;
+  for (size_t i = 0; i < total_scans; ++i) {
+    std::string array_value =
+        array_values.has_value()
+            ? EncodeSingleElement(
+                  array_values.value()[i / scans_per_array_element])
+            : "";
+
+    IndexEntry lower_bound = GenerateLowerBound(
+        index_id, array_value, lower_bounds[i % scans_per_array_element],
+        lower_bounds_inclusive);
+    IndexEntry upper_bound = GenerateUpperBound(
+        index_id, array_value, upper_bounds[i % scans_per_array_element],
+        upper_bounds_inclusive);
+
+    std::vector<IndexEntry> not_in_bounds;
+    for (const auto& not_in : not_in_values) {
+      not_in_bounds.push_back(GenerateLowerBound(index_id, array_value, not_in,
+                                                 /* inclusive= */ true));
+    }
+
+    auto new_range =
+        CreateRange(lower_bound, upper_bound, std::move(not_in_bounds));
+    if (start_after.has_value() && lower_bounds_inclusive &&
+        !new_range.empty() &&
+        new_range[0].lower.CompareTo(lower_bound) ==
+            util::ComparisonResult::Same) {
+      new_range[0].lower =
+          IndexEntry{index_id, start_after.value(), array_value,
+                     lower_bound.directional_value()};
+    }
+    index_ranges.insert(index_ranges.end(), new_range.begin(), new_range.end());
+  }
+
+  return index_ranges;
+}
+
+}  // namespace
+
+std::vector<Target> ComputeSubTargets(const Target& target) {
+  std::vector<Target> subtargets;
+  if (target.filters().empty()) {
+    subtargets.push_back(target);
+  } else {
+    // There is an implicit AND operation between all the filters stored in the
+    // target.
+    std::vector<Filter> filters;
+    for (const auto& filter : target.filters()) {
+      filters.push_back(filter);
+    }
+    std::vector<Filter> dnf = LogicUtils::GetDnfTerms(CompositeFilter::Create(
+        std::move(filters), CompositeFilter::Operator::And));
+
+    for (const Filter& term : dnf) {
+      subtargets.push_back({target.path(), target.collection_group(),
+                            term.GetFilters(), target.order_bys(),
+                            target.limit(), target.start_at(),
+                            target.end_at()});
+    }
+  }
+  return subtargets;
+}
+
+absl::optional<FieldIndex> SelectFieldIndex(const Target& target,
+                                            std::vector<FieldIndex> indexes) {
+  TargetIndexMatcher target_index_matcher(target);
+  absl::optional<FieldIndex> result;
+  for (FieldIndex& index : indexes) {
+    if (target_index_matcher.ServedByIndex(index)) {
+      if (!result.has_value() ||
+          result.value().segments().size() < index.segments().size()) {
+        // `index` serves the target, and it has more segments than the current
+        // `result`.
+        result = std::move(index);
+      }
+    }
+  }
+
+  return result;
+}
+
+std::set<IndexEntry> ComputeIndexEntries(const model::Document& document,
+                                         const FieldIndex& index) {
+  std::set<IndexEntry> results;
+
+  auto directional_value = EncodeDirectionalElements(index, document);
+  if (directional_value == absl::nullopt) {
+    return results;
+  }
+
+  auto array_segment = index.GetArraySegment();
+  if (array_segment.has_value()) {
+    auto field_value = document->field(array_segment->field_path());
+    if (field_value.has_value() &&
+        field_value.value().which_value_type ==
+            google_firestore_v1_Value_array_value_tag) {
+      for (pb_size_t i = 0; i < field_value.value().array_value.values_count;
+           ++i) {
+        results.insert(IndexEntry(
+            index.index_id(), document->key(),
+            EncodeSingleElement(field_value.value().array_value.values[i]),
+            directional_value.value()));
+      }
+    }
+  } else {
+    results.insert(IndexEntry(index.index_id(), document->key(), "",
+                              directional_value.value()));
+  }
+
+  return results;
+}
+
+std::vector<IndexEntryRange> ComputeIndexEntryRanges(
+    const FieldIndex& index,
+    const Target& sub_target,
+    const absl::optional<DocumentKey>& start_after) {
+  auto array_values = sub_target.GetArrayValues(index);
+  auto not_in_values = sub_target.GetNotInValues(index);
+  auto lower_bound = sub_target.GetLowerBound(index);
+  auto upper_bound = sub_target.GetUpperBound(index);
+
+  auto encoded_lower = EncodeValues(index, sub_target, lower_bound.values);
+  auto encoded_upper = EncodeValues(index, sub_target, upper_bound.values);
+  auto encoded_not_in = EncodeValues(index, sub_target, not_in_values);
+
+  return GenerateIndexRanges(index.index_id(), array_values, encoded_lower,
+                             lower_bound.inclusive, encoded_upper,
+                             upper_bound.inclusive, encoded_not_in,
+                             start_after);
+}
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_LOCAL_INDEX_ENTRY_UTIL_H_
+#define FIRESTORE_CORE_SRC_LOCAL_INDEX_ENTRY_UTIL_H_
+
+#include <set>
+#include <vector>
+
+#include "Firestore/core/src/core/target.h"
+#include "Firestore/core/src/index/index_entry.h"
+#include "Firestore/core/src/model/field_index.h"
+#include "Firestore/core/src/model/document_key.h"
+#include "Firestore/core/src/model/model_fwd.h"
+#include "absl/types/optional.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+// Storage independent helpers shared by the IndexManager implementations.
+
+/**
+ * A range of index entries, from `lower` (inclusive) to `upper` (exclusive).
+ *
+ * Only the array and directional values of the bounds are meaningful, except
+ * that `lower` may hold the key of a document: the range then starts after the
+ * entry of that document at the lower bound's values. Entries are ordered by
+ * their array value first, their directional value second and their document
+ * key last, which is the order in which LevelDB stores them.
+ */
+struct IndexEntryRange {
+  index::IndexEntry lower;
+  index::IndexEntry upper;
+};
+
+/**
+ * Splits the target into its sub-targets. Each sub-target contains only one
+ * term from the target's disjunctive normal form (DNF).
+ */
+std::vector<core::Target> ComputeSubTargets(const core::Target& target);
+
+/**
+ * Returns the index with the most segments among `indexes` that can be used to
+ * serve the provided target, or `nullopt` if none of them can.
+ */
+absl::optional<model::FieldIndex> SelectFieldIndex(
+    const core::Target& target, std::vector<model::FieldIndex> indexes);
+
+/** Creates the index entries for the given document. */
+std::set<index::IndexEntry> ComputeIndexEntries(const model::Document& document,
+                                                const model::FieldIndex& index);
+
+/**
+ * Returns the ranges of entries in `index` that hold the documents matching
+ * `sub_target`. The union of all ranges is the result of the sub-target.
+ *
+ * If `start_after` is set and the sub-target's lower bound is inclusive, the
+ * entries at the lower bound are skipped up to and including the entry of
+ * `start_after`. A sub-target that starts at the position of `start_after` then
+ * only yields the documents that sort after it.
+ */
+std::vector<IndexEntryRange> ComputeIndexEntryRanges(
+    const model::FieldIndex& index,
+    const core::Target& sub_target,
+    const absl::optional<model::DocumentKey>& start_after);
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_LOCAL_INDEX_ENTRY_UTIL_H_
@@ -140,6 +140,19 @@ class IndexManager {
   virtual absl::optional<std::vector<model::DocumentKey>>
   GetDocumentsMatchingTarget(const core::Target& target) = 0;
 
+  /**
+   * Returns the documents that match the given target after `start_after`, or
+   * `nullopt` if the query cannot be served from an index.
+   *
+   * The target's `start_at` bound must be the inclusive position of the
+   * `start_after` document. The index entries at that position are only
+   * returned for documents that sort after `start_after`, so a limit on the
+   * target is not used up by documents that were already read.
+   */
+  virtual absl::optional<std::vector<model::DocumentKey>>
+  GetDocumentsMatchingTarget(const core::Target& target,
+                             const model::DocumentKey& start_after) = 0;
+
   /**
    * Returns the next collection group to update. Returns `nullopt` if no
    * group exists.
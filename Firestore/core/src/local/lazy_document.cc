@@ -0,0 +1,172 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/lazy_document.h"
+
+#include <utility>
+
+#include "Firestore/Protos/nanopb/firestore/local/maybe_document.nanopb.h"
+#include "Firestore/Protos/nanopb/google/firestore/v1/document.nanopb.h"
+#include "Firestore/core/src/core/query.h"
+#include "Firestore/core/src/model/field_path.h"
+#include "Firestore/core/src/model/mutable_document.h"
+#include "Firestore/core/src/model/object_value.h"
+#include "Firestore/core/src/model/snapshot_version.h"
+#include "Firestore/core/src/nanopb/message.h"
+#include "Firestore/core/src/nanopb/reader.h"
+#include "Firestore/core/src/util/hard_assert.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+namespace {
+
+using core::FieldFilter;
+using core::Filter;
+using core::OrderBy;
+using core::Query;
+using model::DocumentKey;
+using model::FieldPath;
+using model::MutableDocument;
+using model::ObjectValue;
+using model::SnapshotVersion;
+using nanopb::Message;
+using nanopb::StringReader;
+
+const uint32_t kFieldsEntryKeyTag =
+    google_firestore_v1_Document_FieldsEntry_key_tag;
+const uint32_t kFieldsEntryValueTag =
+    google_firestore_v1_Document_FieldsEntry_value_tag;
+
+/**
+ * Calls `callback` with the tag and contents of every length-delimited field
+ * of the encoded proto `message`, skipping over all other fields without
+ * decoding them. Returns false if `message` is malformed.
+ */
+template <typename F>
+bool ForEachDelimitedField(absl::string_view message, const F& callback) {
+  pb_istream_t stream = pb_istream_from_buffer(
+      reinterpret_cast<const pb_byte_t*>(message.data()), message.size());
+  while (stream.bytes_left > 0) {
+    pb_wire_type_t wire_type;
+    uint32_t tag;
+    bool eof;
+    if (!pb_decode_tag(&stream, &wire_type, &tag, &eof)) {
+      return false;
+    }
+
+    if (wire_type != PB_WT_STRING) {
+      if (!pb_skip_field(&stream, wire_type)) {
+        return false;
+      }
+      continue;
+    }
+
+    uint64_t size;
+    if (!pb_decode_varint(&stream, &size) || size > stream.bytes_left) {
+      return false;
+    }
+    size_t offset = message.size() - stream.bytes_left;
+    callback(tag, message.substr(offset, static_cast<size_t>(size)));
+    if (!pb_read(&stream, nullptr, static_cast<size_t>(size))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void AddTopLevelField(LazyDocument::FieldNames& fields,
+                      const FieldPath& path) {
+  if (!path.empty() && !path.IsKeyFieldPath()) {
+    fields.insert(path.first_segment());
+  }
+}
+
+}  // namespace
+
+LazyDocument::LazyDocument(DocumentKey key, absl::string_view encoded)
+    : key_(std::move(key)) {
+  bool ok = ForEachDelimitedField(
+      encoded, [&](uint32_t tag, absl::string_view contents) {
+        if (tag == firestore_client_MaybeDocument_document_tag) {
+          document_ = contents;
+        }
+      });
+  HARD_ASSERT(ok, "MaybeDocument proto for key (%s) failed to parse",
+              key_.ToString());
+}
+
+LazyDocument::FieldNames LazyDocument::FieldsToMatch(const Query& query) {
+  FieldNames result;
+  for (const Filter& filter : query.filters()) {
+    for (const FieldFilter& field_filter : filter.GetFlattenedFilters()) {
+      AddTopLevelField(result, field_filter.field());
+    }
+  }
+  // Bounds are evaluated against the order-by fields.
+  for (const OrderBy& order_by : query.normalized_order_bys()) {
+    AddTopLevelField(result, order_by.field());
+  }
+  return result;
+}
+
+bool LazyDocument::Matches(const Query& query, const FieldNames& fields) const {
+  if (!document_) {
+    return false;
+  }
+
+  ObjectValue data;
+  bool ok = ForEachDelimitedField(
+      *document_, [&](uint32_t tag, absl::string_view entry) {
+        if (tag != google_firestore_v1_Document_fields_tag) {
+          return;
+        }
+
+        absl::string_view name;
+        absl::string_view value;
+        bool entry_ok = ForEachDelimitedField(
+            entry, [&](uint32_t entry_tag, absl::string_view contents) {
+              if (entry_tag == kFieldsEntryKeyTag) {
+                name = contents;
+              } else if (entry_tag == kFieldsEntryValueTag) {
+                value = contents;
+              }
+            });
+        HARD_ASSERT(entry_ok, "Field of document (%s) failed to parse",
+                    key_.ToString());
+        if (fields.find(name) == fields.end()) {
+          return;
+        }
+
+        StringReader reader{value};
+        auto message = Message<google_firestore_v1_Value>::TryParse(&reader);
+        HARD_ASSERT(reader.ok(), "Field of document (%s) failed to parse: %s",
+                    key_.ToString(), reader.status().ToString());
+        data.Set(FieldPath{std::string(name)}, std::move(message));
+      });
+  HARD_ASSERT(ok, "Document proto for key (%s) failed to parse",
+              key_.ToString());
+
+  // Only the fields the query looks at are needed to evaluate it, so the
+  // version is left unset.
+  return query.Matches(MutableDocument::FoundDocument(
+      key_, SnapshotVersion::None(), std::move(data)));
+}
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
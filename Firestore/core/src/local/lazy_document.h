@@ -0,0 +1,84 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_LOCAL_LAZY_DOCUMENT_H_
+#define FIRESTORE_CORE_SRC_LOCAL_LAZY_DOCUMENT_H_
+
+#include <functional>
+#include <set>
+#include <string>
+
+#include "Firestore/core/src/model/document_key.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace firebase {
+namespace firestore {
+
+namespace core {
+class Query;
+}  // namespace core
+
+namespace local {
+
+/**
+ * A remote document kept in its encoded `MaybeDocument` form, whose fields are
+ * decoded only when they are needed.
+ *
+ * Matching a query only requires the top-level fields that the query filters
+ * or orders by. Scanning the wire format for just those fields avoids
+ * decoding and sorting every field of a document that is then discarded.
+ */
+class LazyDocument {
+ public:
+  /** A set of top-level field names that supports lookups by string_view. */
+  using FieldNames = std::set<std::string, std::less<>>;
+
+  /**
+   * Creates a lazy document over the given encoded `MaybeDocument` proto. The
+   * bytes must remain valid for the lifetime of this `LazyDocument`.
+   */
+  LazyDocument(model::DocumentKey key, absl::string_view encoded);
+
+  /**
+   * Returns the names of the top-level fields that `query` reads when
+   * evaluating whether a document matches.
+   */
+  static FieldNames FieldsToMatch(const core::Query& query);
+
+  /** Returns whether the encoded document is a found document. */
+  bool is_found_document() const {
+    return document_.has_value();
+  }
+
+  /**
+   * Returns whether the document matches `query`, decoding only the top-level
+   * fields in `fields`. `fields` must include `FieldsToMatch(query)`.
+   */
+  bool Matches(const core::Query& query, const FieldNames& fields) const;
+
+ private:
+  model::DocumentKey key_;
+
+  /** The encoded `Document` message if this is a found document. */
+  absl::optional<absl::string_view> document_;
+};
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_LOCAL_LAZY_DOCUMENT_H_
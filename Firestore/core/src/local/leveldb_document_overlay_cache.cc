@@ -16,8 +16,11 @@
 
 #include "Firestore/core/src/local/leveldb_document_overlay_cache.h"
 
+#include <algorithm>
+#include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/credentials/user.h"
 #include "Firestore/core/src/local/leveldb_key.h"
@@ -85,15 +88,72 @@ void LevelDbDocumentOverlayCache::RemoveOverlaysForBatchId(int batch_id) {
       batch_id, [&](LevelDbDocumentOverlayKey&& key) { DeleteOverlay(key); });
 }
 
+void LevelDbDocumentOverlayCache::GetOverlays(
+    OverlayByDocumentKeyMap& dest, const std::set<DocumentKey>& keys) const {
+  // The keys are sorted in the same order as the overlays table, so a single
+  // iterator visits all of them moving forward only. Seeking is only necessary
+  // when the iterator is positioned before the next key's prefix.
+  auto it = db_->current_transaction()->NewIterator();
+  LevelDbDocumentOverlayKey key;
+  for (const DocumentKey& document_key : keys) {
+    const std::string key_prefix =
+        LevelDbDocumentOverlayKey::KeyPrefix(user_id_, document_key);
+    if (!it->Valid() || it->key() < key_prefix) {
+      it->Seek(key_prefix);
+    }
+    if (!it->Valid()) {
+      break;
+    }
+    if (!absl::StartsWith(it->key(), key_prefix)) {
+      continue;
+    }
+
+    HARD_ASSERT(key.Decode(it->key()));
+    if (key.document_key() == document_key) {
+      dest[document_key] = ParseOverlay(key, it->value());
+    }
+  }
+}
+
 OverlayByDocumentKeyMap LevelDbDocumentOverlayCache::GetOverlays(
     const ResourcePath& collection, int since_batch_id) const {
+  // The collection index only holds entries for the collection's own
+  // documents, starting at the requested batch ID, so neither subcollections
+  // nor older overlays are visited.
+  std::vector<LevelDbDocumentOverlayKey> keys;
+  ForEachKeyInCollection(collection, since_batch_id,
+                         [&](LevelDbDocumentOverlayKey&& key) {
+                           keys.push_back(std::move(key));
+                         });
+  return ReadOverlays(std::move(keys));
+}
+
+OverlayByDocumentKeyMap LevelDbDocumentOverlayCache::GetOverlaysInRange(
+    const ResourcePath& collection,
+    const absl::optional<DocumentKey>& start_after,
+    const absl::optional<DocumentKey>& end_at) const {
+  const std::string key_prefix =
+      LevelDbDocumentOverlayKey::KeyPrefix(user_id_, collection);
+  const size_t document_path_length = collection.size() + 1;
+
   OverlayByDocumentKeyMap result;
-  ForEachKeyInCollection(
-      collection, since_batch_id, [&](LevelDbDocumentOverlayKey&& key) {
-        absl::optional<Overlay> overlay = GetOverlay(key);
-        HARD_ASSERT(overlay.has_value());
-        result[std::move(key).document_key()] = std::move(overlay).value();
-      });
+  auto it = db_->current_transaction()->NewIterator();
+  it->Seek(start_after.has_value() ? LevelDbDocumentOverlayKey::KeyPrefix(
+                                         user_id_, start_after.value())
+                                   : key_prefix);
+  LevelDbDocumentOverlayKey key;
+  for (; it->Valid() && absl::StartsWith(it->key(), key_prefix); it->Next()) {
+    HARD_ASSERT(key.Decode(it->key()));
+    const DocumentKey& document_key = key.document_key();
+    if (end_at.has_value() && document_key > end_at.value()) {
+      break;
+    }
+    if (document_key.path().size() != document_path_length ||
+        (start_after.has_value() && document_key <= start_after.value())) {
+      continue;
+    }
+    result[document_key] = ParseOverlay(key, it->value());
+  }
   return result;
 }
 
@@ -102,25 +162,48 @@ OverlayByDocumentKeyMap LevelDbDocumentOverlayCache::GetOverlays(
     int since_batch_id,
     std::size_t count) const {
   absl::optional<int> current_batch_id;
-  OverlayByDocumentKeyMap result;
+  std::vector<LevelDbDocumentOverlayKey> keys;
   ForEachKeyInCollectionGroup(
       collection_group, since_batch_id,
       [&](LevelDbDocumentOverlayKey&& key) -> ForEachKeyAction {
         if (!current_batch_id.has_value()) {
           current_batch_id = key.largest_batch_id();
         } else if (current_batch_id.value() != key.largest_batch_id()) {
-          if (result.size() >= count) {
+          if (keys.size() >= count) {
             return ForEachKeyAction::kStop;
           }
           current_batch_id = key.largest_batch_id();
         }
 
-        absl::optional<Overlay> overlay = GetOverlay(key);
-        HARD_ASSERT(overlay.has_value());
-        result[std::move(key).document_key()] = std::move(overlay).value();
+        keys.push_back(std::move(key));
         return ForEachKeyAction::kKeepGoing;
       });
-  return result;
+  return ReadOverlays(std::move(keys));
+}
+
+bool LevelDbDocumentOverlayCache::HasOverlays(
+    const ResourcePath& collection) const {
+  return summary().Contains(collection);
+}
+
+bool LevelDbDocumentOverlayCache::HasAnyOverlays() const {
+  return !summary().empty();
+}
+
+const OverlayCollectionSummary& LevelDbDocumentOverlayCache::summary() const {
+  if (!summary_loaded_) {
+    const std::string key_prefix =
+        LevelDbDocumentOverlayKey::KeyPrefix(user_id_);
+    auto it = db_->current_transaction()->NewIterator();
+    LevelDbDocumentOverlayKey key;
+    for (it->Seek(key_prefix);
+         it->Valid() && absl::StartsWith(it->key(), key_prefix); it->Next()) {
+      HARD_ASSERT(key.Decode(it->key()));
+      summary_.Add(key.document_key());
+    }
+    summary_loaded_ = true;
+  }
+  return summary_;
 }
 
 int LevelDbDocumentOverlayCache::GetOverlayCount() const {
@@ -177,6 +260,9 @@ void LevelDbDocumentOverlayCache::SaveOverlay(int largest_batch_id,
   // Add the overlay to the database and index entries pointing to it.
   auto* transaction = db_->current_transaction();
   transaction->Put(key.Encode(), serializer_->EncodeMutation(mutation));
+  if (summary_loaded_) {
+    summary_.Add(document_key);
+  }
   transaction->Put(LevelDbDocumentOverlayLargestBatchIdIndexKey::Key(key), "");
   transaction->Put(LevelDbDocumentOverlayCollectionIndexKey::Key(key), "");
 
@@ -209,6 +295,9 @@ void LevelDbDocumentOverlayCache::DeleteOverlay(
     const LevelDbDocumentOverlayKey& key) {
   auto* transaction = db_->current_transaction();
   transaction->Delete(key.Encode());
+  if (summary_loaded_) {
+    summary_.Remove(key.document_key());
+  }
   transaction->Delete(LevelDbDocumentOverlayLargestBatchIdIndexKey::Key(key));
   transaction->Delete(LevelDbDocumentOverlayCollectionIndexKey::Key(key));
 
@@ -287,15 +376,29 @@ void LevelDbDocumentOverlayCache::ForEachKeyInCollectionGroup(
   }
 }
 
-absl::optional<Overlay> LevelDbDocumentOverlayCache::GetOverlay(
-    const LevelDbDocumentOverlayKey& key) const {
+OverlayByDocumentKeyMap LevelDbDocumentOverlayCache::ReadOverlays(
+    std::vector<LevelDbDocumentOverlayKey>&& keys) const {
+  // The indexes are ordered by batch ID; sort the keys into the order of the
+  // overlays table so that they can be read with a single forward pass.
+  std::sort(keys.begin(), keys.end(),
+            [](const LevelDbDocumentOverlayKey& lhs,
+               const LevelDbDocumentOverlayKey& rhs) {
+              return lhs.document_key() < rhs.document_key();
+            });
+
+  OverlayByDocumentKeyMap result;
   auto it = db_->current_transaction()->NewIterator();
-  const std::string encoded_key = key.Encode();
-  it->Seek(encoded_key);
-  if (!it->Valid() || it->key() != encoded_key) {
-    return absl::nullopt;
+  for (const LevelDbDocumentOverlayKey& key : keys) {
+    const std::string encoded_key = key.Encode();
+    if (!it->Valid() || it->key() != encoded_key) {
+      it->Seek(encoded_key);
+    }
+    HARD_ASSERT(it->Valid() && it->key() == encoded_key,
+                "Overlay index entry without overlay");
+    result[key.document_key()] = ParseOverlay(key, it->value());
+    it->Next();
   }
-  return ParseOverlay(key, it->value());
+  return result;
 }
 
 }  // namespace local
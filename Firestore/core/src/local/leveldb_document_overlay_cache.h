@@ -19,9 +19,12 @@
 
 #include <cstdlib>
 #include <functional>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "Firestore/core/src/local/document_overlay_cache.h"
+#include "Firestore/core/src/local/overlay_collection_summary.h"
 #include "absl/strings/string_view.h"
 
 namespace firebase {
@@ -55,6 +58,9 @@ class LevelDbDocumentOverlayCache final : public DocumentOverlayCache {
   absl::optional<model::Overlay> GetOverlay(
       const model::DocumentKey&) const override;
 
+  void GetOverlays(model::OverlayByDocumentKeyMap& dest,
+                   const std::set<model::DocumentKey>& keys) const override;
+
   void SaveOverlays(int largest_batch_id,
                     const model::MutationByDocumentKeyMap& overlays) override;
 
@@ -63,10 +69,19 @@ class LevelDbDocumentOverlayCache final : public DocumentOverlayCache {
   model::OverlayByDocumentKeyMap GetOverlays(
       const model::ResourcePath& collection, int since_batch_id) const override;
 
+  model::OverlayByDocumentKeyMap GetOverlaysInRange(
+      const model::ResourcePath& collection,
+      const absl::optional<model::DocumentKey>& start_after,
+      const absl::optional<model::DocumentKey>& end_at) const override;
+
   model::OverlayByDocumentKeyMap GetOverlays(absl::string_view collection_group,
                                              int since_batch_id,
                                              std::size_t count) const override;
 
+  bool HasOverlays(const model::ResourcePath& collection) const override;
+
+  bool HasAnyOverlays() const override;
+
  private:
   friend class LevelDbDocumentOverlayCacheTestHelper;
 
@@ -109,8 +124,18 @@ class LevelDbDocumentOverlayCache final : public DocumentOverlayCache {
       int since_batch_id,
       std::function<ForEachKeyAction(LevelDbDocumentOverlayKey&&)>) const;
 
-  absl::optional<model::Overlay> GetOverlay(
-      const LevelDbDocumentOverlayKey& decoded_key) const;
+  /**
+   * Reads the overlays for the given keys, taken from one of the indexes.
+   * Every key must have an overlay.
+   */
+  model::OverlayByDocumentKeyMap ReadOverlays(
+      std::vector<LevelDbDocumentOverlayKey>&& keys) const;
+
+  /**
+   * Returns the summary of the overlays stored for the current user, reading
+   * it from LevelDB the first time it is needed.
+   */
+  const OverlayCollectionSummary& summary() const;
 
   // The LevelDbDocumentOverlayCache instance is owned by LevelDbPersistence.
   LevelDbPersistence* db_;
@@ -123,6 +148,13 @@ class LevelDbDocumentOverlayCache final : public DocumentOverlayCache {
    * LevelDB keys.
    */
   std::string user_id_;
+
+  /**
+   * Kept up to date by every write once loaded. Mutable because it is loaded
+   * lazily from the `const` read methods.
+   */
+  mutable OverlayCollectionSummary summary_;
+  mutable bool summary_loaded_ = false;
 };
 
 }  // namespace local
@@ -83,6 +83,10 @@ class LevelDbIndexManager : public IndexManager {
   absl::optional<std::vector<model::DocumentKey>> GetDocumentsMatchingTarget(
       const core::Target& target) override;
 
+  absl::optional<std::vector<model::DocumentKey>> GetDocumentsMatchingTarget(
+      const core::Target& target,
+      const model::DocumentKey& start_after) override;
+
   absl::optional<std::string> GetNextCollectionGroupToUpdate() const override;
 
   void UpdateCollectionGroup(const std::string& collection_group,
@@ -96,12 +100,6 @@ class LevelDbIndexManager : public IndexManager {
       std::vector<model::FieldIndex*>,
       std::function<bool(model::FieldIndex*, model::FieldIndex*)>>;
 
-  // Convenient struct to hold two LevelDb keys as a range in LevelDb.
-  struct IndexRange {
-    std::string lower;
-    std::string upper;
-  };
-
   /**
    * Stores the index in the memoized indexes table and updates
    * `next_index_to_update_` `memoized_max_index_id_` and
@@ -114,10 +112,6 @@ class LevelDbIndexManager : public IndexManager {
   std::set<index::IndexEntry> GetExistingIndexEntries(
       const model::DocumentKey& key, const model::FieldIndex& index);
 
-  /** Creates the index entries for the given document. */
-  std::set<index::IndexEntry> ComputeIndexEntries(
-      const model::Document& document, const model::FieldIndex& index);
-
   /**
    * Updates the index entries for the provided document by deleting entries
    * that are no longer referenced in `new_entries` and adding all newly added
@@ -136,17 +130,6 @@ class LevelDbIndexManager : public IndexManager {
                         const model::FieldIndex& index,
                         const index::IndexEntry& entry);
 
-  /**
-   * Returns the byte encoded form of the directional values in the field index.
-   * Returns `nullopt` if the document does not have all fields specified in the
-   * index.
-   */
-  absl::optional<std::string> EncodeDirectionalElements(
-      const model::FieldIndex& index, const model::Document& document);
-
-  /** Encodes a single value to the ascending index format. */
-  std::string EncodeSingleElement(const _google_firestore_v1_Value& value);
-
   /**
    * Returns an encoded form of the document key that sorts based on the key
    * ordering of the field index.
@@ -156,51 +139,18 @@ class LevelDbIndexManager : public IndexManager {
 
   std::vector<core::Target> GetSubTargets(const core::Target& target);
 
-  model::IndexOffset GetMinOffset(
-      const std::vector<model::FieldIndex>& indexes) const;
-
-  /**
-   * Encodes the given bounds according to the specification in `target`. For IN
-   * queries, a list of possible values is returned.
-   */
-  std::vector<std::string> EncodeBound(
-      const model::FieldIndex& index,
+  absl::optional<std::vector<model::DocumentKey>> ReadDocumentsMatchingTarget(
       const core::Target& target,
-      const core::IndexBoundValues& bound_values);
-
-  /**
-   * Encodes the given field values according to the specification in `target`.
-   * For IN queries, a list of possible values is returned.
-   */
-  std::vector<std::string> EncodeValues(const model::FieldIndex& index,
-                                        const core::Target& target,
-                                        core::IndexedValues values);
+      const absl::optional<model::DocumentKey>& start_after);
 
-  /**
-   * Constructs a vector of LevelDb key ranges that unions all bounds.
-   *
-   * These ranges represent the sections in the index entry table that contain
-   * the given bounds.
-   */
-  std::vector<IndexRange> GenerateIndexRanges(
-      int32_t index_id,
-      core::IndexedValues array_values,
-      const std::vector<std::string>& lower_bounds,
-      bool lower_bounds_inclusive,
-      const std::vector<std::string>& upper_bounds,
-      bool upper_bounds_inclusive,
-      std::vector<std::string> not_in_values);
+  model::IndexOffset GetMinOffset(
+      const std::vector<model::FieldIndex>& indexes) const;
 
   /**
-   * Returns a new set of LeveDb ranges that splits the existing range and
-   * excludes any values that match the `not_in_values` from these ranges. As an
-   * example,
-   * '[foo > 2 && foo != 3]` becomes  `[foo > 2 && < 3, foo > 3]`.
+   * Returns the LevelDb key prefix that corresponds to one of the bounds of an
+   * `IndexEntryRange`.
    */
-  std::vector<IndexRange> CreateRange(
-      const index::IndexEntry& lower_bound,
-      const index::IndexEntry& upper_bound,
-      std::vector<index::IndexEntry> not_in_bounds) const;
+  std::string EntryRangeBoundKey(const index::IndexEntry& bound) const;
 
   /**
    * Returns an index that can be used to serve the provided target. Returns
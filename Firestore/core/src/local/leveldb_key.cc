@@ -65,6 +65,7 @@ const char* kDocumentOverlaysCollectionIndexTable =
 const char* kDocumentOverlaysCollectionGroupIndexTable =
     "document_overlays_collection_group_index";
 const char* kDataMigrationTable = "data_migration";
+const char* kRemoteDocumentDictionariesTable = "remote_document_dictionary";
 
 /**
  * Labels for the components of keys. These serve to make keys self-describing.
@@ -1173,6 +1174,29 @@ bool LevelDbCollectionParentKey::Decode(absl::string_view key) {
   return reader.ok();
 }
 
+std::string LevelDbRemoteDocumentDictionaryKey::KeyPrefix() {
+  Writer writer;
+  writer.WriteTableName(kRemoteDocumentDictionariesTable);
+  return writer.result();
+}
+
+std::string LevelDbRemoteDocumentDictionaryKey::Key(
+    const ResourcePath& collection_path) {
+  Writer writer;
+  writer.WriteTableName(kRemoteDocumentDictionariesTable);
+  writer.WriteResourcePath(collection_path);
+  writer.WriteTerminator();
+  return writer.result();
+}
+
+bool LevelDbRemoteDocumentDictionaryKey::Decode(absl::string_view key) {
+  Reader reader{key};
+  reader.ReadTableNameMatching(kRemoteDocumentDictionariesTable);
+  collection_path_ = reader.ReadResourcePath();
+  reader.ReadTerminator();
+  return reader.ok();
+}
+
 std::string LevelDbRemoteDocumentReadTimeKey::KeyPrefix(
     const model::ResourcePath& collection_path,
     model::SnapshotVersion read_time) {
@@ -1415,6 +1439,15 @@ std::string LevelDbDocumentOverlayKey::KeyPrefix(
   return writer.result();
 }
 
+std::string LevelDbDocumentOverlayKey::KeyPrefix(
+    absl::string_view user_id, const ResourcePath& collection) {
+  Writer writer;
+  writer.WriteTableName(kDocumentOverlaysTable);
+  writer.WriteUserId(user_id);
+  writer.WriteResourcePath(collection);
+  return writer.result();
+}
+
 std::string LevelDbDocumentOverlayKey::Key(absl::string_view user_id,
                                            const DocumentKey& document_key,
                                            model::BatchId largest_batch_id) {
@@ -698,6 +698,45 @@ class LevelDbRemoteDocumentReadTimeKey {
   model::SnapshotVersion read_time_;
 };
 
+/**
+ * A key in the remote document dictionaries table, which stores the
+ * compression dictionary that the stored documents of a collection were
+ * compressed with.
+ */
+class LevelDbRemoteDocumentDictionaryKey {
+ public:
+  /**
+   * Creates a key prefix that points just before the first key in the table.
+   */
+  static std::string KeyPrefix();
+
+  /**
+   * Creates a complete key that points to the dictionary of the given
+   * collection_path.
+   */
+  static std::string Key(const model::ResourcePath& collection_path);
+
+  /**
+   * Decodes the given complete key, storing the decoded values in this
+   * instance.
+   *
+   * @return true if the key successfully decoded, false otherwise. If false is
+   * returned, this instance is in an undefined state until the next call to
+   * `Decode()`.
+   */
+  ABSL_MUST_USE_RESULT
+  bool Decode(absl::string_view key);
+
+  /** The collection path, as encoded in the key. */
+  const model::ResourcePath& collection_path() const {
+    return collection_path_;
+  }
+
+ private:
+  // Deliberately uninitialized: will be assigned in Decode
+  model::ResourcePath collection_path_;
+};
+
 /**
  * A key in the bundles table, storing the bundle Id for each entry.
  */
@@ -1033,6 +1072,15 @@ class LevelDbDocumentOverlayKey {
   static std::string KeyPrefix(absl::string_view user_id,
                                const model::DocumentKey& document_key);
 
+  /**
+   * Creates a key prefix that points just before the first key for the given
+   * user_id and collection path. Since keys are ordered by document path, all
+   * overlays for documents in the collection (and in its subcollections) share
+   * this prefix.
+   */
+  static std::string KeyPrefix(absl::string_view user_id,
+                               const model::ResourcePath& collection);
+
   /**
    * Creates a complete key that points to a specific user_id, document key, and
    * largest batch ID.
@@ -1315,6 +1363,33 @@ class LevelDbDataMigrationKey {
     return Key("overlay_migration");
   }
 
+  /**
+   * Resume cursor of the overlay migration: the id of the last user whose
+   * overlays were migrated.
+   */
+  static std::string OverlayMigrationCursorKey() {
+    return Key("overlay_migration_cursor");
+  }
+
+  /**
+   * Resume cursor of schema migration 4: the last remote document row that
+   * was checked for a sentinel row.
+   */
+  static std::string SentinelRowsCursorKey() {
+    return Key("sentinel_rows_cursor");
+  }
+
+  /**
+   * Resume cursors of schema migration 6: the last remote document and
+   * document mutation rows that were added to the collection parents index.
+   */
+  static std::string CollectionParentsDocumentsCursorKey() {
+    return Key("collection_parents_documents_cursor");
+  }
+  static std::string CollectionParentsMutationsCursorKey() {
+    return Key("collection_parents_mutations_cursor");
+  }
+
   /**
    * Decodes the given complete key, storing the decoded values in this
    * instance.
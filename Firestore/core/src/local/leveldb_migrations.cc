@@ -16,6 +16,7 @@
 
 #include "Firestore/core/src/local/leveldb_migrations.h"
 
+#include <functional>
 #include <string>
 #include <utility>
 
@@ -77,6 +78,69 @@ void DeleteEverythingWithPrefix(const std::string& prefix, leveldb::DB* db) {
   }
 }
 
+/**
+ * The maximum number of rows a chunked migration visits in one transaction.
+ * A transaction buffers its writes in memory until it commits, so this bounds
+ * the memory a migration needs regardless of the size of the cache.
+ */
+const size_t kMigrationChunkSize = 1000;
+
+/**
+ * Calls `visit` with every row whose key starts with `prefix`, committing the
+ * changes it makes every `kMigrationChunkSize` rows.
+ *
+ * Each chunk also saves the last key it visited under `cursor_key`, and a scan
+ * that finds a saved cursor resumes after it, so that a migration interrupted
+ * part way through does not start over. The cursor is left in place when the
+ * scan completes; the migration should delete it in the transaction that saves
+ * the new schema version. `visit` must not write rows under `prefix`.
+ */
+void ScanInChunks(
+    leveldb::DB* db,
+    absl::string_view label,
+    const std::string& prefix,
+    const std::string& cursor_key,
+    const std::function<void(LevelDbTransaction*, absl::string_view)>& visit) {
+  std::string start = prefix;
+  bool resuming = false;
+  {
+    LevelDbTransaction transaction(db, label);
+    std::string cursor;
+    if (transaction.Get(cursor_key, &cursor).ok()) {
+      start = std::move(cursor);
+      resuming = true;
+    }
+  }
+
+  bool more = true;
+  while (more) {
+    more = false;
+    LevelDbTransaction transaction(db, label);
+    auto it = transaction.NewIterator();
+    it->Seek(start);
+    if (resuming && it->Valid() && it->key() == start) {
+      it->Next();
+    }
+
+    size_t visited = 0;
+    for (; it->Valid() && absl::StartsWith(it->key(), prefix); it->Next()) {
+      if (visited == kMigrationChunkSize) {
+        more = true;
+        break;
+      }
+      visit(&transaction, it->key());
+      start = std::string(it->key());
+      ++visited;
+    }
+
+    if (visited > 0) {
+      transaction.Put(cursor_key, start);
+      transaction.Commit();
+      resuming = true;
+    }
+  }
+}
+
 /** Migration 3. */
 void ClearQueryCache(leveldb::DB* db) {
   DeleteEverythingWithPrefix(LevelDbTargetKey::KeyPrefix(), db);
@@ -197,25 +261,27 @@ void EnsureSentinelRow(LevelDbTransaction* transaction,
  * sentinel row in the document target index.
  */
 void EnsureSentinelRows(leveldb::DB* db) {
-  LevelDbTransaction transaction(db, "Ensure sentinel rows");
-
   // Get the value we'll use for anything that's missing a row.
-  model::ListenSequenceNumber sequence_number =
-      GetHighestSequenceNumber(&transaction);
-  std::string sentinel_value =
-      LevelDbDocumentTargetKey::EncodeSentinelValue(sequence_number);
+  std::string sentinel_value;
+  {
+    LevelDbTransaction transaction(db, "Read highest sequence number");
+    sentinel_value = LevelDbDocumentTargetKey::EncodeSentinelValue(
+        GetHighestSequenceNumber(&transaction));
+  }
 
-  std::string documents_prefix = LevelDbRemoteDocumentKey::KeyPrefix();
-  auto it = transaction.NewIterator();
-  it->Seek(documents_prefix);
+  std::string cursor_key = LevelDbDataMigrationKey::SentinelRowsCursorKey();
   LevelDbRemoteDocumentKey document_key;
-  for (; it->Valid() && absl::StartsWith(it->key(), documents_prefix);
-       it->Next()) {
-    HARD_ASSERT(document_key.Decode(it->key()),
-                "Failed to decode document key");
-    EnsureSentinelRow(&transaction, document_key.document_key(),
-                      sentinel_value);
-  }
+  ScanInChunks(db, "Ensure sentinel rows",
+               LevelDbRemoteDocumentKey::KeyPrefix(), cursor_key,
+               [&](LevelDbTransaction* transaction, absl::string_view key) {
+                 HARD_ASSERT(document_key.Decode(key),
+                             "Failed to decode document key");
+                 EnsureSentinelRow(transaction, document_key.document_key(),
+                                   sentinel_value);
+               });
+
+  LevelDbTransaction transaction(db, "Ensure sentinel rows");
+  transaction.Delete(cursor_key);
   SaveVersion(4, &transaction);
   transaction.Commit();
 }
@@ -244,37 +310,37 @@ void EnsureCollectionParentRow(LevelDbTransaction* transaction,
  * of documents in the remote document cache and mutation queue.
  */
 void EnsureCollectionParentsIndex(leveldb::DB* db) {
-  LevelDbTransaction transaction(db, "Ensure Collection Parents Index");
-
   MemoryCollectionParentIndex cache;
 
   // Index existing remote documents.
-  std::string documents_prefix = LevelDbRemoteDocumentKey::KeyPrefix();
-  auto it = transaction.NewIterator();
-  it->Seek(documents_prefix);
+  std::string documents_cursor_key =
+      LevelDbDataMigrationKey::CollectionParentsDocumentsCursorKey();
   LevelDbRemoteDocumentKey document_key;
-  for (; it->Valid() && absl::StartsWith(it->key(), documents_prefix);
-       it->Next()) {
-    HARD_ASSERT(document_key.Decode(it->key()),
-                "Failed to decode document key");
-
-    EnsureCollectionParentRow(&transaction, &cache,
-                              document_key.document_key());
-  }
+  ScanInChunks(db, "Ensure Collection Parents Index",
+               LevelDbRemoteDocumentKey::KeyPrefix(), documents_cursor_key,
+               [&](LevelDbTransaction* transaction, absl::string_view key) {
+                 HARD_ASSERT(document_key.Decode(key),
+                             "Failed to decode document key");
+                 EnsureCollectionParentRow(transaction, &cache,
+                                           document_key.document_key());
+               });
 
   // Index existing mutations.
-  std::string mutations_prefix = LevelDbDocumentMutationKey::KeyPrefix();
-  it = transaction.NewIterator();
-  it->Seek(mutations_prefix);
-  LevelDbDocumentMutationKey key;
-  for (; it->Valid() && absl::StartsWith(it->key(), mutations_prefix);
-       it->Next()) {
-    HARD_ASSERT(key.Decode(it->key()),
-                "Failed to decode document-mutation key");
-
-    EnsureCollectionParentRow(&transaction, &cache, key.document_key());
-  }
+  std::string mutations_cursor_key =
+      LevelDbDataMigrationKey::CollectionParentsMutationsCursorKey();
+  LevelDbDocumentMutationKey mutation_key;
+  ScanInChunks(db, "Ensure Collection Parents Index",
+               LevelDbDocumentMutationKey::KeyPrefix(), mutations_cursor_key,
+               [&](LevelDbTransaction* transaction, absl::string_view key) {
+                 HARD_ASSERT(mutation_key.Decode(key),
+                             "Failed to decode document-mutation key");
+                 EnsureCollectionParentRow(transaction, &cache,
+                                           mutation_key.document_key());
+               });
 
+  LevelDbTransaction transaction(db, "Ensure Collection Parents Index");
+  transaction.Delete(documents_cursor_key);
+  transaction.Delete(mutations_cursor_key);
   SaveVersion(6, &transaction);
   transaction.Commit();
 }
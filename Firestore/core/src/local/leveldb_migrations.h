@@ -38,7 +38,10 @@ class LevelDbMigrations {
 
   /**
    * Runs any migrations needed to bring the given database up to the current
-   * schema version
+   * schema version.
+   *
+   * Migrations that rewrite rows for every document commit in bounded chunks
+   * and record their progress, so an interrupted run resumes where it stopped.
    */
   static void RunMigrations(leveldb::DB* db, const LocalSerializer& serializer);
 
@@ -16,9 +16,11 @@
 
 #include "Firestore/core/src/local/leveldb_overlay_migration_manager.h"
 
+#include <algorithm>
+#include <set>
 #include <string>
-#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/credentials/user.h"
 #include "Firestore/core/src/local/leveldb_key.h"
@@ -26,6 +28,7 @@
 #include "Firestore/core/src/local/local_documents_view.h"
 #include "Firestore/core/src/model/model_fwd.h"
 #include "absl/strings/match.h"
+#include "absl/types/optional.h"
 
 namespace firebase {
 namespace firestore {
@@ -33,9 +36,17 @@ namespace local {
 namespace {
 
 using credentials::User;
+using model::DocumentKey;
+using model::DocumentKeySet;
 
-std::unordered_set<std::string> GetAllUserIds(LevelDbPersistence* db) {
-  std::unordered_set<std::string> uids;
+/**
+ * The maximum number of documents whose overlays are recalculated in one
+ * transaction, which bounds the writes buffered in memory before a commit.
+ */
+const size_t kDocumentsPerTransaction = 1000;
+
+std::set<std::string> GetAllUserIds(LevelDbPersistence* db) {
+  std::set<std::string> uids;
   auto prefix = LevelDbMutationKey::KeyPrefix();
   LevelDbMutationKey key;
   auto iter = db->current_transaction()->NewIterator();
@@ -52,6 +63,12 @@ std::unordered_set<std::string> GetAllUserIds(LevelDbPersistence* db) {
 void RemovePendingOverlayMigrations(LevelDbPersistence* db) {
   auto key = LevelDbDataMigrationKey::OverlayMigrationKey();
   db->current_transaction()->Delete(key);
+  db->current_transaction()->Delete(
+      LevelDbDataMigrationKey::OverlayMigrationCursorKey());
+}
+
+User UserFromId(const std::string& uid) {
+  return uid.empty() ? User::Unauthenticated() : User(uid);
 }
 
 }  // namespace
@@ -63,39 +80,82 @@ bool LevelDbOverlayMigrationManager::HasPendingOverlayMigration() {
 }
 
 void LevelDbOverlayMigrationManager::Run() {
-  db_->Run("migrate overlays", [this] {
-    if (!HasPendingOverlayMigration()) {
+  // Users are migrated one at a time, in chunks of documents, rather than in a
+  // single transaction. The id of the last migrated user is saved as a cursor
+  // so that an interrupted migration skips the users it already finished.
+  bool pending = false;
+  std::set<std::string> user_ids;
+  absl::optional<std::string> cursor;
+  db_->Run("Read overlay migration state", [&] {
+    pending = HasPendingOverlayMigration();
+    if (!pending) {
       return;
     }
 
-    std::unordered_set<std::string> user_ids = GetAllUserIds(db_);
-    auto* remote_document_cache = db_->remote_document_cache();
-    for (const auto& uid : user_ids) {
-      User user = User::Unauthenticated();
-      if (!uid.empty()) {
-        user = User(uid);
-      }
-      auto* index_manager = db_->GetIndexManager(user);
-      auto* mutation_queue = db_->GetMutationQueue(user, index_manager);
-
-      // Get all document keys that have local mutations
-      model::DocumentKeySet all_document_keys;
-      for (const auto& batch : mutation_queue->AllMutationBatches()) {
-        all_document_keys = all_document_keys.union_with(batch.keys());
-      }
-
-      // Recalculate and save overlays
-      auto* document_overlay_cache = db_->GetDocumentOverlayCache(user);
-      LocalDocumentsView local_view(remote_document_cache, mutation_queue,
-                                    document_overlay_cache, index_manager);
-      local_view.RecalculateAndSaveOverlays(std::move(all_document_keys));
+    user_ids = GetAllUserIds(db_);
+    std::string last_user_id;
+    if (db_->current_transaction()
+            ->Get(LevelDbDataMigrationKey::OverlayMigrationCursorKey(),
+                  &last_user_id)
+            .ok()) {
+      cursor = std::move(last_user_id);
     }
+  });
+  if (!pending) {
+    return;
+  }
+
+  auto it = cursor ? user_ids.upper_bound(*cursor) : user_ids.begin();
+  for (; it != user_ids.end(); ++it) {
+    MigrateUser(*it);
+  }
 
+  db_->Run("Finish overlay migration", [this] {
     db_->ReleaseOtherUserSpecificComponents(uid_);
     RemovePendingOverlayMigrations(db_);
   });
 }
 
+void LevelDbOverlayMigrationManager::MigrateUser(const std::string& user_id) {
+  User user = UserFromId(user_id);
+  auto* remote_document_cache = db_->remote_document_cache();
+  auto* index_manager = db_->GetIndexManager(user);
+  auto* mutation_queue = db_->GetMutationQueue(user, index_manager);
+  auto* document_overlay_cache = db_->GetDocumentOverlayCache(user);
+  LocalDocumentsView local_view(remote_document_cache, mutation_queue,
+                                document_overlay_cache, index_manager);
+
+  // Get all document keys that have local mutations
+  std::vector<DocumentKey> all_document_keys;
+  db_->Run("Read overlay migration keys", [&] {
+    DocumentKeySet keys;
+    for (const auto& batch : mutation_queue->AllMutationBatches()) {
+      keys = keys.union_with(batch.keys());
+    }
+    all_document_keys.assign(keys.begin(), keys.end());
+  });
+
+  // Recalculate and save overlays. Each document's overlay only depends on
+  // the batches that affect it, so documents can be migrated independently.
+  for (size_t begin = 0; begin < all_document_keys.size();
+       begin += kDocumentsPerTransaction) {
+    size_t end =
+        std::min(begin + kDocumentsPerTransaction, all_document_keys.size());
+    DocumentKeySet chunk;
+    for (size_t i = begin; i < end; ++i) {
+      chunk = chunk.insert(all_document_keys[i]);
+    }
+    db_->Run("Migrate overlays", [&] {
+      local_view.RecalculateAndSaveOverlays(chunk);
+    });
+  }
+
+  db_->Run("Save overlay migration cursor", [&] {
+    db_->current_transaction()->Put(
+        LevelDbDataMigrationKey::OverlayMigrationCursorKey(), user_id);
+  });
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
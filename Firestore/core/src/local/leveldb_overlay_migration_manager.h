@@ -48,6 +48,9 @@ class LevelDbOverlayMigrationManager : public OverlayMigrationManager {
 
   bool HasPendingOverlayMigration();
 
+  /** Recalculates and saves the overlays of the given user's mutations. */
+  void MigrateUser(const std::string& user_id);
+
   // The LevelDbOverlayMigrationManager is owned by LevelDbPersistence.
   LevelDbPersistence* db_;
 
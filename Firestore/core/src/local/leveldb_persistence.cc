@@ -328,6 +328,7 @@ void LevelDbPersistence::RunInternal(absl::string_view label,
 
   block();
 
+  document_cache_->RemoveUnusedDictionaries();
   reference_delegate_->OnTransactionCommitted();
   transaction_->Commit();
   transaction_.reset();
@@ -16,12 +16,16 @@
 
 #include "Firestore/core/src/local/leveldb_remote_document_cache.h"
 
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <utility>
+#include <vector>
 
 #include "Firestore/Protos/nanopb/firestore/local/maybe_document.nanopb.h"
 #include "Firestore/core/src/core/query.h"
+#include "Firestore/core/src/local/document_compression.h"
+#include "Firestore/core/src/local/lazy_document.h"
 #include "Firestore/core/src/local/leveldb_key.h"
 #include "Firestore/core/src/local/leveldb_persistence.h"
 #include "Firestore/core/src/local/local_serializer.h"
@@ -35,7 +39,9 @@
 #include "Firestore/core/src/util/background_queue.h"
 #include "Firestore/core/src/util/executor.h"
 #include "Firestore/core/src/util/status.h"
+#include "Firestore/core/src/util/statusor.h"
 #include "Firestore/core/src/util/string_util.h"
+#include "absl/strings/match.h"
 #include "leveldb/db.h"
 
 namespace firebase {
@@ -56,6 +62,21 @@ using nanopb::Message;
 using nanopb::StringReader;
 using util::BackgroundQueue;
 using util::Executor;
+using util::StatusOr;
+
+/**
+ * The number of documents of a collection that a compression dictionary is
+ * built from, unless the samples reach the maximum dictionary size first.
+ */
+const size_t kDictionarySampleCount = 32;
+
+/**
+ * The number of collections that samples are kept for at a time. Documents of
+ * further collections are stored uncompressed until one of these collections
+ * gets its dictionary or is emptied, so small collections that never collect
+ * enough samples cannot grow the samples without bound.
+ */
+const size_t kMaxSampledCollections = 16;
 
 /**
  * An accumulator for results produced asynchronously. This accumulates
@@ -112,8 +133,11 @@ void LevelDbRemoteDocumentCache::Add(const MutableDocument& document,
   const ResourcePath& path = key.path();
 
   std::string ldb_document_key = LevelDbRemoteDocumentKey::Key(key);
-  db_->current_transaction()->Put(ldb_document_key,
-                                  serializer_->EncodeMaybeDocument(document));
+  std::string encoded =
+      nanopb::MakeStdString(serializer_->EncodeMaybeDocument(document));
+  db_->current_transaction()->Put(
+      ldb_document_key, CompressForStorage(path.PopLast(), std::move(encoded)));
+  decoded_documents_.Invalidate(key);
 
   std::string ldb_read_time_key = LevelDbRemoteDocumentReadTimeKey::Key(
       path.PopLast(), read_time, path.last_segment());
@@ -126,16 +150,39 @@ void LevelDbRemoteDocumentCache::Add(const MutableDocument& document,
 void LevelDbRemoteDocumentCache::Remove(const DocumentKey& key) {
   std::string ldb_key = LevelDbRemoteDocumentKey::Key(key);
   db_->current_transaction()->Delete(ldb_key);
+  decoded_documents_.Invalidate(key);
+
+  // Whether the collection was emptied is only checked once the transaction
+  // is done removing documents.
+  removed_from_collections_.insert(key.path().PopLast());
+}
+
+void LevelDbRemoteDocumentCache::RemoveUnusedDictionaries() {
+  for (const ResourcePath& collection : removed_from_collections_) {
+    bool sampled = dictionary_samples_.count(collection) > 0;
+    if ((sampled || GetDictionary(collection)) &&
+        IsCollectionEmpty(collection)) {
+      RemoveDictionary(collection);
+    }
+  }
+  removed_from_collections_.clear();
 }
 
 MutableDocument LevelDbRemoteDocumentCache::Get(const DocumentKey& key) const {
+  absl::optional<MutableDocument> cached = decoded_documents_.Get(key);
+  if (cached) {
+    return std::move(*cached);
+  }
+
   std::string ldb_key = LevelDbRemoteDocumentKey::Key(key);
   std::string value;
   Status status = db_->current_transaction()->Get(ldb_key, &value);
   if (status.IsNotFound()) {
     return MutableDocument::InvalidDocument(key);
   } else if (status.ok()) {
-    return DecodeMaybeDocument(value, key);
+    MutableDocument document = DecodeMaybeDocument(value, key);
+    decoded_documents_.Put(document, value.size());
+    return document;
   } else {
     HARD_FAIL("Fetch document for key (%s) failed with status: %s",
               key.ToString(), status.ToString());
@@ -151,15 +198,23 @@ MutableDocumentMap LevelDbRemoteDocumentCache::GetAll(
   auto it = db_->current_transaction()->NewIterator();
 
   for (const DocumentKey& key : keys) {
+    absl::optional<MutableDocument> cached = decoded_documents_.Get(key);
+    if (cached) {
+      results.Insert(std::make_pair(key, std::move(*cached)));
+      continue;
+    }
+
     it->Seek(LevelDbRemoteDocumentKey::Key(key));
     if (!it->Valid() || !current_key.Decode(it->key()) ||
         current_key.document_key() != key) {
       results.Insert(
           std::make_pair(key, MutableDocument::InvalidDocument(key)));
     } else {
-      const std::string& contents = it->value();
+      std::string contents(it->value());
       tasks.Execute([this, &results, &key, contents] {
-        results.Insert(std::make_pair(key, DecodeMaybeDocument(contents, key)));
+        MutableDocument document = DecodeMaybeDocument(contents, key);
+        decoded_documents_.Put(document, contents.size());
+        results.Insert(std::make_pair(key, std::move(document)));
       });
     }
   }
@@ -179,14 +234,18 @@ MutableDocumentMap LevelDbRemoteDocumentCache::GetAllExisting(
     const model::OverlayByDocumentKeyMap& mutated_docs) const {
   BackgroundQueue tasks(executor_.get());
   AsyncResults<std::pair<DocumentKey, MutableDocument>> results;
+  LazyDocument::FieldNames query_fields = LazyDocument::FieldsToMatch(query);
   for (const auto& key_version : remote_map) {
-    tasks.Execute([this, &results, &key_version, query, &mutated_docs] {
-      auto document = Get(key_version.first).WithReadTime(key_version.second);
-      if (document.is_found_document() &&
-          // Either the document matches the given query, or it is mutated.
-          (query.Matches(document) ||
-           mutated_docs.find(key_version.first) != mutated_docs.end())) {
-        results.Insert(std::make_pair(key_version.first, std::move(document)));
+    tasks.Execute([this, &results, &key_version, &query, &query_fields,
+                   &mutated_docs] {
+      const DocumentKey& key = key_version.first;
+      // Either the document matches the given query, or it is mutated.
+      bool mutated = mutated_docs.find(key) != mutated_docs.end();
+      absl::optional<MutableDocument> document =
+          GetMatchingDocument(key, query, query_fields, mutated);
+      if (document) {
+        results.Insert(
+            std::make_pair(key, document->WithReadTime(key_version.second)));
       }
     });
   }
@@ -199,6 +258,43 @@ MutableDocumentMap LevelDbRemoteDocumentCache::GetAllExisting(
   return map;
 }
 
+absl::optional<MutableDocument>
+LevelDbRemoteDocumentCache::GetMatchingDocument(
+    const DocumentKey& key,
+    const Query& query,
+    const LazyDocument::FieldNames& query_fields,
+    bool mutated) const {
+  absl::optional<MutableDocument> cached = decoded_documents_.Get(key);
+  if (cached) {
+    if (cached->is_found_document() && (mutated || query.Matches(*cached))) {
+      return cached;
+    }
+    return absl::nullopt;
+  }
+
+  std::string contents;
+  Status status = db_->current_transaction()->Get(
+      LevelDbRemoteDocumentKey::Key(key), &contents);
+  if (status.IsNotFound()) {
+    return absl::nullopt;
+  }
+  HARD_ASSERT(status.ok(), "Fetch document for key (%s) failed with status: %s",
+              key.ToString(), status.ToString());
+
+  if (IsCompressedDocument(contents)) {
+    contents = Decompress(contents, key);
+  }
+
+  // Check the query against only the fields it needs before paying for a full
+  // decode of the document.
+  LazyDocument lazy_document(key, contents);
+  if (!lazy_document.is_found_document() ||
+      (!mutated && !lazy_document.Matches(query, query_fields))) {
+    return absl::nullopt;
+  }
+  return DecodeCachedDocument(contents, key);
+}
+
 MutableDocumentMap LevelDbRemoteDocumentCache::GetAll(
     const std::string& collection_group,
     const model::IndexOffset& offset,
@@ -223,6 +319,51 @@ MutableDocumentMap LevelDbRemoteDocumentCache::GetAll(
   return result;
 }
 
+MutableDocumentMap LevelDbRemoteDocumentCache::GetDocumentsInCollection(
+    const ResourcePath& collection,
+    const absl::optional<DocumentKey>& start_after,
+    size_t limit) const {
+  HARD_ASSERT(limit > 0u, "Limit should be at least 1");
+  BackgroundQueue tasks(executor_.get());
+  AsyncResults<std::pair<DocumentKey, MutableDocument>> results;
+
+  std::string prefix = LevelDbRemoteDocumentKey::KeyPrefix(collection);
+  auto it = db_->current_transaction()->NewIterator();
+  if (start_after.has_value()) {
+    it->Seek(util::ImmediateSuccessor(
+        LevelDbRemoteDocumentKey::Key(start_after.value())));
+  } else {
+    it->Seek(prefix);
+  }
+
+  size_t child_path_length = collection.size() + 1;
+  size_t count = 0;
+  LevelDbRemoteDocumentKey current_key;
+  for (; count < limit && it->Valid() && absl::StartsWith(it->key(), prefix) &&
+         current_key.Decode(it->key());
+       it->Next()) {
+    DocumentKey key = current_key.document_key();
+    if (key.path().size() != child_path_length) {
+      // Exclude entries from subcollections.
+      continue;
+    }
+
+    ++count;
+    std::string contents(it->value());
+    tasks.Execute([this, &results, key, contents] {
+      results.Insert(std::make_pair(key, DecodeCachedDocument(contents, key)));
+    });
+  }
+
+  tasks.AwaitAll();
+
+  MutableDocumentMap map;
+  for (const auto& entry : results.Result()) {
+    map = map.insert(entry.first, entry.second);
+  }
+  return map;
+}
+
 MutableDocumentMap LevelDbRemoteDocumentCache::GetDocumentsMatchingQuery(
     const core::Query& query,
     const model::IndexOffset& offset,
@@ -283,8 +424,117 @@ MutableDocumentMap LevelDbRemoteDocumentCache::GetDocumentsMatchingQuery(
                                                     query, mutated_docs);
 }
 
+std::string LevelDbRemoteDocumentCache::CompressForStorage(
+    const ResourcePath& collection, std::string encoded) {
+  if (!compression_enabled_) {
+    return encoded;
+  }
+
+  std::shared_ptr<const std::string> dictionary = GetDictionary(collection);
+  if (!dictionary) {
+    if (dictionary_samples_.size() >= kMaxSampledCollections &&
+        dictionary_samples_.count(collection) == 0) {
+      return encoded;
+    }
+
+    std::vector<std::string>& samples = dictionary_samples_[collection];
+    samples.push_back(encoded);
+    size_t sample_size = 0;
+    for (const std::string& sample : samples) {
+      sample_size += sample.size();
+    }
+    if (samples.size() < kDictionarySampleCount &&
+        sample_size < kMaxCompressionDictionarySize) {
+      return encoded;
+    }
+
+    dictionary = std::make_shared<const std::string>(
+        BuildCompressionDictionary(samples));
+    dictionary_samples_.erase(collection);
+    db_->current_transaction()->Put(
+        LevelDbRemoteDocumentDictionaryKey::Key(collection), *dictionary);
+    std::lock_guard<std::mutex> lock(dictionaries_mutex_);
+    dictionaries_[collection] = dictionary;
+  }
+
+  absl::optional<std::string> compressed =
+      CompressDocument(encoded, *dictionary);
+  return compressed ? std::move(*compressed) : std::move(encoded);
+}
+
+std::string LevelDbRemoteDocumentCache::Decompress(
+    absl::string_view stored, const DocumentKey& key) const {
+  std::shared_ptr<const std::string> dictionary =
+      GetDictionary(key.path().PopLast());
+  HARD_ASSERT(dictionary, "No compression dictionary for document (%s)",
+              key.ToString());
+
+  StatusOr<std::string> encoded = DecompressDocument(stored, *dictionary);
+  if (!encoded.ok()) {
+    HARD_FAIL("Document (%s) failed to decompress: %s", key.ToString(),
+              encoded.status().ToString());
+  }
+  return std::move(encoded).ValueOrDie();
+}
+
+bool LevelDbRemoteDocumentCache::IsCollectionEmpty(
+    const ResourcePath& collection) const {
+  std::string prefix = LevelDbRemoteDocumentKey::KeyPrefix(collection);
+  auto it = db_->current_transaction()->NewIterator();
+  it->Seek(prefix);
+
+  size_t child_path_length = collection.size() + 1;
+  LevelDbRemoteDocumentKey current_key;
+  for (; it->Valid() && absl::StartsWith(it->key(), prefix) &&
+         current_key.Decode(it->key());
+       it->Next()) {
+    // Entries of subcollections do not use this collection's dictionary.
+    if (current_key.document_key().path().size() == child_path_length) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void LevelDbRemoteDocumentCache::RemoveDictionary(
+    const ResourcePath& collection) {
+  dictionary_samples_.erase(collection);
+  db_->current_transaction()->Delete(
+      LevelDbRemoteDocumentDictionaryKey::Key(collection));
+  std::lock_guard<std::mutex> lock(dictionaries_mutex_);
+  dictionaries_[collection] = nullptr;
+}
+
+std::shared_ptr<const std::string> LevelDbRemoteDocumentCache::GetDictionary(
+    const ResourcePath& collection) const {
+  std::lock_guard<std::mutex> lock(dictionaries_mutex_);
+  auto found = dictionaries_.find(collection);
+  if (found != dictionaries_.end()) {
+    return found->second;
+  }
+
+  std::shared_ptr<const std::string> dictionary;
+  std::string value;
+  Status status = db_->current_transaction()->Get(
+      LevelDbRemoteDocumentDictionaryKey::Key(collection), &value);
+  if (status.ok()) {
+    dictionary = std::make_shared<const std::string>(std::move(value));
+  } else if (!status.IsNotFound()) {
+    HARD_FAIL("Fetch dictionary for collection (%s) failed with status: %s",
+              collection.CanonicalString(), status.ToString());
+  }
+  dictionaries_[collection] = dictionary;
+  return dictionary;
+}
+
 MutableDocument LevelDbRemoteDocumentCache::DecodeMaybeDocument(
     absl::string_view encoded, const DocumentKey& key) const {
+  std::string decompressed;
+  if (IsCompressedDocument(encoded)) {
+    decompressed = Decompress(encoded, key);
+    encoded = decompressed;
+  }
+
   StringReader reader{encoded};
 
   auto message = Message<firestore_client_MaybeDocument>::TryParse(&reader);
@@ -302,10 +552,27 @@ MutableDocument LevelDbRemoteDocumentCache::DecodeMaybeDocument(
   return maybe_document;
 }
 
+MutableDocument LevelDbRemoteDocumentCache::DecodeCachedDocument(
+    absl::string_view encoded, const DocumentKey& key) const {
+  absl::optional<MutableDocument> cached = decoded_documents_.Get(key);
+  if (cached) {
+    return std::move(*cached);
+  }
+
+  MutableDocument document = DecodeMaybeDocument(encoded, key);
+  decoded_documents_.Put(document, encoded.size());
+  return document;
+}
+
 void LevelDbRemoteDocumentCache::SetIndexManager(IndexManager* manager) {
   index_manager_ = NOT_NULL(manager);
 }
 
+DecodedDocumentCacheStats LevelDbRemoteDocumentCache::decoded_document_stats()
+    const {
+  return decoded_documents_.stats();
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
@@ -17,16 +17,22 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_LEVELDB_REMOTE_DOCUMENT_CACHE_H_
 #define FIRESTORE_CORE_SRC_LOCAL_LEVELDB_REMOTE_DOCUMENT_CACHE_H_
 
+#include <map>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <set>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include "Firestore/core/src/core/query.h"
+#include "Firestore/core/src/local/decoded_document_cache.h"
+#include "Firestore/core/src/local/lazy_document.h"
 #include "Firestore/core/src/local/leveldb_index_manager.h"
 #include "Firestore/core/src/local/remote_document_cache.h"
 #include "Firestore/core/src/model/model_fwd.h"
 #include "Firestore/core/src/model/overlay.h"
+#include "Firestore/core/src/model/resource_path.h"
 #include "Firestore/core/src/model/types.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
@@ -65,6 +71,10 @@ class LevelDbRemoteDocumentCache : public RemoteDocumentCache {
   model::MutableDocumentMap GetAll(const std::string& collection_group,
                                    const model::IndexOffset& offset,
                                    size_t limit) const override;
+  model::MutableDocumentMap GetDocumentsInCollection(
+      const model::ResourcePath& collection,
+      const absl::optional<model::DocumentKey>& start_after,
+      size_t limit) const override;
   model::MutableDocumentMap GetDocumentsMatchingQuery(
       const core::Query& query,
       const model::IndexOffset& offset,
@@ -79,6 +89,26 @@ class LevelDbRemoteDocumentCache : public RemoteDocumentCache {
 
   void SetIndexManager(IndexManager* manager) override;
 
+  /** Returns the hit and miss counts of the decoded document cache. */
+  DecodedDocumentCacheStats decoded_document_stats() const;
+
+  /**
+   * Sets whether documents are compressed as they are written. Each
+   * collection's documents are compressed with a dictionary that is built from
+   * the first documents written to it, and that is deleted once the collection
+   * is emptied. Compressed documents remain readable regardless of this
+   * setting.
+   */
+  void set_compression_enabled(bool enabled) {
+    compression_enabled_ = enabled;
+  }
+
+  /**
+   * Deletes the compression dictionaries of the collections that were emptied
+   * by the current transaction. Called before the transaction is committed.
+   */
+  void RemoveUnusedDictionaries();
+
  private:
   /**
    * Looks up a set of entries in the cache, returning only existing entries of
@@ -89,9 +119,57 @@ class LevelDbRemoteDocumentCache : public RemoteDocumentCache {
       const core::Query& query,
       const model::OverlayByDocumentKeyMap& mutated_docs = {}) const;
 
+  /**
+   * Returns the document for `key` if it exists and either matches `query` or
+   * is `mutated`. Only the `query_fields` of stored documents are decoded
+   * until the document is known to be part of the result.
+   */
+  absl::optional<model::MutableDocument> GetMatchingDocument(
+      const model::DocumentKey& key,
+      const core::Query& query,
+      const LazyDocument::FieldNames& query_fields,
+      bool mutated) const;
+
+  /**
+   * Returns the bytes to store for a document of `collection`, compressing
+   * `encoded` if compression is enabled and a dictionary is available.
+   */
+  std::string CompressForStorage(const model::ResourcePath& collection,
+                                 std::string encoded);
+
+  /** Returns the encoded document that was stored compressed as `stored`. */
+  std::string Decompress(absl::string_view stored,
+                         const model::DocumentKey& key) const;
+
+  /**
+   * Returns whether `collection` has no documents, not counting documents of
+   * its subcollections.
+   */
+  bool IsCollectionEmpty(const model::ResourcePath& collection) const;
+
+  /**
+   * Deletes the compression dictionary and samples of `collection`. Must only
+   * be called once no stored document of the collection uses the dictionary.
+   */
+  void RemoveDictionary(const model::ResourcePath& collection);
+
+  /**
+   * Returns the compression dictionary of `collection`, or nullptr if it has
+   * none yet.
+   */
+  std::shared_ptr<const std::string> GetDictionary(
+      const model::ResourcePath& collection) const;
+
   model::MutableDocument DecodeMaybeDocument(
       absl::string_view encoded, const model::DocumentKey& key) const;
 
+  /**
+   * Returns the document stored as `encoded`, from the decoded document cache
+   * if possible. Decoded documents are added to the cache.
+   */
+  model::MutableDocument DecodeCachedDocument(
+      absl::string_view encoded, const model::DocumentKey& key) const;
+
   // The LevelDbRemoteDocumentCache instance is owned by LevelDbPersistence.
   LevelDbPersistence* db_;
   // The LevelDbIndexManager instance is owned by LevelDbPersistence.
@@ -100,6 +178,36 @@ class LevelDbRemoteDocumentCache : public RemoteDocumentCache {
   LocalSerializer* serializer_ = nullptr;
 
   std::unique_ptr<util::Executor> executor_;
+
+  /**
+   * Documents that were recently decoded. Every write goes through `Add()` or
+   * `Remove()`, which invalidate the written document, so cached documents
+   * always match what is stored.
+   */
+  mutable DecodedDocumentCache decoded_documents_;
+
+  bool compression_enabled_ = false;
+
+  /**
+   * Encoded documents of collections without a compression dictionary, kept
+   * to build one. Holds at most `kMaxSampledCollections` collections. Only
+   * accessed while writing.
+   */
+  std::map<model::ResourcePath, std::vector<std::string>> dictionary_samples_;
+
+  /**
+   * Collections that documents were removed from in the current transaction,
+   * which may have been emptied.
+   */
+  std::set<model::ResourcePath> removed_from_collections_;
+
+  /**
+   * Compression dictionaries by collection, loaded on first use. A null entry
+   * means that the collection has no dictionary.
+   */
+  mutable std::map<model::ResourcePath, std::shared_ptr<const std::string>>
+      dictionaries_;
+  mutable std::mutex dictionaries_mutex_;
 };
 
 }  // namespace local
@@ -19,6 +19,7 @@
 #include "Firestore/core/src/local/leveldb_transaction.h"
 
 #include "Firestore/core/src/local/leveldb_key.h"
+#include "Firestore/core/src/local/leveldb_util.h"
 #include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/log.h"
 #include "absl/memory/memory.h"
@@ -42,7 +43,7 @@ LevelDbTransaction::Iterator::Iterator(LevelDbTransaction* txn)
       last_version_(txn->version_),
       txn_(txn),
       mutations_iter_(txn->mutations_.begin()),
-      current_(),
+      deletions_iter_(txn->deletions_.begin()),
       is_mutation_(false),
       // Iterator doesn't really point to anything yet, so is
       // invalid
@@ -66,9 +67,12 @@ void LevelDbTransaction::Iterator::UpdateCurrent() {
       is_mutation_ = db_iter_->key().compare(mutations_iter_->first) >= 0;
     }
     if (is_mutation_) {
-      current_ = *mutations_iter_;
+      mutation_ = *mutations_iter_;
+      key_ = mutation_.first;
+      value_ = mutation_.second;
     } else {
-      current_ = {db_iter_->key().ToString(), db_iter_->value().ToString()};
+      key_ = MakeStringView(db_iter_->key());
+      value_ = MakeStringView(db_iter_->value());
     }
   }
 }
@@ -77,7 +81,9 @@ void LevelDbTransaction::Iterator::Seek(const std::string& key) {
   db_iter_->Seek(key);
   HARD_ASSERT(db_iter_->status().ok(), "leveldb iterator reported an error: %s",
               db_iter_->status().ToString());
-  for (; db_iter_->Valid() && IsDeleted(db_iter_->key()); db_iter_->Next()) {
+  deletions_iter_ = txn_->deletions_.lower_bound(key);
+  for (; db_iter_->Valid() && IsDeleted(MakeStringView(db_iter_->key()));
+       db_iter_->Next()) {
   }
   HARD_ASSERT(db_iter_->status().ok(), "leveldb iterator reported an error: %s",
               db_iter_->status().ToString());
@@ -86,28 +92,33 @@ void LevelDbTransaction::Iterator::Seek(const std::string& key) {
   last_version_ = txn_->version_;
 }
 
-const std::string& LevelDbTransaction::Iterator::key() const {
+absl::string_view LevelDbTransaction::Iterator::key() const {
   HARD_ASSERT(Valid(), "key() called on invalid iterator");
-  return current_.first;
+  return key_;
 }
 
-const std::string& LevelDbTransaction::Iterator::value() const {
+absl::string_view LevelDbTransaction::Iterator::value() const {
   HARD_ASSERT(Valid(), "value() called on invalid iterator");
-  return current_.second;
+  return value_;
 }
 
-bool LevelDbTransaction::Iterator::IsDeleted(leveldb::Slice slice) {
-  return txn_->deletions_.find(slice.ToString()) != txn_->deletions_.end();
+bool LevelDbTransaction::Iterator::IsDeleted(absl::string_view key) {
+  const Deletions& deletions = txn_->deletions_;
+  while (deletions_iter_ != deletions.end() &&
+         absl::string_view(*deletions_iter_) < key) {
+    ++deletions_iter_;
+  }
+  return deletions_iter_ != deletions.end() && *deletions_iter_ == key;
 }
 
 bool LevelDbTransaction::Iterator::SyncToTransaction() {
   if (last_version_ < txn_->version_) {
-    // Intentionally copying here since Seek() may update current_. We need the
+    // Intentionally copying here since Seek() invalidates key_. We need the
     // copy to do the comparison below.
-    const std::string current_key = current_.first;
+    const std::string current_key(key_);
     Seek(current_key);
     // If we advanced, we don't need to advance again.
-    return is_valid_ && current_.first > current_key;
+    return is_valid_ && key_ > current_key;
   } else {
     return false;
   }
@@ -116,7 +127,7 @@ bool LevelDbTransaction::Iterator::SyncToTransaction() {
 void LevelDbTransaction::Iterator::AdvanceLDB() {
   do {
     db_iter_->Next();
-  } while (db_iter_->Valid() && IsDeleted(db_iter_->key()));
+  } while (db_iter_->Valid() && IsDeleted(MakeStringView(db_iter_->key())));
   HARD_ASSERT(db_iter_->status().ok(), "leveldb iterator reported an error: %s",
               db_iter_->status().ToString());
 }
@@ -180,24 +191,26 @@ LevelDbTransaction::NewIterator() {
 }
 
 Status LevelDbTransaction::Get(absl::string_view key, std::string* value) {
-  std::string key_string(key);
-  if (deletions_.find(key_string) != deletions_.end()) {
-    return Status::NotFound(key_string + " is not present in the transaction");
+  if (deletions_.find(key) != deletions_.end()) {
+    return Status::NotFound(
+        absl::StrCat(key, " is not present in the transaction"));
   } else {
-    Mutations::iterator iter{mutations_.find(key_string)};
+    Mutations::iterator iter{mutations_.find(key)};
     if (iter != mutations_.end()) {
       *value = iter->second;
       return Status::OK();
     } else {
-      return db_->Get(read_options_, key_string, value);
+      return db_->Get(read_options_, MakeSlice(key), value);
     }
   }
 }
 
 void LevelDbTransaction::Delete(absl::string_view key) {
-  std::string to_delete(key);
-  deletions_.insert(to_delete);
-  mutations_.erase(to_delete);
+  Mutations::iterator iter{mutations_.find(key)};
+  if (iter != mutations_.end()) {
+    mutations_.erase(iter);
+  }
+  deletions_.insert(std::string(key));
   version_++;
 }
 
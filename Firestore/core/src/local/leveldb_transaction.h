@@ -18,6 +18,7 @@
 #define FIRESTORE_CORE_SRC_LOCAL_LEVELDB_TRANSACTION_H_
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <set>
@@ -40,8 +41,10 @@ namespace local {
  * changes and committed values.
  */
 class LevelDbTransaction {
-  using Deletions = std::set<std::string>;
-  using Mutations = std::map<std::string, std::string>;
+  // Both containers use transparent comparators so that they can be probed
+  // with `absl::string_view`s without allocating a key.
+  using Deletions = std::set<std::string, std::less<>>;
+  using Mutations = std::map<std::string, std::string, std::less<>>;
 
  public:
   /**
@@ -71,14 +74,16 @@ class LevelDbTransaction {
     void Next();
 
     /**
-     * Returns the key of the current entry
+     * Returns the key of the current entry. The returned view remains valid
+     * until the next call to Seek() or Next().
      */
-    const std::string& key() const;
+    absl::string_view key() const;
 
     /**
-     * Returns the value of the current entry
+     * Returns the value of the current entry. The returned view remains valid
+     * until the next call to Seek() or Next().
      */
-    const std::string& value() const;
+    absl::string_view value() const;
 
    private:
     /**
@@ -87,10 +92,12 @@ class LevelDbTransaction {
     void AdvanceLDB();
 
     /**
-     * Returns true if the given slice matches a key present in the deletions_
-     * set.
+     * Returns true if the given key is present in the deletions_ set.
+     *
+     * Keys must be passed in ascending order between calls to Seek(): the
+     * deletions are merged with the leveldb iteration rather than looked up.
      */
-    bool IsDeleted(leveldb::Slice slice);
+    bool IsDeleted(absl::string_view key);
 
     /**
      * Syncs with the underlying transaction. If the transaction has been
@@ -102,7 +109,7 @@ class LevelDbTransaction {
 
     /**
      * Given the current state of the internal iterators, set is_valid_,
-     * is_mutation_, and current_.
+     * is_mutation_, key_ and value_.
      */
     void UpdateCurrent();
 
@@ -113,11 +120,19 @@ class LevelDbTransaction {
     // The underlying transaction.
     LevelDbTransaction* txn_;
     Mutations::iterator mutations_iter_;
-    // We save the current key and value so that once an iterator is Valid(), it
-    // remains so at least until the next call to Seek() or Next(), even if the
-    // underlying data is deleted.
-    std::pair<std::string, std::string> current_;
-    // True if current_ represents an entry in the mutations_ map, rather than
+    // The first deletion not less than the current leveldb key. Only valid
+    // between a call to Seek() and the next change to the transaction.
+    Deletions::const_iterator deletions_iter_;
+    // The current key and value. For committed data these point into the
+    // buffers of db_iter_, which remain valid until db_iter_ moves. Pending
+    // mutations can be overwritten or erased by the transaction, so they are
+    // copied into mutation_ instead. Either way, once an iterator is Valid(),
+    // it remains so at least until the next call to Seek() or Next(), even if
+    // the underlying data is deleted.
+    absl::string_view key_;
+    absl::string_view value_;
+    std::pair<std::string, std::string> mutation_;
+    // True if the current entry is from the mutations_ map, rather than
     // committed data.
     bool is_mutation_;
     // True if the iterator pointed to a valid entry the last time Next() or
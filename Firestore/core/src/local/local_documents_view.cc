@@ -166,9 +166,13 @@ DocumentMap LocalDocumentsView::GetDocumentsMatchingCollectionQuery(
     const Query& query,
     const IndexOffset& offset,
     absl::optional<QueryContext>& context) {
-  // Get locally mutated documents
-  OverlayByDocumentKeyMap overlays = document_overlay_cache_->GetOverlays(
-      query.path(), offset.largest_batch_id());
+  // Get locally mutated documents. Most collections have no pending writes,
+  // which the overlay cache can tell without reading from persistence.
+  OverlayByDocumentKeyMap overlays;
+  if (document_overlay_cache_->HasOverlays(query.path())) {
+    overlays = document_overlay_cache_->GetOverlays(query.path(),
+                                                    offset.largest_batch_id());
+  }
   MutableDocumentMap remote_documents =
       remote_document_cache_->GetDocumentsMatchingQuery(
           query, offset, context, absl::nullopt, overlays);
@@ -188,11 +192,13 @@ DocumentMap LocalDocumentsView::GetDocumentsMatchingCollectionQuery(
     const auto& key = entry.first;
     MutableDocument doc = entry.second;
 
-    auto overlay_it = overlays.find(key);
-    if (overlay_it != overlays.end()) {
-      (*overlay_it)
-          .second.mutation()
-          .ApplyToLocalView(doc, FieldMask(), Timestamp::Now());
+    if (!overlays.empty()) {
+      auto overlay_it = overlays.find(key);
+      if (overlay_it != overlays.end()) {
+        (*overlay_it)
+            .second.mutation()
+            .ApplyToLocalView(doc, FieldMask(), Timestamp::Now());
+      }
     }
     // Finally, insert the documents that still match the query
     if (query.Matches(doc)) {
@@ -204,7 +210,10 @@ DocumentMap LocalDocumentsView::GetDocumentsMatchingCollectionQuery(
 }
 
 Document LocalDocumentsView::GetDocument(const DocumentKey& key) {
-  absl::optional<Overlay> overlay = document_overlay_cache_->GetOverlay(key);
+  absl::optional<Overlay> overlay;
+  if (document_overlay_cache_->HasOverlays(key.path().PopLast())) {
+    overlay = document_overlay_cache_->GetOverlay(key);
+  }
   MutableDocument document = GetBaseDocument(key, overlay);
   if (overlay.has_value()) {
     overlay.value().mutation().ApplyToLocalView(document, FieldMask(),
@@ -221,18 +230,73 @@ DocumentMap LocalDocumentsView::GetDocuments(const DocumentKeySet& keys) {
 DocumentMap LocalDocumentsView::GetLocalViewOfDocuments(
     const MutableDocumentMap& base_docs,
     const DocumentKeySet& existence_state_changed) {
+  DocumentMap result;
+  if (existence_state_changed.empty() &&
+      !document_overlay_cache_->HasAnyOverlays()) {
+    // Without pending writes the remote documents are the local view.
+    for (const auto& entry : base_docs) {
+      result = result.insert(entry.first, Document(entry.second));
+    }
+    return result;
+  }
+
   OverlayByDocumentKeyMap overlays;
   PopulateOverlays(overlays, DocumentKeySet::FromKeysOf(base_docs));
   auto overlayed_documents =
       ComputeViews(base_docs, std::move(overlays), existence_state_changed);
 
-  DocumentMap result;
   for (auto& entry : overlayed_documents) {
     result = result.insert(entry.first, std::move(entry.second).document());
   }
   return result;
 }
 
+void LocalDocumentsView::ForEachDocumentInCollection(
+    const ResourcePath& collection,
+    absl::optional<DocumentKey> start_after,
+    size_t chunk_size,
+    const std::function<bool(const Document&)>& visitor) {
+  HARD_ASSERT(chunk_size > 0, "Chunk size must be at least 1");
+  bool has_overlays = document_overlay_cache_->HasOverlays(collection);
+
+  while (true) {
+    MutableDocumentMap documents =
+        remote_document_cache_->GetDocumentsInCollection(
+            collection, start_after, chunk_size);
+    bool is_last_chunk = documents.size() < chunk_size;
+
+    // The last chunk extends to the end of the collection.
+    absl::optional<DocumentKey> end_at;
+    if (!is_last_chunk) {
+      end_at = documents.max()->first;
+    }
+
+    OverlayByDocumentKeyMap overlays;
+    if (has_overlays) {
+      overlays = document_overlay_cache_->GetOverlaysInRange(
+          collection, start_after, end_at);
+      for (const auto& entry : overlays) {
+        if (documents.find(entry.first) == documents.end()) {
+          documents = documents.insert(
+              entry.first, MutableDocument::InvalidDocument(entry.first));
+        }
+      }
+    }
+
+    model::OverlayedDocumentMap local_views =
+        ComputeViews(documents, std::move(overlays), DocumentKeySet{});
+    for (const auto& entry : documents) {
+      const Document& document = local_views.at(entry.first).document();
+      if (document->is_found_document() && !visitor(document)) {
+        return;
+      }
+    }
+
+    if (is_last_chunk) return;
+    start_after = end_at;
+  }
+}
+
 model::OverlayedDocumentMap LocalDocumentsView::GetOverlayedDocuments(
     const MutableDocumentMap& docs) {
   OverlayByDocumentKeyMap overlays;
@@ -243,9 +307,23 @@ model::OverlayedDocumentMap LocalDocumentsView::GetOverlayedDocuments(
 void LocalDocumentsView::PopulateOverlays(
     OverlayByDocumentKeyMap& overlays,
     const model::DocumentKeySet& keys) const {
+  if (!document_overlay_cache_->HasAnyOverlays()) {
+    return;
+  }
+
+  // Keys are sorted, so documents of the same collection are mostly adjacent
+  // and the overlay summary is consulted about once per collection.
   std::set<DocumentKey> missing_overlays;
+  absl::optional<ResourcePath> collection;
+  bool collection_has_overlays = false;
   for (const DocumentKey& key : keys) {
-    if (overlays.find(key) == overlays.end()) {
+    if (!collection.has_value() ||
+        !collection->IsImmediateParentOf(key.path())) {
+      collection = key.path().PopLast();
+      collection_has_overlays =
+          document_overlay_cache_->HasOverlays(collection.value());
+    }
+    if (collection_has_overlays && overlays.find(key) == overlays.end()) {
       missing_overlays.insert(key);
     }
   }
@@ -17,6 +17,7 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_LOCAL_DOCUMENTS_VIEW_H_
 #define FIRESTORE_CORE_SRC_LOCAL_LOCAL_DOCUMENTS_VIEW_H_
 
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -131,6 +132,22 @@ class LocalDocumentsView {
    */
   void RecalculateAndSaveOverlays(const model::DocumentKeySet& keys) const;
 
+  /**
+   * Visits the local view of the documents in `collection` that exist, in key
+   * order, starting after `start_after`. The scan stops once `visitor` returns
+   * false.
+   *
+   * The remote documents are read in chunks of `chunk_size` together with the
+   * overlays of the key range that each chunk covers, so that only one chunk
+   * is held in memory at a time. Documents that only exist locally are visited
+   * in the chunk they sort into.
+   */
+  void ForEachDocumentInCollection(
+      const model::ResourcePath& collection,
+      absl::optional<model::DocumentKey> start_after,
+      size_t chunk_size,
+      const std::function<bool(const model::Document&)>& visitor);
+
   /**
    * Performs a query against the local view of all documents.
    *
@@ -157,6 +174,7 @@ class LocalDocumentsView {
 
  private:
   friend class QueryEngine;
+  friend class QueryCursor;
 
   friend class CountingQueryEngine;  // For testing
 
@@ -16,6 +16,7 @@
 
 #include "Firestore/core/src/local/local_serializer.h"
 
+#include <cstdint>
 #include <cstdlib>
 #include <limits>
 #include <memory>
@@ -29,10 +30,13 @@
 #include "Firestore/Protos/nanopb/google/firestore/admin/index.nanopb.h"
 #include "Firestore/Protos/nanopb/google/firestore/v1/document.nanopb.h"
 #include "Firestore/Protos/nanopb/google/firestore/v1/write.nanopb.h"
+#include "Firestore/core/include/firebase/firestore/timestamp.h"
 #include "Firestore/core/src/bundle/bundle_metadata.h"
 #include "Firestore/core/src/bundle/named_query.h"
 #include "Firestore/core/src/core/query.h"
 #include "Firestore/core/src/local/target_data.h"
+#include "Firestore/core/src/model/database_id.h"
+#include "Firestore/core/src/model/document_key.h"
 #include "Firestore/core/src/model/field_path.h"
 #include "Firestore/core/src/model/mutable_document.h"
 #include "Firestore/core/src/model/mutation_batch.h"
@@ -54,7 +58,9 @@ using bundle::BundledQuery;
 using bundle::BundleMetadata;
 using bundle::NamedQuery;
 using core::Target;
+using model::DatabaseId;
 using model::DeepClone;
+using model::DocumentKey;
 using model::FieldPath;
 using model::FieldTransform;
 using model::MutableDocument;
@@ -76,6 +82,54 @@ using nanopb::Writer;
 using util::Status;
 using util::StringFormat;
 
+/** The encoded size of a `true` bool field with a tag number below 16. */
+constexpr size_t kBoolFieldSize = 2;
+
+/** Returns the number of bytes needed to encode `value` as a varint. */
+size_t VarintSize(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+/**
+ * Returns the encoded size of a string, bytes or message field with a tag
+ * number below 16 whose contents are `payload_size` bytes long.
+ */
+size_t LengthDelimitedFieldSize(size_t payload_size) {
+  return 1 + VarintSize(payload_size) + payload_size;
+}
+
+/** Returns the encoded size of the contents of a `Timestamp` message. */
+size_t TimestampSize(const Timestamp& timestamp) {
+  size_t size = 0;
+  if (timestamp.seconds() != 0) {
+    size += 1 + VarintSize(static_cast<uint64_t>(timestamp.seconds()));
+  }
+  if (timestamp.nanoseconds() != 0) {
+    size += 1 + VarintSize(static_cast<uint64_t>(
+                    static_cast<int64_t>(timestamp.nanoseconds())));
+  }
+  return size;
+}
+
+/**
+ * Returns the length of the resource name `Serializer::EncodeKey()` produces
+ * for `key`: "projects/{project}/databases/{database}/documents/{path}".
+ */
+size_t ResourceNameSize(const DatabaseId& database_id, const DocumentKey& key) {
+  size_t size = sizeof("projects//databases//documents") - 1 +
+                database_id.project_id().size() +
+                database_id.database_id().size();
+  for (const std::string& segment : key.path()) {
+    size += 1 + segment.size();
+  }
+  return size;
+}
+
 }  // namespace
 
 Message<firestore_client_MaybeDocument> LocalSerializer::EncodeMaybeDocument(
@@ -323,6 +377,50 @@ Message<firestore_client_WriteBatch> LocalSerializer::EncodeMutationBatch(
   return result;
 }
 
+size_t LocalSerializer::EncodedSize(const MutableDocument& maybe_doc) const {
+  // Mirrors EncodeMaybeDocument() without building the message, which would
+  // deep copy the document's fields.
+  size_t document_size = LengthDelimitedFieldSize(
+      ResourceNameSize(rpc_serializer_.database_id(), maybe_doc.key()));
+  size_t version_size = TimestampSize(maybe_doc.version().timestamp());
+  bool has_committed_mutations = maybe_doc.has_committed_mutations();
+
+  if (maybe_doc.is_found_document()) {
+    google_firestore_v1_MapValue fields = maybe_doc.value().map_value;
+    for (pb_size_t i = 0; i < fields.fields_count; ++i) {
+      size_t entry_size = 0;
+      pb_get_encoded_size(&entry_size,
+                          google_firestore_v1_MapValue_FieldsEntry_fields,
+                          &fields.fields[i]);
+      document_size += LengthDelimitedFieldSize(entry_size);
+    }
+    // Document.update_time is always written, even when zero.
+    document_size += LengthDelimitedFieldSize(version_size);
+  } else if (maybe_doc.is_no_document() || maybe_doc.is_unknown_document()) {
+    // NoDocument.read_time and UnknownDocument.version are omitted when zero.
+    if (version_size > 0) {
+      document_size += LengthDelimitedFieldSize(version_size);
+    }
+    has_committed_mutations |= maybe_doc.is_unknown_document();
+  } else {
+    HARD_FAIL("Unknown document type %s", maybe_doc.ToString());
+  }
+
+  size_t size = LengthDelimitedFieldSize(document_size);
+  if (has_committed_mutations) {
+    size += kBoolFieldSize;
+  }
+  return size;
+}
+
+size_t LocalSerializer::EncodedSize(const MutationBatch& mutation_batch) const {
+  return nanopb::EncodedSize(EncodeMutationBatch(mutation_batch));
+}
+
+size_t LocalSerializer::EncodedSize(const TargetData& target_data) const {
+  return nanopb::EncodedSize(EncodeTargetData(target_data));
+}
+
 MutationBatch LocalSerializer::DecodeMutationBatch(
     nanopb::Reader* reader, firestore_client_WriteBatch& proto) const {
   int batch_id = proto.batch_id;
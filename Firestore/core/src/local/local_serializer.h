@@ -130,6 +130,25 @@ class LocalSerializer {
   model::MutationBatch DecodeMutationBatch(
       nanopb::Reader* reader, firestore_client_WriteBatch& proto) const;
 
+  /**
+   * Returns the number of bytes the local storage encoding of the given
+   * document occupies. The size is computed from the document itself, without
+   * building its message or copying its fields.
+   */
+  size_t EncodedSize(const model::MutableDocument& maybe_doc) const;
+
+  /**
+   * Returns the number of bytes the local storage encoding of the given
+   * mutation batch occupies, without serializing it into a buffer.
+   */
+  size_t EncodedSize(const model::MutationBatch& mutation_batch) const;
+
+  /**
+   * Returns the number of bytes the local storage encoding of the given
+   * target data occupies, without serializing it into a buffer.
+   */
+  size_t EncodedSize(const TargetData& target_data) const;
+
   google_protobuf_Timestamp EncodeVersion(
       const model::SnapshotVersion& version) const;
 
@@ -30,6 +30,7 @@
 #include "Firestore/core/src/local/lru_garbage_collector.h"
 #include "Firestore/core/src/local/overlay_migration_manager.h"
 #include "Firestore/core/src/local/persistence.h"
+#include "Firestore/core/src/local/query_cursor.h"
 #include "Firestore/core/src/local/query_engine.h"
 #include "Firestore/core/src/local/query_result.h"
 #include "Firestore/core/src/local/reference_delegate.h"
@@ -41,6 +42,7 @@
 #include "Firestore/core/src/model/patch_mutation.h"
 #include "Firestore/core/src/remote/remote_event.h"
 #include "Firestore/core/src/util/log.h"
+#include "Firestore/core/src/util/phase_timer.h"
 #include "Firestore/core/src/util/set_util.h"
 #include "Firestore/core/src/util/to_string.h"
 
@@ -129,12 +131,26 @@ LocalStore::LocalStore(Persistence* persistence,
 LocalStore::~LocalStore() = default;
 
 void LocalStore::Start() {
+  util::PhaseTimer timer;
   StartMutationQueue();
+  start_timings_.mutation_queue = timer.EndPhase();
   StartIndexManager();
+  start_timings_.index_manager = timer.EndPhase();
   overlay_migration_manager_->Run();
+  start_timings_.overlay_migration = timer.EndPhase();
   TargetId target_id = target_cache_->highest_target_id();
   target_id_generator_ =
       TargetIdGenerator::TargetCacheTargetIdGenerator(target_id);
+
+  LOG_DEBUG(
+      "LocalStore started in %s us (mutation queue: %s us, index manager: %s "
+      "us, overlay migration: %s us)",
+      (start_timings_.mutation_queue + start_timings_.index_manager +
+       start_timings_.overlay_migration)
+          .count(),
+      start_timings_.mutation_queue.count(),
+      start_timings_.index_manager.count(),
+      start_timings_.overlay_migration.count());
 }
 
 void LocalStore::StartMutationQueue() {
@@ -573,6 +589,19 @@ QueryResult LocalStore::ExecuteQuery(const Query& query,
   });
 }
 
+model::ObjectValue LocalStore::ExecuteAggregation(
+    const Query& query, const std::vector<model::AggregateField>& aggregates) {
+  return persistence_->Run("ExecuteAggregation", [&] {
+    return query_engine_->ComputeAggregates(query, aggregates);
+  });
+}
+
+std::vector<Document> LocalStore::ReadQueryCursorPage(QueryCursor& cursor) {
+  return persistence_->Run("ReadQueryCursorPage", [&] {
+    return cursor.NextPage(local_documents_.get(), query_engine_);
+  });
+}
+
 DocumentKeySet LocalStore::GetRemoteDocumentKeys(TargetId target_id) {
   return persistence_->Run("RemoteDocumentKeysForTarget", [&] {
     return target_cache_->GetMatchingKeys(target_id);
@@ -591,6 +620,20 @@ int LocalStore::Backfill() const {
   });
 }
 
+int LocalStore::Backfill(std::chrono::milliseconds time_budget) const {
+  int documents_processed = Backfill();
+  if (!backfill_progress().up_to_date &&
+      time_budget > std::chrono::milliseconds::zero()) {
+    documents_processed +=
+        index_backfiller_->WriteIndexEntriesInBulk(this, time_budget);
+  }
+  return documents_processed;
+}
+
+const IndexBackfillProgress& LocalStore::backfill_progress() const {
+  return index_backfiller_->progress();
+}
+
 bool LocalStore::HasNewerBundle(const bundle::BundleMetadata& metadata) {
   return persistence_->Run("Has newer bundle", [&] {
     absl::optional<bundle::BundleMetadata> cached_metadata =
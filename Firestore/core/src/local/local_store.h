@@ -17,6 +17,7 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_LOCAL_STORE_H_
 #define FIRESTORE_CORE_SRC_LOCAL_LOCAL_STORE_H_
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -46,6 +47,7 @@ class Query;
 }  // namespace core
 
 namespace model {
+class AggregateField;
 class FieldIndex;
 }  // namespace model
 
@@ -64,14 +66,23 @@ class LocalWriteResult;
 class LruGarbageCollector;
 class MutationQueue;
 class Persistence;
+class QueryCursor;
 class QueryEngine;
 class QueryResult;
 class RemoteDocumentCache;
 class TargetCache;
 class IndexBackfiller;
+struct IndexBackfillProgress;
 
 struct LruResults;
 
+/** The time spent in each phase of `LocalStore::Start()`. */
+struct LocalStoreStartTimings {
+  std::chrono::microseconds mutation_queue{0};
+  std::chrono::microseconds index_manager{0};
+  std::chrono::microseconds overlay_migration{0};
+};
+
 /**
  * Local storage in the Firestore client. Coordinates persistence components
  * like the mutation queue and remote document cache to present a latency
@@ -123,6 +134,14 @@ class LocalStore : public bundle::BundleCallback {
   /** Performs any initial startup actions required by the local store. */
   void Start();
 
+  /**
+   * Returns how long each phase of `Start()` took, for diagnosing slow client
+   * startup.
+   */
+  const LocalStoreStartTimings& start_timings() const {
+    return start_timings_;
+  }
+
   /**
    * Tells the LocalStore that the currently authenticated user has changed.
    *
@@ -224,6 +243,20 @@ class LocalStore : public bundle::BundleCallback {
    */
   QueryResult ExecuteQuery(const core::Query& query, bool use_previous_results);
 
+  /**
+   * Computes the given aggregations over the local view of the documents that
+   * match the query, without building a query result.
+   */
+  model::ObjectValue ExecuteAggregation(
+      const core::Query& query,
+      const std::vector<model::AggregateField>& aggregates);
+
+  /**
+   * Reads the next page of documents from the given cursor. Returns an empty
+   * page once the cursor is exhausted.
+   */
+  std::vector<model::Document> ReadQueryCursorPage(QueryCursor& cursor);
+
   /**
    * Notify the local store of the changed views to locally pin / unpin
    * documents.
@@ -256,6 +289,16 @@ class LocalStore : public bundle::BundleCallback {
    */
   int Backfill() const;
 
+  /**
+   * Runs a single backfill operation and, if documents are left unindexed,
+   * keeps indexing them in bulk until `time_budget` has elapsed. Returns the
+   * number of documents processed.
+   */
+  int Backfill(std::chrono::milliseconds time_budget) const;
+
+  /** Returns the progress of index backfilling. */
+  const IndexBackfillProgress& backfill_progress() const;
+
   /**
    * Returns whether the given bundle has already been loaded and its create
    * time is newer or equal to the currently loading bundle.
@@ -379,6 +422,8 @@ class LocalStore : public bundle::BundleCallback {
   /** Used to generate target IDs for queries tracked locally. */
   core::TargetIdGenerator target_id_generator_;
 
+  LocalStoreStartTimings start_timings_;
+
   /**
    * The set of all mutations that have been sent but not yet been applied to
    * the backend.
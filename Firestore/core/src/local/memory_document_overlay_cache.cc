@@ -56,6 +56,7 @@ void MemoryDocumentOverlayCache::RemoveOverlaysForBatchId(int batch_id) {
     const DocumentKeySet& keys = overlay_by_batch_id_iter->second;
     for (const auto& key : keys) {
       overlays_ = overlays_.erase(key);
+      summary_.Remove(key);
     }
     overlay_by_batch_id_.erase(overlay_by_batch_id_iter);
   }
@@ -90,6 +91,33 @@ OverlayByDocumentKeyMap MemoryDocumentOverlayCache::GetOverlays(
   return result;
 }
 
+OverlayByDocumentKeyMap MemoryDocumentOverlayCache::GetOverlaysInRange(
+    const ResourcePath& collection,
+    const absl::optional<DocumentKey>& start_after,
+    const absl::optional<DocumentKey>& end_at) const {
+  OverlayByDocumentKeyMap result;
+
+  std::size_t immediate_children_path_length{collection.size() + 1};
+  auto overlays_iter =
+      overlays_.lower_bound(start_after.has_value()
+                                ? start_after.value()
+                                : DocumentKey(collection.Append("")));
+
+  for (; overlays_iter != overlays_.end(); ++overlays_iter) {
+    const DocumentKey& key = overlays_iter->first;
+    if (!collection.IsPrefixOf(key.path()) ||
+        (end_at.has_value() && key > end_at.value())) {
+      break;
+    }
+    if (key.path().size() == immediate_children_path_length &&
+        (!start_after.has_value() || key != start_after.value())) {
+      result[key] = overlays_iter->second;
+    }
+  }
+
+  return result;
+}
+
 OverlayByDocumentKeyMap MemoryDocumentOverlayCache::GetOverlays(
     absl::string_view collection_group,
     int since_batch_id,
@@ -125,6 +153,15 @@ OverlayByDocumentKeyMap MemoryDocumentOverlayCache::GetOverlays(
   return result;
 }
 
+bool MemoryDocumentOverlayCache::HasOverlays(
+    const ResourcePath& collection) const {
+  return summary_.Contains(collection);
+}
+
+bool MemoryDocumentOverlayCache::HasAnyOverlays() const {
+  return !overlays_.empty();
+}
+
 int MemoryDocumentOverlayCache::GetOverlayCount() const {
   return overlays_.size();
 }
@@ -140,6 +177,7 @@ void MemoryDocumentOverlayCache::SaveOverlay(int largest_batch_id,
       HARD_ASSERT(overlay_by_batch_id_iter != overlay_by_batch_id_.end());
       DocumentKeySet& existing_keys = overlay_by_batch_id_iter->second;
       existing_keys.erase(mutation.key());
+      summary_.Remove(mutation.key());
     }
   }
 
@@ -147,6 +185,7 @@ void MemoryDocumentOverlayCache::SaveOverlay(int largest_batch_id,
       overlays_.insert(mutation.key(), Overlay(largest_batch_id, mutation));
 
   overlay_by_batch_id_[largest_batch_id].insert(mutation.key());
+  summary_.Add(mutation.key());
 }
 
 }  // namespace local
@@ -22,6 +22,7 @@
 
 #include "Firestore/core/src/immutable/sorted_map.h"
 #include "Firestore/core/src/local/document_overlay_cache.h"
+#include "Firestore/core/src/local/overlay_collection_summary.h"
 #include "Firestore/core/src/model/model_fwd.h"
 
 namespace firebase {
@@ -50,10 +51,19 @@ class MemoryDocumentOverlayCache final : public DocumentOverlayCache {
   model::OverlayByDocumentKeyMap GetOverlays(
       const model::ResourcePath& collection, int since_batch_id) const override;
 
+  model::OverlayByDocumentKeyMap GetOverlaysInRange(
+      const model::ResourcePath& collection,
+      const absl::optional<model::DocumentKey>& start_after,
+      const absl::optional<model::DocumentKey>& end_at) const override;
+
   model::OverlayByDocumentKeyMap GetOverlays(absl::string_view collection_group,
                                              int since_batch_id,
                                              std::size_t count) const override;
 
+  bool HasOverlays(const model::ResourcePath& collection) const override;
+
+  bool HasAnyOverlays() const override;
+
  private:
   using OverlayByDocumentKeySortedMap =
       immutable::SortedMap<model::DocumentKey, model::Overlay>;
@@ -67,6 +77,7 @@ class MemoryDocumentOverlayCache final : public DocumentOverlayCache {
 
   OverlayByDocumentKeySortedMap overlays_;
   DocumentKeysByBatchIdMap overlay_by_batch_id_;
+  OverlayCollectionSummary summary_;
 };
 
 }  // namespace local
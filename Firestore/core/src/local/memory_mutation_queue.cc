@@ -97,6 +97,9 @@ MutationBatch MemoryMutationQueue::AddMutationBatch(
   MutationBatch batch(batch_id, local_write_time, std::move(base_mutations),
                       std::move(mutations));
   queue_.push_back(batch);
+  if (sizer_) {
+    byte_size_ += sizer_->CalculateByteSize(batch);
+  }
 
   // Track references by document key and index collection parents.
   for (const Mutation& mutation : batch.mutations()) {
@@ -116,6 +119,9 @@ void MemoryMutationQueue::RemoveMutationBatch(const MutationBatch& batch) {
   HARD_ASSERT(head.batch_id() == batch.batch_id(),
               "Can only remove the first entry of the mutation queue");
 
+  if (sizer_) {
+    byte_size_ -= sizer_->CalculateByteSize(head);
+  }
   queue_.erase(queue_.begin());
 
   // Remove entries from the index too.
@@ -260,11 +266,14 @@ bool MemoryMutationQueue::ContainsKey(const model::DocumentKey& key) {
 }
 
 int64_t MemoryMutationQueue::CalculateByteSize(const Sizer& sizer) {
-  int64_t count = 0;
-  for (const auto& batch : queue_) {
-    count += sizer.CalculateByteSize(batch);
+  if (!sizer_) {
+    for (const auto& batch : queue_) {
+      byte_size_ += sizer.CalculateByteSize(batch);
+    }
+    sizer_ = &sizer;
   }
-  return count;
+  HARD_ASSERT(sizer_ == &sizer, "Byte size was tracked with another sizer");
+  return byte_size_;
 }
 
 ByteString MemoryMutationQueue::GetLastStreamToken() {
@@ -83,6 +83,13 @@ class MemoryMutationQueue : public MutationQueue {
 
   bool ContainsKey(const model::DocumentKey& key);
 
+  /**
+   * Returns the total size of the batches in this queue according to `sizer`.
+   *
+   * The first call sums over the whole queue; from then on the total is kept
+   * up to date as entries are added and removed, so later calls (which must
+   * pass the same `sizer`) are O(1).
+   */
   int64_t CalculateByteSize(const Sizer& sizer);
 
   nanopb::ByteString GetLastStreamToken() override;
@@ -145,6 +152,10 @@ class MemoryMutationQueue : public MutationQueue {
 
   /** An ordered mapping between documents and the mutation batch IDs. */
   DocumentKeyReferenceSet batches_by_document_key_;
+
+  /** The sizer `byte_size_` is tracked with, once one has been supplied. */
+  const Sizer* sizer_ = nullptr;
+  int64_t byte_size_ = 0;
 };
 
 }  // namespace local
@@ -59,6 +59,7 @@ std::unique_ptr<MemoryPersistence> MemoryPersistence::WithLruGarbageCollector(
 MemoryPersistence::MemoryPersistence()
     : target_cache_(this),
       remote_document_cache_(this),
+      index_manager_(this),
       overlay_migration_manager_(),
       started_(true) {
 }
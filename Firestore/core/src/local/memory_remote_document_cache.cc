@@ -16,6 +16,10 @@
 
 #include "Firestore/core/src/local/memory_remote_document_cache.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "Firestore/core/src/core/query.h"
 #include "Firestore/core/src/local/memory_lru_reference_delegate.h"
 #include "Firestore/core/src/local/memory_persistence.h"
@@ -36,6 +40,7 @@ using model::DocumentKeySet;
 using model::ListenSequenceNumber;
 using model::MutableDocument;
 using model::MutableDocumentMap;
+using model::ResourcePath;
 using model::SnapshotVersion;
 
 MemoryRemoteDocumentCache::MemoryRemoteDocumentCache(
@@ -46,19 +51,39 @@ MemoryRemoteDocumentCache::MemoryRemoteDocumentCache(
 void MemoryRemoteDocumentCache::Add(const MutableDocument& document,
                                     const model::SnapshotVersion& read_time) {
   // Note: We create an explicit copy to prevent further modifications.
-  docs_ =
-      docs_.insert(document.key(), document.Clone().WithReadTime(read_time));
-
+  MutableDocument stored = document.Clone().WithReadTime(read_time);
+  if (sizer_) {
+    SubtractByteSize(document.key());
+    byte_size_ += sizer_->CalculateByteSize(stored);
+  }
   NOT_NULL(index_manager_);
-  index_manager_->AddToCollectionParentIndex(document.key().path().PopLast());
+  index_manager_->UpdateIndexEntries(
+      model::DocumentMap{}.insert(document.key(), stored));
+
+  ResourcePath collection = document.key().path().PopLast();
+  DocumentsByKey& documents = collections_[collection];
+  documents = documents.insert(document.key(), std::move(stored));
+
+  index_manager_->AddToCollectionParentIndex(collection);
 }
 
 void MemoryRemoteDocumentCache::Remove(const DocumentKey& key) {
-  docs_ = docs_.erase(key);
+  if (sizer_) {
+    SubtractByteSize(key);
+  }
+  auto found = collections_.find(key.path().PopLast());
+  if (found != collections_.end()) {
+    found->second = found->second.erase(key);
+    if (found->second.empty()) {
+      collections_.erase(found);
+    }
+  }
+  RemoveIndexEntries(key);
 }
 
 MutableDocument MemoryRemoteDocumentCache::Get(const DocumentKey& key) const {
-  const auto& entry = docs_.get(key);
+  const DocumentsByKey* documents = FindCollection(key.path().PopLast());
+  const auto& entry = documents ? documents->get(key) : absl::nullopt;
   // Note: We create an explicit copy to prevent modifications of the backing
   // data.
   return entry ? entry->Clone() : MutableDocument::InvalidDocument(key);
@@ -76,13 +101,72 @@ MutableDocumentMap MemoryRemoteDocumentCache::GetAll(
   return results;
 }
 
-// This method should only be called from the IndexBackfiller if LevelDB is
-// enabled.
-MutableDocumentMap MemoryRemoteDocumentCache::GetAll(const std::string&,
-                                                     const model::IndexOffset&,
-                                                     size_t) const {
-  util::ThrowInvalidArgument(
-      "getAll(String, IndexOffset, int) is not supported.");
+MutableDocumentMap MemoryRemoteDocumentCache::GetAll(
+    const std::string& collection_group,
+    const model::IndexOffset& offset,
+    size_t limit) const {
+  NOT_NULL(index_manager_);
+  std::vector<const MutableDocument*> matches;
+  for (const ResourcePath& parent :
+       index_manager_->GetCollectionParents(collection_group)) {
+    const DocumentsByKey* documents =
+        FindCollection(parent.Append(collection_group));
+    if (!documents) {
+      continue;
+    }
+    for (const auto& kv : *documents) {
+      const MutableDocument& document = kv.second;
+      if (model::IndexOffset::FromDocument(document).CompareTo(offset) ==
+          util::ComparisonResult::Descending) {
+        matches.push_back(&document);
+      }
+    }
+  }
+
+  // Documents are returned in read time order, so that the results can be
+  // paged through with the offset of the last document.
+  limit = std::min(limit, matches.size());
+  std::partial_sort(
+      matches.begin(), matches.begin() + limit, matches.end(),
+      [](const MutableDocument* lhs, const MutableDocument* rhs) {
+        return model::IndexOffset::DocumentCompare(*lhs, *rhs) ==
+               util::ComparisonResult::Ascending;
+      });
+
+  MutableDocumentMap results;
+  for (size_t i = 0; i < limit; ++i) {
+    // Note: We create an explicit copy to prevent modifications on the backing
+    // data.
+    results = results.insert(matches[i]->key(), matches[i]->Clone());
+  }
+  return results;
+}
+
+MutableDocumentMap MemoryRemoteDocumentCache::GetDocumentsInCollection(
+    const model::ResourcePath& collection,
+    const absl::optional<DocumentKey>& start_after,
+    size_t limit) const {
+  MutableDocumentMap results;
+  const DocumentsByKey* documents = FindCollection(collection);
+  if (!documents) {
+    return results;
+  }
+
+  auto it = start_after.has_value() ? documents->lower_bound(*start_after)
+                                    : documents->begin();
+  for (; it != documents->end() && results.size() < limit; ++it) {
+    const DocumentKey& key = it->first;
+    if (start_after.has_value() && key == start_after.value()) {
+      // Exclude the start key itself.
+      continue;
+    }
+
+    // Note: We create an explicit copy to prevent modifications on the backing
+    // data.
+    results = results.insert(key, it->second.Clone());
+  }
+
+  return results;
 }
 
 MutableDocumentMap MemoryRemoteDocumentCache::GetDocumentsMatchingQuery(
@@ -102,21 +186,15 @@ MutableDocumentMap MemoryRemoteDocumentCache::GetDocumentsMatchingQuery(
     const model::OverlayByDocumentKeyMap& mutated_docs) const {
   MutableDocumentMap results;
 
-  // Documents are ordered by key, so we can use a prefix scan to narrow down
-  // the documents we need to match the query against.
-  auto path = query.path();
-  DocumentKey prefix{path.Append("")};
-  size_t immediate_children_path_length = path.size() + 1;
-  for (auto it = docs_.lower_bound(prefix); it != docs_.end(); ++it) {
-    const DocumentKey& key = it->first;
-    if (!path.IsPrefixOf(key.path())) {
-      break;
-    }
-    const MutableDocument& document = it->second;
-    if (key.path().size() > immediate_children_path_length) {
-      // Exclude entries from subcollections.
-      continue;
-    }
+  // Only the documents in the query's collection can match the query.
+  // Documents in its subcollections are stored separately.
+  const DocumentsByKey* documents = FindCollection(query.path());
+  if (!documents) {
+    return results;
+  }
+  for (const auto& kv : *documents) {
+    const DocumentKey& key = kv.first;
+    const MutableDocument& document = kv.second;
 
     if (model::IndexOffset::FromDocument(document).CompareTo(offset) !=
         util::ComparisonResult::Descending) {
@@ -140,25 +218,68 @@ std::vector<DocumentKey> MemoryRemoteDocumentCache::RemoveOrphanedDocuments(
     MemoryLruReferenceDelegate* reference_delegate,
     ListenSequenceNumber upper_bound) {
   std::vector<DocumentKey> removed;
-  auto updated_docs = docs_;
-  for (const auto& kv : docs_) {
-    const DocumentKey& key = kv.first;
-    if (!reference_delegate->IsPinnedAtSequenceNumber(upper_bound, key)) {
-      updated_docs = updated_docs.erase(key);
-      removed.push_back(key);
+  for (auto it = collections_.begin(); it != collections_.end();) {
+    DocumentsByKey updated_docs = it->second;
+    for (const auto& kv : it->second) {
+      const DocumentKey& key = kv.first;
+      if (!reference_delegate->IsPinnedAtSequenceNumber(upper_bound, key)) {
+        if (sizer_) {
+          byte_size_ -= sizer_->CalculateByteSize(kv.second);
+        }
+        updated_docs = updated_docs.erase(key);
+        RemoveIndexEntries(key);
+        removed.push_back(key);
+      }
+    }
+
+    if (updated_docs.empty()) {
+      it = collections_.erase(it);
+    } else {
+      it->second = std::move(updated_docs);
+      ++it;
     }
   }
-  docs_ = updated_docs;
   return removed;
 }
 
 int64_t MemoryRemoteDocumentCache::CalculateByteSize(const Sizer& sizer) {
-  int64_t count = 0;
-  for (const auto& kv : docs_) {
-    const MutableDocument& document = kv.second;
-    count += sizer.CalculateByteSize(document);
+  if (!sizer_) {
+    for (const auto& collection : collections_) {
+      for (const auto& kv : collection.second) {
+        const MutableDocument& document = kv.second;
+        byte_size_ += sizer.CalculateByteSize(document);
+      }
+    }
+    sizer_ = &sizer;
+  }
+  HARD_ASSERT(sizer_ == &sizer, "Byte size was tracked with another sizer");
+  return byte_size_;
+}
+
+void MemoryRemoteDocumentCache::SubtractByteSize(const DocumentKey& key) {
+  const DocumentsByKey* documents = FindCollection(key.path().PopLast());
+  if (!documents) {
+    return;
+  }
+  auto found = documents->find(key);
+  if (found != documents->end()) {
+    byte_size_ -= sizer_->CalculateByteSize(found->second);
+  }
+}
+
+const MemoryRemoteDocumentCache::DocumentsByKey*
+MemoryRemoteDocumentCache::FindCollection(
+    const ResourcePath& collection) const {
+  auto found = collections_.find(collection);
+  return found != collections_.end() ? &found->second : nullptr;
+}
+
+void MemoryRemoteDocumentCache::RemoveIndexEntries(const DocumentKey& key) {
+  if (index_manager_) {
+    // An invalid document has no fields and therefore no index entries.
+    index_manager_->UpdateIndexEntries(model::DocumentMap{}.insert(
+        key, MutableDocument::InvalidDocument(key)));
   }
-  return count;
 }
 
 void MemoryRemoteDocumentCache::SetIndexManager(IndexManager* manager) {
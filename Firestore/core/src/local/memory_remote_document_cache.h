@@ -17,6 +17,7 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_MEMORY_REMOTE_DOCUMENT_CACHE_H_
 #define FIRESTORE_CORE_SRC_LOCAL_MEMORY_REMOTE_DOCUMENT_CACHE_H_
 
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -28,6 +29,7 @@
 #include "Firestore/core/src/model/model_fwd.h"
 #include "Firestore/core/src/model/mutable_document.h"
 #include "Firestore/core/src/model/overlay.h"
+#include "Firestore/core/src/model/resource_path.h"
 #include "Firestore/core/src/model/types.h"
 
 namespace firebase {
@@ -50,9 +52,13 @@ class MemoryRemoteDocumentCache : public RemoteDocumentCache {
   model::MutableDocument Get(const model::DocumentKey& key) const override;
   model::MutableDocumentMap GetAll(
       const model::DocumentKeySet& keys) const override;
-  model::MutableDocumentMap GetAll(const std::string&,
-                                   const model::IndexOffset&,
-                                   size_t) const override;
+  model::MutableDocumentMap GetAll(const std::string& collection_group,
+                                   const model::IndexOffset& offset,
+                                   size_t limit) const override;
+  model::MutableDocumentMap GetDocumentsInCollection(
+      const model::ResourcePath& collection,
+      const absl::optional<model::DocumentKey>& start_after,
+      size_t limit) const override;
   model::MutableDocumentMap GetDocumentsMatchingQuery(
       const core::Query& query,
       const model::IndexOffset& offset,
@@ -71,16 +77,48 @@ class MemoryRemoteDocumentCache : public RemoteDocumentCache {
       MemoryLruReferenceDelegate* reference_delegate,
       model::ListenSequenceNumber upper_bound);
 
+  /**
+   * Returns the total size of the documents in this cache according to `sizer`.
+   *
+   * The first call sums over the whole cache; from then on the total is kept
+   * up to date as entries are added and removed, so later calls (which must
+   * pass the same `sizer`) are O(1).
+   */
   int64_t CalculateByteSize(const Sizer& sizer);
 
  private:
-  /** Underlying cache of documents and their read times. */
-  immutable::SortedMap<model::DocumentKey, model::MutableDocument> docs_;
+  using DocumentsByKey =
+      immutable::SortedMap<model::DocumentKey, model::MutableDocument>;
+
+  /** Subtracts the size of the document stored for `key`, if any. */
+  void SubtractByteSize(const model::DocumentKey& key);
+
+  /** Drops the field index entries of a document that left the cache. */
+  void RemoveIndexEntries(const model::DocumentKey& key);
+
+  /**
+   * Returns the documents stored for `collection`, or `nullptr` if the cache
+   * holds none.
+   */
+  const DocumentsByKey* FindCollection(
+      const model::ResourcePath& collection) const;
+
+  /**
+   * Underlying cache of documents and their read times, keyed by the path of
+   * the collection that contains them. Scanning a collection therefore never
+   * visits documents in its subcollections. Collection groups are resolved
+   * through the collection parent index of the IndexManager.
+   */
+  std::map<model::ResourcePath, DocumentsByKey> collections_;
 
   // This instance is owned by MemoryPersistence; avoid a retain cycle.
   MemoryPersistence* persistence_;
   // This instance is also owned by MemoryPersistence.
   IndexManager* index_manager_ = nullptr;
+
+  /** The sizer `byte_size_` is tracked with, once one has been supplied. */
+  const Sizer* sizer_ = nullptr;
+  int64_t byte_size_ = 0;
 };
 
 }  // namespace local
@@ -44,6 +44,13 @@ MemoryTargetCache::MemoryTargetCache(MemoryPersistence* persistence)
 }
 
 void MemoryTargetCache::AddTarget(const TargetData& target_data) {
+  if (sizer_) {
+    auto found = targets_.find(target_data.target());
+    if (found != targets_.end()) {
+      byte_size_ -= sizer_->CalculateByteSize(found->second);
+    }
+    byte_size_ += sizer_->CalculateByteSize(target_data);
+  }
   targets_[target_data.target()] = target_data;
   if (target_data.target_id() > highest_target_id_) {
     highest_target_id_ = target_data.target_id();
@@ -59,7 +66,13 @@ void MemoryTargetCache::UpdateTarget(const TargetData& target_data) {
 }
 
 void MemoryTargetCache::RemoveTarget(const TargetData& target_data) {
-  targets_.erase(target_data.target());
+  auto found = targets_.find(target_data.target());
+  if (found != targets_.end()) {
+    if (sizer_) {
+      byte_size_ -= sizer_->CalculateByteSize(found->second);
+    }
+    targets_.erase(found);
+  }
   references_.RemoveReferences(target_data.target_id());
 }
 
@@ -87,6 +100,9 @@ size_t MemoryTargetCache::RemoveTargets(
       if (live_targets.find(target_data.target_id()) == live_targets.end()) {
         to_remove.push_back(&target);
         references_.RemoveReferences(target_data.target_id());
+        if (sizer_) {
+          byte_size_ -= sizer_->CalculateByteSize(target_data);
+        }
       }
     }
   }
@@ -122,11 +138,14 @@ bool MemoryTargetCache::Contains(const DocumentKey& key) {
 }
 
 int64_t MemoryTargetCache::CalculateByteSize(const Sizer& sizer) {
-  int64_t count = 0;
-  for (const auto& kv : targets_) {
-    count += sizer.CalculateByteSize(kv.second);
+  if (!sizer_) {
+    for (const auto& kv : targets_) {
+      byte_size_ += sizer.CalculateByteSize(kv.second);
+    }
+    sizer_ = &sizer;
   }
-  return count;
+  HARD_ASSERT(sizer_ == &sizer, "Byte size was tracked with another sizer");
+  return byte_size_;
 }
 
 const SnapshotVersion& MemoryTargetCache::GetLastRemoteSnapshotVersion() const {
@@ -70,6 +70,13 @@ class MemoryTargetCache : public TargetCache {
   bool Contains(const model::DocumentKey& key) override;
 
   // Other methods and accessors
+  /**
+   * Returns the total size of the targets in this cache according to `sizer`.
+   *
+   * The first call sums over the whole cache; from then on the total is kept
+   * up to date as entries are added and removed, so later calls (which must
+   * pass the same `sizer`) are O(1).
+   */
   int64_t CalculateByteSize(const Sizer& sizer);
 
   size_t size() const override {
@@ -107,6 +114,10 @@ class MemoryTargetCache : public TargetCache {
    * IDs.
    */
   ReferenceSet references_;
+
+  /** The sizer `byte_size_` is tracked with, once one has been supplied. */
+  const Sizer* sizer_ = nullptr;
+  int64_t byte_size_ = 0;
 };
 
 }  // namespace local
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/overlay_collection_summary.h"
+
+#include "Firestore/core/src/model/document_key.h"
+#include "Firestore/core/src/util/hard_assert.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+using model::DocumentKey;
+
+void OverlayCollectionSummary::Add(const DocumentKey& key) {
+  ++counts_[key.path().PopLast()];
+}
+
+void OverlayCollectionSummary::Remove(const DocumentKey& key) {
+  auto it = counts_.find(key.path().PopLast());
+  HARD_ASSERT(it != counts_.end() && it->second > 0,
+              "Removing an overlay that was never recorded: %s",
+              key.ToString());
+  if (--it->second == 0) {
+    counts_.erase(it);
+  }
+}
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
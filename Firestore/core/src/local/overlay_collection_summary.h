@@ -0,0 +1,70 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_LOCAL_OVERLAY_COLLECTION_SUMMARY_H_
+#define FIRESTORE_CORE_SRC_LOCAL_OVERLAY_COLLECTION_SUMMARY_H_
+
+#include <cstddef>
+#include <map>
+
+#include "Firestore/core/src/model/model_fwd.h"
+#include "Firestore/core/src/model/resource_path.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+/**
+ * An in-memory count of the overlays stored for each collection.
+ *
+ * Document overlay caches keep one of these up to date as overlays are saved
+ * and removed so that readers can tell, without touching persistence, that a
+ * collection has no pending writes.
+ */
+class OverlayCollectionSummary {
+ public:
+  /** Records a new overlay for the document with the given key. */
+  void Add(const model::DocumentKey& key);
+
+  /** Records the removal of the overlay for the document with the given key. */
+  void Remove(const model::DocumentKey& key);
+
+  /**
+   * Returns whether any overlay is recorded for a document that is an
+   * immediate child of the given collection.
+   */
+  bool Contains(const model::ResourcePath& collection) const {
+    return counts_.find(collection) != counts_.end();
+  }
+
+  /** Returns whether no overlays are recorded at all. */
+  bool empty() const {
+    return counts_.empty();
+  }
+
+  void Clear() {
+    counts_.clear();
+  }
+
+ private:
+  std::map<model::ResourcePath, size_t> counts_;
+};
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_LOCAL_OVERLAY_COLLECTION_SUMMARY_H_
@@ -0,0 +1,324 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/query_cursor.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "Firestore/core/src/local/index_manager.h"
+#include "Firestore/core/src/local/local_documents_view.h"
+#include "Firestore/core/src/local/query_engine.h"
+#include "Firestore/core/src/model/document_set.h"
+#include "Firestore/core/src/model/server_timestamp_util.h"
+#include "Firestore/core/src/model/value_util.h"
+#include "Firestore/core/src/nanopb/message.h"
+#include "Firestore/core/src/nanopb/nanopb_util.h"
+#include "Firestore/core/src/util/hard_assert.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+using core::Bound;
+using core::OrderBy;
+using core::Query;
+using model::DatabaseId;
+using model::Document;
+using model::DocumentComparator;
+using model::DocumentKey;
+using model::DocumentMap;
+using model::ResourcePath;
+using nanopb::CheckedSize;
+using nanopb::MakeArray;
+using nanopb::SharedMessage;
+using util::ComparisonResult;
+
+namespace {
+
+bool IsOrderedByKey(const Query& query) {
+  const std::vector<OrderBy>& order_bys = query.normalized_order_bys();
+  return order_bys.size() == 1 && order_bys[0].field().IsKeyFieldPath() &&
+         order_bys[0].ascending();
+}
+
+/**
+ * Keeps the first `capacity` documents offered to it, according to the given
+ * comparator, as a max-heap.
+ */
+class BoundedSelection {
+ public:
+  BoundedSelection(DocumentComparator comparator, size_t capacity)
+      : comparator_{std::move(comparator)}, capacity_{capacity} {
+  }
+
+  void Offer(const Document& document) {
+    if (documents_.size() < capacity_) {
+      documents_.push_back(document);
+      std::push_heap(documents_.begin(), documents_.end(), Less());
+    } else if (capacity_ > 0 && Less()(document, documents_.front())) {
+      std::pop_heap(documents_.begin(), documents_.end(), Less());
+      documents_.back() = document;
+      std::push_heap(documents_.begin(), documents_.end(), Less());
+    }
+  }
+
+  /** Returns the selected documents in ascending order. */
+  std::vector<Document> Release() && {
+    std::sort_heap(documents_.begin(), documents_.end(), Less());
+    return std::move(documents_);
+  }
+
+ private:
+  std::function<bool(const Document&, const Document&)> Less() const {
+    return [this](const Document& lhs, const Document& rhs) {
+      return comparator_.Compare(lhs, rhs) == ComparisonResult::Ascending;
+    };
+  }
+
+  DocumentComparator comparator_;
+  size_t capacity_ = 0;
+  std::vector<Document> documents_;
+};
+
+}  // namespace
+
+QueryCursor::QueryCursor(Query query, DatabaseId database_id, size_t page_size)
+    : query_{std::move(query)},
+      database_id_{std::move(database_id)},
+      page_size_{page_size},
+      key_ordered_{!query_.IsCollectionGroupQuery() &&
+                   !query_.has_limit_to_last() && IsOrderedByKey(query_)},
+      use_index_{!key_ordered_ && !query_.has_limit_to_last()} {
+  HARD_ASSERT(page_size_ > 0, "Page size must be at least 1");
+}
+
+std::vector<Document> QueryCursor::NextPage(LocalDocumentsView* local_documents,
+                                            const QueryEngine* query_engine) {
+  if (exhausted_) return {};
+
+  if (query_.IsDocumentQuery()) {
+    exhausted_ = true;
+    Document document =
+        local_documents->GetDocument(DocumentKey{query_.path()});
+    if (document->is_found_document() && query_.Matches(document)) {
+      return {document};
+    }
+    return {};
+  }
+
+  size_t page_size = page_size_;
+  if (query_.has_limit_to_first()) {
+    size_t limit = static_cast<size_t>(query_.limit());
+    page_size = std::min(page_size, limit - returned_count_);
+  }
+
+  std::vector<Document> page;
+  if (key_ordered_) {
+    page = NextPageInKeyOrder(local_documents, page_size);
+  } else {
+    absl::optional<std::vector<Document>> indexed_page;
+    if (use_index_) {
+      indexed_page = NextPageUsingIndex(query_engine, page_size);
+      use_index_ = indexed_page.has_value();
+    }
+    if (indexed_page.has_value()) {
+      page = std::move(indexed_page).value();
+    } else if (query_.has_limit_to_last()) {
+      page = NextBufferedPage(local_documents, page_size);
+    } else {
+      page = NextSelectedPage(local_documents, page_size);
+    }
+  }
+
+  returned_count_ += page.size();
+  if (!page.empty()) {
+    last_document_ = page.back();
+  }
+  if (page.size() < page_size_ ||
+      (buffered_results_.has_value() && buffered_results_->empty())) {
+    exhausted_ = true;
+  }
+  return page;
+}
+
+std::vector<Document> QueryCursor::NextPageInKeyOrder(
+    LocalDocumentsView* local_documents, size_t page_size) {
+  std::vector<Document> page;
+  if (page_size == 0) return page;
+
+  absl::optional<DocumentKey> start_after;
+  if (last_document_.has_value()) {
+    start_after = (*last_document_)->key();
+  }
+
+  ScanCollection(local_documents, query_.path(), start_after,
+                 [&](const Document& document) {
+                   page.push_back(document);
+                   return page.size() < page_size;
+                 });
+  return page;
+}
+
+absl::optional<std::vector<Document>> QueryCursor::NextPageUsingIndex(
+    const QueryEngine* query_engine, size_t page_size) {
+  if (page_size == 0) return std::vector<Document>{};
+
+  // The index is read from the position of the last document returned,
+  // skipping the entries up to and including the one of that document.
+  Query page_query = query_;
+  absl::optional<DocumentKey> start_after;
+  if (last_document_.has_value()) {
+    absl::optional<Bound> bound = BoundAtLastDocument();
+    if (!bound.has_value()) return absl::nullopt;
+    page_query = page_query.StartingAt(std::move(bound).value());
+    start_after = (*last_document_)->key();
+  }
+
+  absl::optional<DocumentMap> documents =
+      query_engine->GetDocumentsMatchingQueryUsingFullIndex(
+          page_query, start_after, page_size);
+  if (!documents.has_value()) return absl::nullopt;
+
+  DocumentComparator comparator = query_.Comparator();
+  BoundedSelection selection(comparator, page_size);
+  for (const auto& entry : documents.value()) {
+    const Document& document = entry.second;
+    if (document->is_found_document() && query_.Matches(document) &&
+        IsAfterLastDocument(comparator, document)) {
+      selection.Offer(document);
+    }
+  }
+  return std::move(selection).Release();
+}
+
+std::vector<Document> QueryCursor::NextSelectedPage(
+    LocalDocumentsView* local_documents, size_t page_size) {
+  if (page_size == 0) return {};
+
+  DocumentComparator comparator = query_.Comparator();
+  BoundedSelection selection(comparator, page_size);
+  for (const ResourcePath& collection : GetCollections(local_documents)) {
+    ScanCollection(local_documents, collection, absl::nullopt,
+                   [&](const Document& document) {
+                     if (IsAfterLastDocument(comparator, document)) {
+                       selection.Offer(document);
+                     }
+                     return true;
+                   });
+  }
+  return std::move(selection).Release();
+}
+
+std::vector<Document> QueryCursor::NextBufferedPage(
+    LocalDocumentsView* local_documents, size_t page_size) {
+  if (!buffered_results_.has_value()) {
+    buffered_results_ = SelectLastResults(local_documents);
+  }
+
+  std::deque<Document>& results = buffered_results_.value();
+  page_size = std::min(page_size, results.size());
+  std::vector<Document> page(results.begin(), results.begin() + page_size);
+  results.erase(results.begin(), results.begin() + page_size);
+  return page;
+}
+
+std::deque<Document> QueryCursor::SelectLastResults(
+    LocalDocumentsView* local_documents) const {
+  // Select the last `limit` documents by keeping the first ones in reverse
+  // order.
+  DocumentComparator comparator = query_.Comparator();
+  DocumentComparator reversed(
+      [comparator](const Document& lhs, const Document& rhs) {
+        return comparator.Compare(rhs, lhs);
+      });
+  BoundedSelection selection(reversed, static_cast<size_t>(query_.limit()));
+  for (const ResourcePath& collection : GetCollections(local_documents)) {
+    ScanCollection(local_documents, collection, absl::nullopt,
+                   [&](const Document& document) {
+                     selection.Offer(document);
+                     return true;
+                   });
+  }
+
+  std::vector<Document> results = std::move(selection).Release();
+  return std::deque<Document>(results.rbegin(), results.rend());
+}
+
+bool QueryCursor::IsAfterLastDocument(const DocumentComparator& comparator,
+                                      const Document& document) const {
+  return !last_document_.has_value() ||
+         comparator.Compare(*last_document_, document) ==
+             ComparisonResult::Ascending;
+}
+
+absl::optional<Bound> QueryCursor::BoundAtLastDocument() const {
+  const Document& document = last_document_.value();
+  const std::vector<OrderBy>& order_bys = query_.normalized_order_bys();
+
+  SharedMessage<google_firestore_v1_ArrayValue> position{{}};
+  position->values_count = CheckedSize(order_bys.size());
+  position->values =
+      MakeArray<google_firestore_v1_Value>(position->values_count);
+
+  for (size_t i = 0; i < order_bys.size(); ++i) {
+    if (order_bys[i].field().IsKeyFieldPath()) {
+      position->values[i] =
+          *model::RefValue(database_id_, document->key()).release();
+      continue;
+    }
+
+    // Pending server timestamps have no value that the index could seek to.
+    absl::optional<google_firestore_v1_Value> value =
+        document->field(order_bys[i].field());
+    if (!value.has_value() || model::IsServerTimestamp(value.value())) {
+      return absl::nullopt;
+    }
+    position->values[i] = *model::DeepClone(value.value()).release();
+  }
+  return Bound::FromValue(std::move(position), /* inclusive= */ true);
+}
+
+std::vector<ResourcePath> QueryCursor::GetCollections(
+    LocalDocumentsView* local_documents) const {
+  if (!query_.IsCollectionGroupQuery()) {
+    return {query_.path()};
+  }
+
+  const std::string& collection_id = *query_.collection_group();
+  std::vector<ResourcePath> collections;
+  for (const ResourcePath& parent :
+       local_documents->index_manager()->GetCollectionParents(collection_id)) {
+    collections.push_back(parent.Append(collection_id));
+  }
+  return collections;
+}
+
+void QueryCursor::ScanCollection(LocalDocumentsView* local_documents,
+                                 const ResourcePath& collection,
+                                 absl::optional<DocumentKey> start_after,
+                                 const DocumentVisitor& visitor) const {
+  local_documents->ForEachDocumentInCollection(
+      collection, std::move(start_after), page_size_,
+      [&](const Document& document) {
+        return !query_.Matches(document) || visitor(document);
+      });
+}
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
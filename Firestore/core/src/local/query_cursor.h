@@ -0,0 +1,160 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_LOCAL_QUERY_CURSOR_H_
+#define FIRESTORE_CORE_SRC_LOCAL_QUERY_CURSOR_H_
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "Firestore/core/src/core/bound.h"
+#include "Firestore/core/src/core/query.h"
+#include "Firestore/core/src/model/database_id.h"
+#include "Firestore/core/src/model/document.h"
+#include "Firestore/core/src/model/document_key.h"
+#include "Firestore/core/src/model/model_fwd.h"
+#include "absl/types/optional.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+class LocalDocumentsView;
+class QueryEngine;
+
+/**
+ * A pull-based cursor over the local view of the documents that match a query.
+ *
+ * Documents are returned in query order, one page at a time:
+ *
+ * + Collection queries that are ordered by key (the default) are streamed:
+ *   each page resumes the scan of the remote documents at the last document
+ *   returned and only reads the overlays of the documents it covers.
+ * + Queries that can be served by a full field index read each page from the
+ *   index, starting after the entry of the last document returned.
+ * + Limit-to-last queries scan their collections once, on the first page, and
+ *   buffer the last `limit` documents.
+ * + All other queries scan their collections for each page and only retain
+ *   the first `page_size` documents after the last document returned.
+ *
+ * The cursor does not take a snapshot: documents that change between pages are
+ * returned as they are when their page is read, except for the buffered results
+ * of limit-to-last queries.
+ */
+class QueryCursor {
+ public:
+  QueryCursor(core::Query query,
+              model::DatabaseId database_id,
+              size_t page_size);
+
+  const core::Query& query() const {
+    return query_;
+  }
+
+  /** Returns true once all matching documents have been returned. */
+  bool exhausted() const {
+    return exhausted_;
+  }
+
+  /**
+   * Reads the next page of documents. Returns an empty page once the cursor is
+   * exhausted.
+   *
+   * Must be called within a persistence transaction.
+   */
+  std::vector<model::Document> NextPage(LocalDocumentsView* local_documents,
+                                        const QueryEngine* query_engine);
+
+ private:
+  /** Returns false to stop the scan. */
+  using DocumentVisitor = std::function<bool(const model::Document&)>;
+
+  std::vector<model::Document> NextPageInKeyOrder(
+      LocalDocumentsView* local_documents, size_t page_size);
+
+  /**
+   * Reads the next page from a full field index. Returns nullopt if the query
+   * cannot be served by a full index.
+   */
+  absl::optional<std::vector<model::Document>> NextPageUsingIndex(
+      const QueryEngine* query_engine, size_t page_size);
+
+  /**
+   * Selects the next page in a scan of the query's collections, keeping only
+   * `page_size` documents in memory.
+   */
+  std::vector<model::Document> NextSelectedPage(
+      LocalDocumentsView* local_documents, size_t page_size);
+
+  std::vector<model::Document> NextBufferedPage(
+      LocalDocumentsView* local_documents, size_t page_size);
+
+  /**
+   * Selects the results of a limit-to-last query in a single scan of its
+   * collections.
+   */
+  std::deque<model::Document> SelectLastResults(
+      LocalDocumentsView* local_documents) const;
+
+  /**
+   * Returns true if `document` sorts after the last document returned
+   * according to `comparator`, the query's comparator.
+   */
+  bool IsAfterLastDocument(const model::DocumentComparator& comparator,
+                           const model::Document& document) const;
+
+  /**
+   * Returns an inclusive bound at the position of the last document returned,
+   * or nullopt if the position cannot be expressed as a bound.
+   */
+  absl::optional<core::Bound> BoundAtLastDocument() const;
+
+  /** Returns the paths of all collections the query may return documents of. */
+  std::vector<model::ResourcePath> GetCollections(
+      LocalDocumentsView* local_documents) const;
+
+  /**
+   * Visits the local view of the documents in `collection` that match the
+   * query, in key order, starting after `start_after`. The remote documents
+   * are read in chunks of one page.
+   */
+  void ScanCollection(LocalDocumentsView* local_documents,
+                      const model::ResourcePath& collection,
+                      absl::optional<model::DocumentKey> start_after,
+                      const DocumentVisitor& visitor) const;
+
+  core::Query query_;
+  model::DatabaseId database_id_;
+  size_t page_size_ = 0;
+  bool key_ordered_ = false;
+
+  /** Cleared once the query engine reports that no full index can be used. */
+  bool use_index_ = false;
+
+  size_t returned_count_ = 0;
+  absl::optional<model::Document> last_document_;
+  bool exhausted_ = false;
+
+  /** The results of a limit-to-last query, once they have been selected. */
+  absl::optional<std::deque<model::Document>> buffered_results_;
+};
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_LOCAL_QUERY_CURSOR_H_
@@ -16,16 +16,24 @@
 
 #include "Firestore/core/src/local/query_engine.h"
 
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/core/query.h"
 #include "Firestore/core/src/core/target.h"
+#include "Firestore/core/src/local/aggregate_accumulator.h"
+#include "Firestore/core/src/local/document_overlay_cache.h"
 #include "Firestore/core/src/local/local_documents_view.h"
 #include "Firestore/core/src/local/query_context.h"
 #include "Firestore/core/src/model/document.h"
 #include "Firestore/core/src/model/document_set.h"
 #include "Firestore/core/src/model/mutable_document.h"
+#include "Firestore/core/src/model/object_value.h"
+#include "Firestore/core/src/model/resource_path.h"
 #include "Firestore/core/src/model/snapshot_version.h"
+#include "Firestore/core/src/util/comparison.h"
+#include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/log.h"
 
 namespace firebase {
@@ -44,15 +52,25 @@ static const int kDefaultIndexAutoCreationMinCollectionSize = 100;
  */
 
 static const double KDefaultRelativeIndexReadCostPerDocument = 3.4;
+
+/**
+ * The number of remote documents that are read at a time when aggregating over
+ * a collection.
+ */
+static const size_t kAggregationChunkSize = 100;
 }  // namespace
 
 using core::LimitType;
 using core::Query;
+using model::AggregateField;
 using model::Document;
+using model::DocumentKey;
 using model::DocumentKeySet;
 using model::DocumentMap;
 using model::DocumentSet;
 using model::MutableDocument;
+using model::ObjectValue;
+using model::ResourcePath;
 using model::SnapshotVersion;
 
 void QueryEngine::Initialize(LocalDocumentsView* local_documents) {
@@ -91,6 +109,141 @@ const DocumentMap QueryEngine::GetDocumentsMatchingQuery(
   return full_scan_result;
 }
 
+absl::optional<DocumentMap>
+QueryEngine::GetDocumentsMatchingQueryUsingFullIndex(
+    const Query& query,
+    const absl::optional<DocumentKey>& start_after,
+    size_t page_size) const {
+  HARD_ASSERT(local_documents_view_ && index_manager_,
+              "Initialize() not called");
+
+  if (query.MatchesAllDocuments() ||
+      index_manager_->GetIndexType(query.ToTarget()) !=
+          IndexManager::IndexType::FULL) {
+    return absl::nullopt;
+  }
+
+  // The entries of documents that changed since they were indexed may not
+  // reflect their position anymore. Each index range is read until it holds
+  // `page_size` entries besides the ones of changed documents, so that the
+  // documents that sort first after `start_after` are all included. Changed
+  // documents are read separately below.
+  model::IndexOffset offset = index_manager_->GetMinOffset(query.ToTarget());
+  size_t limit = page_size;
+  DocumentMap documents;
+  while (true) {
+    Query page_query = query.WithLimitToFirst(static_cast<int32_t>(limit));
+    const core::Target& target = page_query.ToTarget();
+    auto keys =
+        start_after.has_value()
+            ? index_manager_->GetDocumentsMatchingTarget(target, *start_after)
+            : index_manager_->GetDocumentsMatchingTarget(target);
+    HARD_ASSERT(keys.has_value(),
+                "index manager must return results for full indexes.");
+
+    DocumentKeySet remote_keys;
+    for (const DocumentKey& key : keys.value()) {
+      remote_keys = remote_keys.insert(key);
+    }
+    documents = local_documents_view_->GetDocuments(remote_keys);
+
+    size_t changed_count = 0;
+    for (const auto& entry : documents) {
+      const Document& document = entry.second;
+      if (!document->is_found_document() ||
+          document->has_local_mutations() ||
+          model::IndexOffset::FromDocument(document).CompareTo(offset) ==
+              util::ComparisonResult::Descending) {
+        ++changed_count;
+      }
+    }
+    if (keys->size() < limit || limit - page_size >= changed_count) break;
+    limit = page_size + changed_count;
+  }
+
+  for (const auto& entry :
+       local_documents_view_->GetDocumentsMatchingQuery(query, offset)) {
+    documents = documents.insert(entry.first, entry.second);
+  }
+  return documents;
+}
+
+ObjectValue QueryEngine::ComputeAggregates(
+    const Query& query, const std::vector<AggregateField>& aggregates) const {
+  HARD_ASSERT(local_documents_view_ && index_manager_,
+              "Initialize() not called");
+  AggregateAccumulator accumulator(aggregates);
+
+  if (query.IsDocumentQuery()) {
+    Document document =
+        local_documents_view_->GetDocument(DocumentKey{query.path()});
+    if (document->is_found_document() && query.Matches(document)) {
+      accumulator.Add(document);
+    }
+    return accumulator.Result();
+  }
+
+  if (accumulator.counts_only()) {
+    absl::optional<int64_t> count = CountUsingIndex(query);
+    if (count.has_value()) {
+      LOG_DEBUG("Using index entries to count the results of query: %s",
+                query.ToString());
+      accumulator.AddCount(count.value());
+      return accumulator.Result();
+    }
+  }
+
+  std::vector<ResourcePath> collections;
+  if (query.IsCollectionGroupQuery()) {
+    const std::string& collection_id = *query.collection_group();
+    for (const ResourcePath& parent :
+         index_manager_->GetCollectionParents(collection_id)) {
+      collections.push_back(parent.Append(collection_id));
+    }
+  } else {
+    collections.push_back(query.path());
+  }
+
+  if (!query.has_limit()) {
+    for (const ResourcePath& collection : collections) {
+      local_documents_view_->ForEachDocumentInCollection(
+          collection, absl::nullopt, kAggregationChunkSize,
+          [&](const Document& document) {
+            if (query.Matches(document)) {
+              accumulator.Add(document);
+            }
+            return true;
+          });
+    }
+    return accumulator.Result();
+  }
+
+  // The limit can only be applied in query order, so the documents within the
+  // limit are retained until the scan completes.
+  DocumentSet results(query.Comparator());
+  size_t limit = static_cast<size_t>(query.limit());
+  for (const ResourcePath& collection : collections) {
+    local_documents_view_->ForEachDocumentInCollection(
+        collection, absl::nullopt, kAggregationChunkSize,
+        [&](const Document& document) {
+          if (!query.Matches(document)) return true;
+          results = results.insert(document);
+          if (results.size() > limit) {
+            absl::optional<Document> excluded =
+                query.limit_type() == LimitType::First
+                    ? results.GetLastDocument()
+                    : results.GetFirstDocument();
+            results = results.erase((*excluded)->key());
+          }
+          return true;
+        });
+  }
+  for (const Document& document : results) {
+    accumulator.Add(document);
+  }
+  return accumulator.Result();
+}
+
 void QueryEngine::CreateCacheIndexes(const core::Query& query,
                                      const QueryContext& context,
                                      size_t result_size) const {
@@ -183,6 +336,53 @@ absl::optional<DocumentMap> QueryEngine::PerformQueryUsingIndex(
   return AppendRemainingResults(previous_results, query, offset);
 }
 
+absl::optional<int64_t> QueryEngine::CountUsingIndex(
+    const Query& query) const {
+  if (query.MatchesAllDocuments() || query.has_limit()) {
+    return absl::nullopt;
+  }
+
+  const core::Target& target = query.ToTarget();
+  if (index_manager_->GetIndexType(target) != IndexManager::IndexType::FULL) {
+    return absl::nullopt;
+  }
+
+  // The index entries only reflect the remote documents up to the index's
+  // offset. Both checks below look at the whole collection group, which is a
+  // superset of the query's collection.
+  const std::string collection_group = query.IsCollectionGroupQuery()
+                                           ? *query.collection_group()
+                                           : query.path().last_segment();
+  model::IndexOffset offset = index_manager_->GetMinOffset(target);
+  if (!local_documents_view_->remote_document_cache()
+           ->GetAll(collection_group, offset, 1)
+           .empty()) {
+    return absl::nullopt;
+  }
+  if (!local_documents_view_->document_overlay_cache()
+           ->GetOverlays(collection_group, -1, 1)
+           .empty()) {
+    return absl::nullopt;
+  }
+
+  auto keys = index_manager_->GetDocumentsMatchingTarget(target);
+  HARD_ASSERT(keys.has_value(),
+              "index manager must return results for full indexes.");
+
+  // Index entries cover the whole collection group, so documents in other
+  // collections with the same ID are skipped. Disjunctions may return the same
+  // document for several index entries.
+  DocumentKeySet unique_keys;
+  for (const model::DocumentKey& key : keys.value()) {
+    if (!query.IsCollectionGroupQuery() &&
+        !query.path().IsImmediateParentOf(key.path())) {
+      continue;
+    }
+    unique_keys = unique_keys.insert(key);
+  }
+  return static_cast<int64_t>(unique_keys.size());
+}
+
 absl::optional<DocumentMap> QueryEngine::PerformQueryUsingRemoteKeys(
     const Query& query,
     const DocumentKeySet& remote_keys,
@@ -17,6 +17,10 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_QUERY_ENGINE_H_
 #define FIRESTORE_CORE_SRC_LOCAL_QUERY_ENGINE_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 #include "Firestore/core/src/model/model_fwd.h"
 
 namespace firebase {
@@ -27,6 +31,10 @@ class Query;
 enum class LimitType;
 }  // namespace core
 
+namespace model {
+class AggregateField;
+}  // namespace model
+
 namespace local {
 
 class LocalDocumentsView;
@@ -79,6 +87,37 @@ class QueryEngine {
       const model::SnapshotVersion& last_limbo_free_snapshot_version,
       const model::DocumentKeySet& remote_keys) const;
 
+  /**
+   * Returns the documents that may make up the next page of the results of
+   * `query` if the query can be served entirely from a field index, or nullopt
+   * otherwise.
+   *
+   * If `start_after` is set, `query` must start at the inclusive position of
+   * that document and the index is only read after its entry. The first
+   * `page_size` documents that match the query after `start_after` are
+   * included. As with `GetDocumentsMatchingQuery()`, the result can contain
+   * other documents, including ones that do not match the query.
+   */
+  absl::optional<model::DocumentMap> GetDocumentsMatchingQueryUsingFullIndex(
+      const core::Query& query,
+      const absl::optional<model::DocumentKey>& start_after,
+      size_t page_size) const;
+
+  /**
+   * Computes the given aggregations over the local view of the documents that
+   * match the query.
+   *
+   * The query's collections are scanned in chunks and each matching document
+   * is folded into the aggregations as it is read, so the documents are not
+   * collected first. Queries with a limit retain the `limit` documents that
+   * sort first (or last) until the scan completes. If all aggregations are
+   * counts and the query can be served by a full index that is up to date,
+   * the count is taken from the index entries without reading any documents.
+   */
+  model::ObjectValue ComputeAggregates(
+      const core::Query& query,
+      const std::vector<model::AggregateField>& aggregates) const;
+
   void SetIndexAutoCreationEnabled(bool is_enabled);
 
  private:
@@ -101,6 +140,14 @@ class QueryEngine {
       const model::DocumentKeySet& remote_keys,
       const model::SnapshotVersion& last_limbo_free_snapshot_version) const;
 
+  /**
+   * Counts the documents matching the query using only the index entries of a
+   * full index. Returns nullopt if the index may not reflect the local view of
+   * the collection, i.e. if there are pending local mutations or documents that
+   * have not been indexed yet.
+   */
+  absl::optional<int64_t> CountUsingIndex(const core::Query& query) const;
+
   /** Applies the query filter and sorting to the provided documents. */
   model::DocumentSet ApplyQuery(const core::Query& query,
                                 const model::DocumentMap& documents) const;
@@ -95,6 +95,26 @@ class RemoteDocumentCache {
                                            const model::IndexOffset& offset,
                                            size_t limit) const = 0;
 
+  /**
+   * Looks up the next "limit" entries of a single collection in document key
+   * order, starting after `start_after`. Documents in subcollections are not
+   * included.
+   *
+   * Unlike the scans above, this includes cached NoDocument and
+   * UnknownDocument entries, so that the caller can resume the scan from the
+   * last key returned.
+   *
+   * @param collection The path of the collection to scan.
+   * @param start_after The key to start the scan after, or nullopt to start at
+   * the beginning of the collection.
+   * @param limit The maximum number of results to return.
+   * @return A newly created map with the next entries of the collection.
+   */
+  virtual model::MutableDocumentMap GetDocumentsInCollection(
+      const model::ResourcePath& collection,
+      const absl::optional<model::DocumentKey>& start_after,
+      size_t limit) const = 0;
+
   /**
    * Executes a query against the cached Document entries
    *
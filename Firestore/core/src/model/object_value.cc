@@ -199,8 +199,21 @@ ObjectValue::ObjectValue(Message<google_firestore_v1_Value> value)
   SortFields(*value_);
 }
 
+ObjectValue::ObjectValue(ObjectValue&& other) noexcept
+    : value_(std::move(other.value_)),
+      fingerprint_(other.fingerprint_.load(std::memory_order_relaxed)) {
+}
+
+ObjectValue& ObjectValue::operator=(ObjectValue&& other) noexcept {
+  value_ = std::move(other.value_);
+  fingerprint_.store(other.fingerprint_.load(std::memory_order_relaxed),
+                     std::memory_order_relaxed);
+  return *this;
+}
+
 ObjectValue::ObjectValue(const ObjectValue& other)
-    : value_(DeepClone(*other.value_)) {
+    : value_(DeepClone(*other.value_)),
+      fingerprint_(other.fingerprint_.load(std::memory_order_relaxed)) {
 }
 
 ObjectValue ObjectValue::FromMapValue(
@@ -320,6 +333,7 @@ google_firestore_v1_Value ObjectValue::Get() const {
 void ObjectValue::Set(const FieldPath& path,
                       Message<google_firestore_v1_Value> value) {
   HARD_ASSERT(!path.empty(), "Cannot set field for empty path on ObjectValue");
+  fingerprint_.store(kNoFingerprint, std::memory_order_relaxed);
 
   google_firestore_v1_MapValue* parent_map = ParentMap(path.PopLast());
 
@@ -330,6 +344,7 @@ void ObjectValue::Set(const FieldPath& path,
 }
 
 void ObjectValue::SetAll(TransformMap data) {
+  fingerprint_.store(kNoFingerprint, std::memory_order_relaxed);
   FieldPath parent;
 
   std::map<std::string, Message<google_firestore_v1_Value>> upserts;
@@ -362,6 +377,7 @@ void ObjectValue::SetAll(TransformMap data) {
 
 void ObjectValue::Delete(const FieldPath& path) {
   HARD_ASSERT(!path.empty(), "Cannot delete field with empty path");
+  fingerprint_.store(kNoFingerprint, std::memory_order_relaxed);
 
   google_firestore_v1_Value* nested_value = value_.get();
   for (const std::string& segment : path.PopLast()) {
@@ -386,6 +402,19 @@ size_t ObjectValue::Hash() const {
   return util::Hash(CanonicalId(*value_));
 }
 
+uint64_t ObjectValue::Fingerprint() const {
+  uint64_t fingerprint = fingerprint_.load(std::memory_order_relaxed);
+  if (fingerprint == kNoFingerprint) {
+    fingerprint = model::Fingerprint(*value_);
+    if (fingerprint == kNoFingerprint) {
+      // Reserve the sentinel; this only makes a collision slightly likelier.
+      fingerprint = kNoFingerprint + 1;
+    }
+    fingerprint_.store(fingerprint, std::memory_order_relaxed);
+  }
+  return fingerprint;
+}
+
 google_firestore_v1_MapValue* ObjectValue::ParentMap(const FieldPath& path) {
   google_firestore_v1_Value* parent = value_.get();
 
@@ -17,6 +17,8 @@
 #ifndef FIRESTORE_CORE_SRC_MODEL_OBJECT_VALUE_H_
 #define FIRESTORE_CORE_SRC_MODEL_OBJECT_VALUE_H_
 
+#include <atomic>
+#include <cstdint>
 #include <map>
 #include <ostream>
 #include <set>
@@ -47,8 +49,8 @@ class ObjectValue {
   /** Creates a new ObjectValue */
   explicit ObjectValue(nanopb::Message<google_firestore_v1_Value> value);
 
-  ObjectValue(ObjectValue&& other) noexcept = default;
-  ObjectValue& operator=(ObjectValue&& other) noexcept = default;
+  ObjectValue(ObjectValue&& other) noexcept;
+  ObjectValue& operator=(ObjectValue&& other) noexcept;
   ObjectValue(const ObjectValue& other);
 
   ObjectValue& operator=(const ObjectValue&) = delete;
@@ -138,6 +140,14 @@ class ObjectValue {
 
   size_t Hash() const;
 
+  /**
+   * Returns a 64-bit fingerprint of the contents of this object. Equal objects
+   * have equal fingerprints. The fingerprint is computed on first use and kept
+   * until the object is modified, so that repeated comparisons of the same
+   * objects can tell most differing objects apart in constant time.
+   */
+  uint64_t Fingerprint() const;
+
   friend bool operator==(const ObjectValue& lhs, const ObjectValue& rhs);
   friend std::ostream& operator<<(std::ostream& out,
                                   const ObjectValue& object_value);
@@ -152,10 +162,32 @@ class ObjectValue {
    */
   google_firestore_v1_MapValue* ParentMap(const FieldPath& path);
 
+  static constexpr uint64_t kNoFingerprint = 0;
+
   nanopb::Message<google_firestore_v1_Value> value_;
+
+  /**
+   * The cached result of `Fingerprint()`, or `kNoFingerprint` if it has not
+   * been computed since the last modification. Atomic because documents, and
+   * with them their data, are shared between threads.
+   */
+  mutable std::atomic<uint64_t> fingerprint_{kNoFingerprint};
 };
 
 inline bool operator==(const ObjectValue& lhs, const ObjectValue& rhs) {
+  if (&lhs == &rhs) {
+    return true;
+  }
+
+  // Only use fingerprints that are already known, so that one-off comparisons
+  // don't pay for computing them.
+  uint64_t lhs_fingerprint = lhs.fingerprint_.load(std::memory_order_relaxed);
+  uint64_t rhs_fingerprint = rhs.fingerprint_.load(std::memory_order_relaxed);
+  if (lhs_fingerprint != ObjectValue::kNoFingerprint &&
+      rhs_fingerprint != ObjectValue::kNoFingerprint &&
+      lhs_fingerprint != rhs_fingerprint) {
+    return false;
+  }
   return *lhs.value_ == *rhs.value_;
 }
 
@@ -30,6 +30,7 @@
 #include "Firestore/core/src/nanopb/nanopb_util.h"
 #include "Firestore/core/src/util/comparison.h"
 #include "Firestore/core/src/util/hard_assert.h"
+#include "absl/base/casts.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -54,6 +55,125 @@ const char* kRawMaxValueFieldValue = "__max__";
 pb_bytes_array_s* kMaxValueFieldValue =
     nanopb::MakeBytesArray(kRawMaxValueFieldValue);
 
+/** FNV-1a parameters, used to build value fingerprints. */
+constexpr uint64_t kFingerprintOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t kFingerprintPrime = 1099511628211ULL;
+
+uint64_t MixFingerprint(uint64_t fingerprint, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    fingerprint ^= (value >> (i * 8)) & 0xff;
+    fingerprint *= kFingerprintPrime;
+  }
+  return fingerprint;
+}
+
+uint64_t MixFingerprint(uint64_t fingerprint, absl::string_view bytes) {
+  // Mixing in the size keeps adjacent strings from running into each other.
+  fingerprint = MixFingerprint(fingerprint, bytes.size());
+  for (char c : bytes) {
+    fingerprint ^= static_cast<uint8_t>(c);
+    fingerprint *= kFingerprintPrime;
+  }
+  return fingerprint;
+}
+
+uint64_t MixFingerprint(uint64_t fingerprint, double value) {
+  // Like util::DoubleBitwiseEquals(), treat all NaNs as the same value.
+  if (std::isnan(value)) {
+    value = std::numeric_limits<double>::quiet_NaN();
+  }
+  return MixFingerprint(fingerprint, absl::bit_cast<uint64_t>(value));
+}
+
+uint64_t MixFingerprint(uint64_t fingerprint,
+                        const google_protobuf_Timestamp& timestamp) {
+  fingerprint =
+      MixFingerprint(fingerprint, static_cast<uint64_t>(timestamp.seconds));
+  return MixFingerprint(fingerprint, static_cast<uint64_t>(timestamp.nanos));
+}
+
+uint64_t MixFingerprint(uint64_t fingerprint,
+                        const google_firestore_v1_Value& value);
+
+uint64_t MixFingerprint(uint64_t fingerprint,
+                        const google_firestore_v1_MapValue& map_value) {
+  fingerprint = MixFingerprint(fingerprint, uint64_t{map_value.fields_count});
+  for (pb_size_t i = 0; i < map_value.fields_count; ++i) {
+    fingerprint = MixFingerprint(
+        fingerprint, nanopb::MakeStringView(map_value.fields[i].key));
+    fingerprint = MixFingerprint(fingerprint, map_value.fields[i].value);
+  }
+  return fingerprint;
+}
+
+/**
+ * Mixes `value` into `fingerprint`. Mirrors `Equals()`: values that are equal
+ * always mix in the same way.
+ */
+uint64_t MixFingerprint(uint64_t fingerprint,
+                        const google_firestore_v1_Value& value) {
+  TypeOrder type = GetTypeOrder(value);
+  fingerprint = MixFingerprint(fingerprint, static_cast<uint64_t>(type));
+  switch (type) {
+    case TypeOrder::kNull:
+      return fingerprint;
+
+    case TypeOrder::kBoolean:
+      return MixFingerprint(fingerprint, uint64_t{value.boolean_value});
+
+    case TypeOrder::kNumber:
+      // Integers and doubles are never equal to each other.
+      fingerprint =
+          MixFingerprint(fingerprint, uint64_t{value.which_value_type});
+      return value.which_value_type ==
+                     google_firestore_v1_Value_integer_value_tag
+                 ? MixFingerprint(fingerprint,
+                                  static_cast<uint64_t>(value.integer_value))
+                 : MixFingerprint(fingerprint, value.double_value);
+
+    case TypeOrder::kTimestamp:
+      return MixFingerprint(fingerprint, value.timestamp_value);
+
+    case TypeOrder::kServerTimestamp:
+      return MixFingerprint(fingerprint, GetLocalWriteTime(value));
+
+    case TypeOrder::kString:
+      return MixFingerprint(fingerprint,
+                            nanopb::MakeStringView(value.string_value));
+
+    case TypeOrder::kBlob:
+      return MixFingerprint(fingerprint,
+                            nanopb::MakeStringView(value.bytes_value));
+
+    case TypeOrder::kReference:
+      return MixFingerprint(fingerprint,
+                            nanopb::MakeStringView(value.reference_value));
+
+    case TypeOrder::kGeoPoint:
+      // Coordinates compare with `==`, so -0.0 must mix in like 0.0.
+      fingerprint =
+          MixFingerprint(fingerprint, value.geo_point_value.latitude + 0.0);
+      return MixFingerprint(fingerprint,
+                            value.geo_point_value.longitude + 0.0);
+
+    case TypeOrder::kArray: {
+      const google_firestore_v1_ArrayValue& array = value.array_value;
+      fingerprint = MixFingerprint(fingerprint, uint64_t{array.values_count});
+      for (pb_size_t i = 0; i < array.values_count; ++i) {
+        fingerprint = MixFingerprint(fingerprint, array.values[i]);
+      }
+      return fingerprint;
+    }
+
+    case TypeOrder::kMap:
+    case TypeOrder::kMaxValue:
+      return MixFingerprint(fingerprint, value.map_value);
+
+    default:
+      HARD_FAIL("Invalid type value: %s", type);
+  }
+}
+
 }  // namespace
 
 using nanopb::Message;
@@ -112,12 +232,17 @@ void SortFields(google_firestore_v1_ArrayValue& value) {
 void SortFields(google_firestore_v1_Value& value) {
   if (IsMap(value)) {
     google_firestore_v1_MapValue& map_value = value.map_value;
-    std::sort(map_value.fields, map_value.fields + map_value.fields_count,
-              [](const google_firestore_v1_MapValue_FieldsEntry& lhs,
-                 const google_firestore_v1_MapValue_FieldsEntry& rhs) {
-                return nanopb::MakeStringView(lhs.key) <
-                       nanopb::MakeStringView(rhs.key);
-              });
+    auto begin = map_value.fields;
+    auto end = map_value.fields + map_value.fields_count;
+    auto by_key = [](const google_firestore_v1_MapValue_FieldsEntry& lhs,
+                     const google_firestore_v1_MapValue_FieldsEntry& rhs) {
+      return nanopb::MakeStringView(lhs.key) < nanopb::MakeStringView(rhs.key);
+    };
+    // Maps written by the SDK and returned by the backend are already in key
+    // order, so verifying the order is usually all that is needed.
+    if (!std::is_sorted(begin, end, by_key)) {
+      std::sort(begin, end, by_key);
+    }
 
     for (pb_size_t i = 0; i < map_value.fields_count; ++i) {
       SortFields(map_value.fields[i].value);
@@ -549,6 +674,10 @@ std::string CanonicalId(const google_firestore_v1_ArrayValue& value) {
   return CanonifyArray(value);
 }
 
+uint64_t Fingerprint(const google_firestore_v1_Value& value) {
+  return MixFingerprint(kFingerprintOffsetBasis, value);
+}
+
 google_firestore_v1_Value GetLowerBound(pb_size_t value_tag) {
   switch (value_tag) {
     case google_firestore_v1_Value_null_value_tag:
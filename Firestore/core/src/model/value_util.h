@@ -59,7 +59,10 @@ enum class TypeOrder {
 /** Returns the backend's type order of the given Value type. */
 TypeOrder GetTypeOrder(const google_firestore_v1_Value& value);
 
-/** Traverses a Value proto and sorts all MapValues by key. */
+/**
+ * Traverses a Value proto and sorts all MapValues by key. Maps that are
+ * already sorted are only verified, in linear time.
+ */
 void SortFields(google_firestore_v1_Value& value);
 
 /** Traverses an ArrayValue proto and sorts all MapValues by key. */
@@ -110,6 +113,13 @@ google_firestore_v1_Value GetUpperBound(pb_size_t value_tag);
  */
 std::string CanonicalId(const google_firestore_v1_ArrayValue& value);
 
+/**
+ * Returns a 64-bit fingerprint of the provided field value. Values that are
+ * equal according to `Equals()` always have the same fingerprint, so values
+ * with different fingerprints are known to be different.
+ */
+uint64_t Fingerprint(const google_firestore_v1_Value& value);
+
 /** Returns true if the array value contains the specified element. */
 bool Contains(google_firestore_v1_ArrayValue haystack,
               google_firestore_v1_Value needle);
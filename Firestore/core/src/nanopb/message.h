@@ -299,6 +299,17 @@ std::string MakeStdString(const Message<T>& message) {
   return writer.Release();
 }
 
+/**
+ * Returns the number of bytes the given `message` occupies when serialized,
+ * without allocating a buffer for the serialized form.
+ */
+template <typename T>
+size_t EncodedSize(const Message<T>& message) {
+  SizingWriter writer;
+  writer.Write(message.fields(), message.get());
+  return writer.size();
+}
+
 /** Free the dynamically-allocated memory for the fields array of type T. */
 template <typename T>
 void FreeFieldsArray(T* message) {
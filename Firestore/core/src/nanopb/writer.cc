@@ -123,6 +123,13 @@ std::string StringWriter::Release() {
   return std::move(buffer_);
 }
 
+SizingWriter::SizingWriter() {
+  // A null callback makes Nanopb count bytes without writing them.
+  stream_.callback = nullptr;
+  stream_.state = nullptr;
+  stream_.max_size = SIZE_MAX;
+}
+
 }  // namespace nanopb
 }  // namespace firestore
 }  // namespace firebase
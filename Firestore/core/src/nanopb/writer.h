@@ -140,6 +140,23 @@ class StringWriter : public Writer {
   std::string buffer_;
 };
 
+/**
+ * A `Writer` that discards its output and only counts the number of bytes that
+ * would have been written.
+ *
+ * This is equivalent to the Nanopb sizing stream (`PB_OSTREAM_SIZING`) and
+ * avoids allocating a buffer when only the encoded size is of interest.
+ */
+class SizingWriter : public Writer {
+ public:
+  SizingWriter();
+
+  /** Returns the number of bytes written so far. */
+  size_t size() const {
+    return stream_.bytes_written;
+  }
+};
+
 }  // namespace nanopb
 }  // namespace firestore
 }  // namespace firebase
@@ -248,21 +248,30 @@ void WatchChangeAggregator::HandleExistenceFilter(
   if (target_data) {
     const Target& target = target_data->target();
     if (target.IsDocumentQuery()) {
+      DocumentKeySet keys = target.GetDocumentKeys();
       if (expected_count == 0) {
-        // The existence filter told us the document does not exist. We deduce
-        // that this document does not exist and apply a deleted document to our
-        // updates. Without applying this deleted document there might be
-        // another query that will raise this document as part of a snapshot
-        // until it is resolved, essentially exposing inconsistency between
-        // queries.
-        DocumentKey key{target.path()};
-        RemoveDocumentFromTarget(
-            target_id, key,
-            MutableDocument::NoDocument(key, SnapshotVersion::None()));
-      } else {
+        // The existence filter told us the documents do not exist. We deduce
+        // that these documents do not exist and apply deleted documents to our
+        // updates. Without applying these deleted documents there might be
+        // another query that will raise them as part of a snapshot until they
+        // are resolved, essentially exposing inconsistency between queries.
+        for (const DocumentKey& key : keys) {
+          RemoveDocumentFromTarget(
+              target_id, key,
+              MutableDocument::NoDocument(key, SnapshotVersion::None()));
+        }
+      } else if (keys.size() == 1) {
         HARD_ASSERT(expected_count == 1,
                     "Single document existence filter with count: %s",
                     expected_count);
+      } else if (GetCurrentDocumentCountForTarget(target_id) !=
+                 expected_count) {
+        // A document target for several documents can't tell which of them
+        // are missing, so re-run it. Documents that are never re-added will
+        // be deleted once the target is current.
+        ResetTarget(target_id);
+        pending_target_resets_.insert(
+            {target_id, QueryPurpose::ExistenceFilterMismatch});
       }
     } else {
       int current_size = GetCurrentDocumentCountForTarget(target_id);
@@ -369,18 +378,19 @@ RemoteEvent WatchChangeAggregator::CreateRemoteEvent(
         TargetDataForActiveTarget(target_id);
     if (target_data) {
       if (target_state.current() && target_data->target().IsDocumentQuery()) {
-        // Document queries for document that don't exist can produce an empty
-        // result set. To update our local cache, we synthesize a document
-        // delete if we have not previously received the document. This resolves
-        // the limbo state of the document, removing it from
-        // SyncEngine::limbo_document_refs_.
-        DocumentKey key{target_data->target().path()};
-        if (pending_document_updates_.find(key) ==
-                pending_document_updates_.end() &&
-            !TargetContainsDocument(target_id, key)) {
-          RemoveDocumentFromTarget(
-              target_id, key,
-              MutableDocument::NoDocument(key, snapshot_version));
+        // Document queries for documents that don't exist can produce an
+        // empty result set. To update our local cache, we synthesize a
+        // document delete for every targeted document we have not previously
+        // received. This resolves the limbo state of the document, removing it
+        // from SyncEngine::limbo_document_refs_.
+        for (const DocumentKey& key : target_data->target().GetDocumentKeys()) {
+          if (pending_document_updates_.find(key) ==
+                  pending_document_updates_.end() &&
+              !TargetContainsDocument(target_id, key)) {
+            RemoveDocumentFromTarget(
+                target_id, key,
+                MutableDocument::NoDocument(key, snapshot_version));
+          }
         }
       }
 
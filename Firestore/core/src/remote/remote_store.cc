@@ -16,6 +16,7 @@
 
 #include "Firestore/core/src/remote/remote_store.h"
 
+#include <iterator>
 #include <string>
 #include <utility>
 
@@ -43,6 +44,7 @@ using model::AggregateField;
 using model::BatchId;
 using model::DocumentKeySet;
 using model::kBatchIdUnknown;
+using model::Mutation;
 using model::MutationBatch;
 using model::MutationBatchResult;
 using model::MutationResult;
@@ -53,12 +55,6 @@ using nanopb::ByteString;
 using util::AsyncQueue;
 using util::Status;
 
-/**
- * The maximum number of pending writes to allow.
- * TODO(b/35853402): Negotiate this value with the backend.
- */
-constexpr int kMaxPendingWrites = 10;
-
 RemoteStore::RemoteStore(
     LocalStore* local_store,
     std::shared_ptr<Datastore> datastore,
@@ -67,6 +63,7 @@ RemoteStore::RemoteStore(
     std::function<void(model::OnlineState)> online_state_handler)
     : local_store_{local_store},
       datastore_{std::move(datastore)},
+      worker_queue_{worker_queue},
       online_state_tracker_{worker_queue, std::move(online_state_handler)},
       connectivity_monitor_{NOT_NULL(connectivity_monitor)} {
   datastore_->Start();
@@ -134,6 +131,7 @@ void RemoteStore::DisableNetworkInternal() {
               write_pipeline_.size());
     write_pipeline_.clear();
   }
+  write_pipeline_controller_.ClearOutstandingRequests();
 
   CleanUpWatchStreamState();
 }
@@ -405,27 +403,49 @@ void RemoteStore::FillWritePipeline() {
       }
       break;
     }
-    AddToWritePipeline(*batch);
     last_batch_id_retrieved = batch->batch_id();
+    write_pipeline_.push_back(std::move(*batch));
   }
 
+  // Send everything that was added at once so that adjacent batches can be
+  // coalesced.
+  SendPendingWrites();
+
   if (ShouldStartWriteStream()) {
     StartWriteStream();
   }
 }
 
 bool RemoteStore::CanAddToWritePipeline() const {
-  return CanUseNetwork() && write_pipeline_.size() < kMaxPendingWrites;
+  return CanUseNetwork() &&
+         write_pipeline_controller_.CanAddBatch(write_pipeline_.size());
 }
 
-void RemoteStore::AddToWritePipeline(const MutationBatch& batch) {
-  HARD_ASSERT(CanAddToWritePipeline(),
-              "AddToWritePipeline called when pipeline is full");
+void RemoteStore::SendPendingWrites() {
+  if (!write_stream_->IsOpen() || !write_stream_->handshake_complete()) {
+    return;
+  }
 
-  write_pipeline_.push_back(batch);
+  bool coalesce = write_pipeline_controller_.ShouldCoalesce();
+  size_t next = write_pipeline_controller_.sent_batch_count();
+  while (next < write_pipeline_.size()) {
+    std::vector<Mutation> mutations = write_pipeline_[next].mutations();
+    size_t end = next + 1;
+
+    if (coalesce &&
+        write_pipeline_[next].batch_id() > uncoalesced_through_batch_id_) {
+      while (end < write_pipeline_.size() &&
+             mutations.size() + write_pipeline_[end].mutations().size() <=
+                 WritePipelineController::kMaxMutationsPerRequest) {
+        const std::vector<Mutation>& more = write_pipeline_[end].mutations();
+        mutations.insert(mutations.end(), more.begin(), more.end());
+        ++end;
+      }
+    }
 
-  if (write_stream_->IsOpen() && write_stream_->handshake_complete()) {
-    write_stream_->WriteMutations(batch.mutations());
+    size_t byte_size = write_stream_->WriteMutations(mutations);
+    write_pipeline_controller_.RecordRequestSent(end - next, byte_size);
+    next = end;
   }
 }
 
@@ -449,25 +469,53 @@ void RemoteStore::OnWriteStreamHandshakeComplete() {
   local_store_->SetLastStreamToken(write_stream_->last_stream_token());
 
   // Send the write pipeline now that the stream is established.
-  for (const MutationBatch& write : write_pipeline_) {
-    write_stream_->WriteMutations(write.mutations());
-  }
+  write_pipeline_controller_.ClearOutstandingRequests();
+  SendPendingWrites();
 }
 
 void RemoteStore::OnWriteStreamMutationResult(
     SnapshotVersion commit_version,
     std::vector<MutationResult> mutation_results) {
   // This is a response to a write containing mutations and should be correlated
-  // to the first write in our write pipeline.
+  // to the first write(s) in our write pipeline.
   HARD_ASSERT(!write_pipeline_.empty(), "Got result for empty write pipeline");
 
-  MutationBatch batch = write_pipeline_.front();
-  write_pipeline_.erase(write_pipeline_.begin());
-
-  MutationBatchResult batch_result(std::move(batch), commit_version,
-                                   std::move(mutation_results),
-                                   write_stream_->last_stream_token());
-  sync_engine_->HandleSuccessfulWrite(std::move(batch_result));
+  size_t batch_count = write_pipeline_controller_.RecordResponse();
+  HARD_ASSERT(batch_count <= write_pipeline_.size(),
+              "Got result for more batches than are in the write pipeline");
+
+  std::vector<MutationBatch> batches(
+      std::make_move_iterator(write_pipeline_.begin()),
+      std::make_move_iterator(write_pipeline_.begin() + batch_count));
+  write_pipeline_.erase(write_pipeline_.begin(),
+                        write_pipeline_.begin() + batch_count);
+
+  if (batch_count == 1) {
+    MutationBatchResult batch_result(std::move(batches.front()),
+                                     commit_version,
+                                     std::move(mutation_results),
+                                     write_stream_->last_stream_token());
+    sync_engine_->HandleSuccessfulWrite(std::move(batch_result));
+  } else {
+    // The results of a coalesced request are the concatenation of the results
+    // of each batch, in order.
+    auto results = std::make_move_iterator(mutation_results.begin());
+    size_t offset = 0;
+    for (MutationBatch& batch : batches) {
+      size_t result_count = batch.mutations().size();
+      HARD_ASSERT(offset + result_count <= mutation_results.size(),
+                  "Got fewer results than mutations in a coalesced request");
+
+      std::vector<MutationResult> batch_results(
+          results + offset, results + offset + result_count);
+      offset += result_count;
+
+      MutationBatchResult batch_result(std::move(batch), commit_version,
+                                       std::move(batch_results),
+                                       write_stream_->last_stream_token());
+      sync_engine_->HandleSuccessfulWrite(std::move(batch_result));
+    }
+  }
 
   // It's possible that with the completion of this mutation another slot has
   // freed up.
@@ -482,6 +530,12 @@ void RemoteStore::OnWriteStreamClose(const Status& status) {
                 "Write stream was stopped gracefully while still needed.");
   }
 
+  // Anything still in the pipeline will be resent on the next stream, which
+  // may already be started while handling the error below.
+  size_t head_request_batch_count =
+      write_pipeline_controller_.head_request_batch_count();
+  write_pipeline_controller_.ClearOutstandingRequests();
+
   // If the write stream closed due to an error, invoke the error callbacks if
   // there are pending writes.
   if (!status.ok() && !write_pipeline_.empty()) {
@@ -489,7 +543,7 @@ void RemoteStore::OnWriteStreamClose(const Status& status) {
     // go/firestore-client-errors
     if (write_stream_->handshake_complete()) {
       // This error affects the actual writes.
-      HandleWriteError(status);
+      HandleWriteError(status, head_request_batch_count);
     } else {
       // If there was an error before the handshake finished, it's possible that
       // the server is unable to process the stream token we're sending.
@@ -526,7 +580,7 @@ void RemoteStore::HandleHandshakeError(const Status& status) {
   }
 }
 
-void RemoteStore::HandleWriteError(const Status& status) {
+void RemoteStore::HandleWriteError(const Status& status, size_t batch_count) {
   HARD_ASSERT(!status.ok(), "Handling write error with status OK.");
 
   // Only handle permanent errors here. If it's transient, just let the retry
@@ -535,6 +589,16 @@ void RemoteStore::HandleWriteError(const Status& status) {
     return;
   }
 
+  if (batch_count > 1) {
+    // The rejected request contained several batches and there's no telling
+    // which one was the problem. Resend them one by one so that only the
+    // offending batch gets rejected.
+    uncoalesced_through_batch_id_ =
+        write_pipeline_[batch_count - 1].batch_id();
+    write_stream_->InhibitBackoff();
+    return;
+  }
+
   // If this was a permanent error, the request itself was the problem so it's
   // not going to succeed if we resend it.
   MutationBatch batch = write_pipeline_.front();
@@ -558,7 +622,7 @@ bool RemoteStore::CanUseNetwork() const {
 }
 
 std::shared_ptr<Transaction> RemoteStore::CreateTransaction() {
-  return std::make_shared<Transaction>(datastore_);
+  return std::make_shared<Transaction>(datastore_, worker_queue_);
 }
 
 DocumentKeySet RemoteStore::GetRemoteKeysForTarget(TargetId target_id) const {
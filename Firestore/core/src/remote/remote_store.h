@@ -31,6 +31,7 @@
 #include "Firestore/core/src/remote/remote_event.h"
 #include "Firestore/core/src/remote/watch_change.h"
 #include "Firestore/core/src/remote/watch_stream.h"
+#include "Firestore/core/src/remote/write_pipeline_controller.h"
 #include "Firestore/core/src/remote/write_stream.h"
 #include "Firestore/core/src/util/async_queue.h"
 #include "Firestore/core/src/util/status_fwd.h"
@@ -182,12 +183,6 @@ class RemoteStore : public TargetMetadataProvider,
    */
   void FillWritePipeline();
 
-  /**
-   * Queues additional writes to be sent to the write stream, sending them
-   * immediately if the write stream is established.
-   */
-  void AddToWritePipeline(const model::MutationBatch& batch);
-
   /** Returns a new transaction backed by this remote store. */
   // TODO(c++14): return a plain value when it becomes possible to move
   // `Transaction` into lambdas.
@@ -216,6 +211,11 @@ class RemoteStore : public TargetMetadataProvider,
       model::SnapshotVersion commit_version,
       std::vector<model::MutationResult> mutation_results) override;
 
+  /** Test-only method */
+  WritePipelineController& write_pipeline_controller() {
+    return write_pipeline_controller_;
+  }
+
  private:
   void RestartNetwork();
   void DisableNetworkInternal();
@@ -240,6 +240,13 @@ class RemoteStore : public TargetMetadataProvider,
 
   void StartWriteStream();
 
+  /**
+   * Sends all batches in the write pipeline that haven't been sent on the
+   * current write stream yet, coalescing adjacent batches into a single write
+   * request if the `write_pipeline_controller_` asks for it.
+   */
+  void SendPendingWrites();
+
   /**
    * Returns true if the network is enabled, the write stream has not yet been
    * started and there are pending writes.
@@ -247,7 +254,11 @@ class RemoteStore : public TargetMetadataProvider,
   bool ShouldStartWriteStream() const;
 
   void HandleHandshakeError(const util::Status& status);
-  void HandleWriteError(const util::Status& status);
+  /**
+   * Handles the rejection of the oldest write request, which contained
+   * `batch_count` batches.
+   */
+  void HandleWriteError(const util::Status& status, size_t batch_count);
 
   void StartWatchStream();
 
@@ -270,6 +281,8 @@ class RemoteStore : public TargetMetadataProvider,
   /** The client-side proxy for interacting with the backend. */
   std::shared_ptr<Datastore> datastore_;
 
+  std::shared_ptr<util::AsyncQueue> worker_queue_;
+
   /**
    * A mapping of watched targets that the client cares about tracking and the
    * user has explicitly called a 'listen' for this target.
@@ -296,9 +309,9 @@ class RemoteStore : public TargetMetadataProvider,
   std::unique_ptr<WatchChangeAggregator> watch_change_aggregator_;
 
   /**
-   * A list of up to `kMaxPendingWrites` writes that we have fetched from the
-   * `LocalStore` via `FillWritePipeline` and have or will send to the write
-   * stream.
+   * A list of up to `WritePipelineController::max_pending_batches()` writes
+   * that we have fetched from the `LocalStore` via `FillWritePipeline` and
+   * have or will send to the write stream.
    *
    * Whenever `write_pipeline_` is not empty, the `RemoteStore` will attempt to
    * start or restart the write stream. When the stream is established, the
@@ -310,9 +323,23 @@ class RemoteStore : public TargetMetadataProvider,
    *
    * Write responses from the backend are linked to their originating request
    * purely based on order, and so we can just remove writes from the front of
-   * the `write_pipeline_` as we receive responses.
+   * the `write_pipeline_` as we receive responses. A single request may carry
+   * several batches; `write_pipeline_controller_` remembers how many.
    */
   std::vector<model::MutationBatch> write_pipeline_;
+
+  /**
+   * Tracks the write requests in flight on the current write stream and
+   * adapts the pipeline depth to the observed acknowledgement latency.
+   */
+  WritePipelineController write_pipeline_controller_;
+
+  /**
+   * Batches with IDs up to and including this one are never coalesced. Set
+   * when a coalesced request is rejected so that the offending batch can be
+   * identified by resending its batches individually.
+   */
+  model::BatchId uncoalesced_through_batch_id_ = model::kBatchIdUnknown;
 };
 
 }  // namespace remote
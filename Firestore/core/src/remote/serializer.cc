@@ -79,6 +79,7 @@ using model::DatabaseId;
 using model::DeepClone;
 using model::DeleteMutation;
 using model::DocumentKey;
+using model::DocumentKeySet;
 using model::EncodeServerTimestamp;
 using model::FieldMask;
 using model::FieldPath;
@@ -663,9 +664,13 @@ google_firestore_v1_Target_DocumentsTarget Serializer::EncodeDocumentsTarget(
     const core::Target& target) const {
   google_firestore_v1_Target_DocumentsTarget result{};
 
-  result.documents_count = 1;
+  DocumentKeySet keys = target.GetDocumentKeys();
+  result.documents_count = CheckedSize(keys.size());
   result.documents = MakeArray<pb_bytes_array_t*>(result.documents_count);
-  result.documents[0] = EncodeQueryPath(target.path());
+  pb_size_t i = 0;
+  for (const DocumentKey& key : keys) {
+    result.documents[i++] = EncodeQueryPath(key.path());
+  }
 
   return result;
 }
@@ -673,16 +678,30 @@ google_firestore_v1_Target_DocumentsTarget Serializer::EncodeDocumentsTarget(
 Target Serializer::DecodeDocumentsTarget(
     ReadContext* context,
     const google_firestore_v1_Target_DocumentsTarget& proto) const {
-  if (proto.documents_count != 1) {
-    context->Fail(
-        StringFormat("DocumentsTarget contained other than 1 document %s",
-                     proto.documents_count));
+  if (proto.documents_count == 0) {
+    context->Fail("DocumentsTarget contained no documents");
     return {};
   }
 
-  ResourcePath path =
-      DecodeQueryPath(context, DecodeString(proto.documents[0]));
-  return Query(std::move(path)).ToTarget();
+  if (proto.documents_count == 1) {
+    ResourcePath path =
+        DecodeQueryPath(context, DecodeString(proto.documents[0]));
+    return Query(std::move(path)).ToTarget();
+  }
+
+  DocumentKeySet keys;
+  for (pb_size_t i = 0; i < proto.documents_count; ++i) {
+    ResourcePath path =
+        DecodeQueryPath(context, DecodeString(proto.documents[i]));
+    if (!context->status().ok()) return {};
+    if (!DocumentKey::IsDocumentKey(path)) {
+      context->Fail(StringFormat("Invalid document path in DocumentsTarget: %s",
+                                 path.CanonicalString()));
+      return {};
+    }
+    keys = keys.insert(DocumentKey{std::move(path)});
+  }
+  return Target::ForDocuments(keys);
 }
 
 google_firestore_v1_Target_QueryTarget Serializer::EncodeQueryTarget(
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/remote/write_pipeline_controller.h"
+
+#include <algorithm>
+
+#include "Firestore/core/src/util/hard_assert.h"
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+
+namespace chr = std::chrono;
+
+constexpr size_t WritePipelineController::kMinPendingBatches;
+constexpr size_t WritePipelineController::kMaxPendingBatches;
+constexpr size_t WritePipelineController::kMaxBytesInFlight;
+constexpr size_t WritePipelineController::kMaxMutationsPerRequest;
+constexpr WritePipelineController::Milliseconds
+    WritePipelineController::kHighLatencyThreshold;
+
+size_t WritePipelineController::max_pending_batches() const {
+  if (smoothed_rtt_ < kHighLatencyThreshold) {
+    return kMinPendingBatches;
+  }
+
+  // Keep roughly `kMinPendingBatches` in flight per `kHighLatencyThreshold` of
+  // round trip time.
+  auto rtt = static_cast<size_t>(smoothed_rtt_.count());
+  auto threshold = static_cast<size_t>(kHighLatencyThreshold.count());
+  return std::min(kMinPendingBatches * rtt / threshold, kMaxPendingBatches);
+}
+
+bool WritePipelineController::CanAddBatch(size_t pending_batches) const {
+  if (pending_batches >= max_pending_batches()) {
+    return false;
+  }
+  // Always allow at least one batch so that an oversized batch can't stall
+  // the pipeline.
+  return pending_batches == 0 || bytes_in_flight_ < kMaxBytesInFlight;
+}
+
+void WritePipelineController::RecordRequestSent(size_t batch_count,
+                                                size_t byte_size,
+                                                Clock::time_point now) {
+  HARD_ASSERT(batch_count > 0, "A write request must contain a batch");
+  requests_.push_back(
+      Request{batch_count, byte_size, now, /*sent_at_head=*/requests_.empty()});
+  sent_batch_count_ += batch_count;
+  bytes_in_flight_ += byte_size;
+}
+
+size_t WritePipelineController::RecordResponse(Clock::time_point now) {
+  HARD_ASSERT(!requests_.empty(), "Got a response without a pending request");
+
+  Request request = requests_.front();
+  requests_.pop_front();
+  sent_batch_count_ -= request.batch_count;
+  bytes_in_flight_ -= request.byte_size;
+
+  if (!request.sent_at_head) {
+    return request.batch_count;
+  }
+
+  auto sample = chr::duration_cast<Milliseconds>(now - request.sent_time);
+  if (!has_rtt_sample_) {
+    smoothed_rtt_ = sample;
+    has_rtt_sample_ = true;
+  } else {
+    // SRTT = 7/8 * SRTT + 1/8 * sample
+    smoothed_rtt_ = (smoothed_rtt_ * 7 + sample) / 8;
+  }
+
+  return request.batch_count;
+}
+
+void WritePipelineController::ClearOutstandingRequests() {
+  requests_.clear();
+  sent_batch_count_ = 0;
+  bytes_in_flight_ = 0;
+}
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
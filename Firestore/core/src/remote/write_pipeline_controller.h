@@ -0,0 +1,164 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_REMOTE_WRITE_PIPELINE_CONTROLLER_H_
+#define FIRESTORE_CORE_SRC_REMOTE_WRITE_PIPELINE_CONTROLLER_H_
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <deque>
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+
+/**
+ * Decides how deep the `RemoteStore` write pipeline may be and whether
+ * adjacent mutation batches should be packed into a single write request.
+ *
+ * The controller tracks every write request that has been sent on the current
+ * stream and has not been acknowledged yet, in the order in which it was sent.
+ * Because the backend acknowledges write requests strictly in order, each
+ * response corresponds to the oldest outstanding request.
+ *
+ * The round trip times of acknowledged requests are folded into a smoothed
+ * estimate (as in TCP, see RFC 6298). Only requests that were sent while no
+ * other request was outstanding are measured: the response time of any other
+ * request includes the time it spent queued behind earlier requests, which
+ * would make the depth ratchet upwards as the pipeline fills. On low-latency
+ * links the pipeline keeps
+ * its historical depth of `kMinPendingBatches`; as latency grows the depth is
+ * scaled up proportionally (up to `kMaxPendingBatches`) so that enough batches
+ * are in flight to cover the round trip, and small batches start getting
+ * coalesced. The number of bytes in flight is capped independently of the
+ * depth.
+ */
+class WritePipelineController {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Milliseconds = std::chrono::milliseconds;
+
+  /**
+   * The number of batches the pipeline may always hold, regardless of the
+   * observed latency.
+   */
+  static constexpr size_t kMinPendingBatches = 10;
+
+  /** The upper bound on the adaptive pipeline depth. */
+  static constexpr size_t kMaxPendingBatches = 100;
+
+  /**
+   * The maximum number of encoded bytes that may be in flight before the
+   * pipeline stops accepting new batches.
+   */
+  static constexpr size_t kMaxBytesInFlight = 4 * 1024 * 1024;
+
+  /**
+   * The maximum number of mutations packed into a single write request. This
+   * matches the backend's limit on the number of writes in a commit.
+   */
+  static constexpr size_t kMaxMutationsPerRequest = 500;
+
+  /**
+   * The smoothed round trip time above which the link is considered to be
+   * high-latency: the pipeline starts growing past `kMinPendingBatches` and
+   * adjacent batches are coalesced.
+   */
+  static constexpr Milliseconds kHighLatencyThreshold{200};
+
+  /**
+   * Returns the number of batches the write pipeline may currently hold.
+   */
+  size_t max_pending_batches() const;
+
+  /**
+   * Returns true if a pipeline currently holding `pending_batches` batches can
+   * accept another one.
+   */
+  bool CanAddBatch(size_t pending_batches) const;
+
+  /**
+   * Returns true if adjacent batches should be sent in a single write request.
+   */
+  bool ShouldCoalesce() const {
+    return smoothed_rtt_ >= kHighLatencyThreshold;
+  }
+
+  /**
+   * Records that a write request containing the mutations of `batch_count`
+   * consecutive batches, `byte_size` bytes long once encoded, has been sent.
+   */
+  void RecordRequestSent(size_t batch_count,
+                         size_t byte_size,
+                         Clock::time_point now = Clock::now());
+
+  /**
+   * Records the acknowledgement of the oldest outstanding request and returns
+   * the number of batches it contained.
+   */
+  size_t RecordResponse(Clock::time_point now = Clock::now());
+
+  /**
+   * Returns the number of batches contained in the oldest outstanding request,
+   * or zero if there are no outstanding requests.
+   */
+  size_t head_request_batch_count() const {
+    return requests_.empty() ? 0 : requests_.front().batch_count;
+  }
+
+  /**
+   * The number of batches (counting from the front of the pipeline) that have
+   * been sent on the current stream.
+   */
+  size_t sent_batch_count() const {
+    return sent_batch_count_;
+  }
+
+  size_t bytes_in_flight() const {
+    return bytes_in_flight_;
+  }
+
+  Milliseconds smoothed_rtt() const {
+    return smoothed_rtt_;
+  }
+
+  /**
+   * Forgets about all outstanding requests, e.g. because the write stream has
+   * been closed. The latency estimate is retained.
+   */
+  void ClearOutstandingRequests();
+
+ private:
+  struct Request {
+    size_t batch_count = 0;
+    size_t byte_size = 0;
+    Clock::time_point sent_time;
+    /** Whether no other request was outstanding when this one was sent. */
+    bool sent_at_head = false;
+  };
+
+  std::deque<Request> requests_;
+  size_t sent_batch_count_ = 0;
+  size_t bytes_in_flight_ = 0;
+  Milliseconds smoothed_rtt_{0};
+  bool has_rtt_sample_ = false;
+};
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_REMOTE_WRITE_PIPELINE_CONTROLLER_H_
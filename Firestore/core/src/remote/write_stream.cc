@@ -82,7 +82,7 @@ void WriteStream::WriteHandshake() {
   // stream token on the handshake, ignoring any stream token we might have.
 }
 
-void WriteStream::WriteMutations(const std::vector<Mutation>& mutations) {
+size_t WriteStream::WriteMutations(const std::vector<Mutation>& mutations) {
   EnsureOnQueue();
   HARD_ASSERT(IsOpen(), "Writing mutations requires an opened stream");
   HARD_ASSERT(handshake_complete(),
@@ -91,7 +91,10 @@ void WriteStream::WriteMutations(const std::vector<Mutation>& mutations) {
   auto request = write_serializer_.EncodeWriteMutationsRequest(
       mutations, last_stream_token());
   LOG_DEBUG("%s write request: %s", GetDebugDescription(), request.ToString());
-  Write(MakeByteBuffer(request));
+  grpc::ByteBuffer buffer = MakeByteBuffer(request);
+  size_t byte_size = buffer.Length();
+  Write(std::move(buffer));
+  return byte_size;
 }
 
 std::unique_ptr<GrpcStream> WriteStream::CreateGrpcStream(
@@ -126,8 +126,12 @@ class WriteStream : public Stream {
    */
   virtual void WriteHandshake();
 
-  /** Sends a group of mutations to the Firestore backend to apply. */
-  virtual void WriteMutations(const std::vector<model::Mutation>& mutations);
+  /**
+   * Sends a group of mutations to the Firestore backend to apply.
+   *
+   * @return The size of the encoded request in bytes.
+   */
+  virtual size_t WriteMutations(const std::vector<model::Mutation>& mutations);
 
  protected:
   // For tests only
@@ -73,7 +73,13 @@ enum class TimerId {
   /**
    * A timer used to periodically attempt Index Backfill
    */
-  IndexBackfillDelay
+  IndexBackfillDelay,
+
+  /**
+   * A timer used by a `QueryListener` to raise snapshots that were held back
+   * by `ListenOptions::min_snapshot_interval()`.
+   */
+  ListenerSnapshotInterval
 };
 
 // A serial queue that executes given operations asynchronously, one at a time.
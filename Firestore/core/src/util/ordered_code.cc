@@ -28,6 +28,12 @@
 #include "absl/base/port.h"
 #include "absl/strings/internal/resize_uninitialized.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #if !defined(ABSL_IS_LITTLE_ENDIAN) && !defined(ABSL_IS_BIG_ENDIAN)
 #error \
     "Unsupported byte order: Either ABSL_IS_BIG_ENDIAN or " \
@@ -263,53 +269,124 @@ inline int AdvanceIfNoSpecialBytes(uint32_t v_32, const char* p) {
   }
 }
 
-// Return a pointer to the first byte in the range "[start..limit)"
-// whose value is 0 or 255 (kEscape1 or kEscape2).  If no such byte
-// exists in the range, returns "limit".
-inline const char* SkipToNextSpecialByte(const char* start, const char* limit) {
+// Returns the index of the least significant set bit of the non-zero "v".
+inline size_t LowestSetBit(uint64_t v) {
+  return static_cast<size_t>(Bits::Log2FloorNonZero64(v & (~v + 1)));
+}
+
+// Returns the offset of the first byte among the 8 bytes starting at "p"
+// whose value is 0 or 255, or 8 if there is no such byte.
+inline size_t FindSpecialByteIn8(const char* p) {
   // If these constants were ever changed, this routine needs to change
   static_assert(kEscape1 == 0, "bit fiddling needs readjusting");
   static_assert((kEscape2 & 0xff) == 255, "bit fiddling needs readjusting");
-  const char* p = start;
-  while (p + 8 <= limit) {
-    // Find out if any of the next 8 bytes are either 0 or 255 (our
-    // two characters that require special handling).  We do this using
-    // the technique described in:
-    //
-    //    http://graphics.stanford.edu/~seander/bithacks.html#HasLessInWord
-    //
-    // We use the test (x + 1) < 2 to check x = 0 or -1(255)
-    //
-    // If x is a byte value (0x00..0xff):
-    // (x - 0x01) & 0x80 is true only when x = 0x81..0xff, 0x00
-    // ~(x + 0x01) & 0x80 is true only when x = 0x00..0x7e, 0xff
-    // The intersection of the above two sets is x = 0x00 or 0xff.
-    // We can ignore carry between bytes because only x = 0x00 or 0xff
-    // can cause carry in the expression -- and such x already makes the
-    // result value non-zero.
-    uint64_t v = UNALIGNED_LOAD64(p);
-    bool hasZeroOr255Byte = (v - 0x0101010101010101ull) &
-                            ~(v + 0x0101010101010101ull) &
-                            0x8080808080808080ull;
-    if (!hasZeroOr255Byte) {
-      // No special values in the next 8 bytes
-      p += 8;
-    } else {
-      // We know the next 8 bytes have a special byte: find it
+
+  // Find out if any of the next 8 bytes are either 0 or 255 (our
+  // two characters that require special handling).  We do this using
+  // the technique described in:
+  //
+  //    http://graphics.stanford.edu/~seander/bithacks.html#HasLessInWord
+  //
+  // We use the test (x + 1) < 2 to check x = 0 or -1(255)
+  //
+  // If x is a byte value (0x00..0xff):
+  // (x - 0x01) & 0x80 is true only when x = 0x81..0xff, 0x00
+  // ~(x + 0x01) & 0x80 is true only when x = 0x00..0x7e, 0xff
+  // The intersection of the above two sets is x = 0x00 or 0xff.
+  // Carries and borrows between bytes only start at x = 0x00 or 0xff and
+  // only move towards more significant bytes, so the least significant
+  // flagged byte is always a special byte.
+  uint64_t v = UNALIGNED_LOAD64(p);
+  uint64_t special = (v - 0x0101010101010101ull) &
+                     ~(v + 0x0101010101010101ull) & 0x8080808080808080ull;
+  if (!special) {
+    return 8;
+  }
+
 #ifdef ABSL_IS_LITTLE_ENDIAN
-      uint32_t v_32 = static_cast<uint32_t>(v);  // Low 32 bits of v
+  // The least significant byte of v is p[0].
+  return LowestSetBit(special) / 8;
 #else
-      uint32_t v_32 = UNALIGNED_LOAD32(p);
+  size_t offset = 0;
+  while (!IsSpecialByte(p[offset])) {
+    offset++;
+  }
+  return offset;
 #endif
-      // Test 32 bits at once to see if special byte is in next 4 bytes
-      // or the following 4 bytes
-      p += AdvanceIfNoSpecialBytes(v_32, p);
-      if (IsSpecialByte(p[0])) return p;
-      if (IsSpecialByte(p[1])) return p + 1;
-      if (IsSpecialByte(p[2])) return p + 2;
-      HARD_ASSERT(IsSpecialByte(p[3]));  // Last byte must be the special one
-      return p + 3;
+}
+
+#if defined(__SSE2__)
+
+// Returns the offset of the first byte among the 16 bytes starting at "p"
+// whose value is 0 or 255, or 16 if there is no such byte.
+inline size_t FindSpecialByteIn16(const char* p) {
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_setzero_si128()),
+                                 _mm_cmpeq_epi8(v, _mm_set1_epi8(-1)));
+  auto mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+  if (mask == 0) {
+    return 16;
+  }
+  // Bit i of the mask is set iff p[i] is special.
+  return LowestSetBit(mask);
+}
+
+#elif defined(__ARM_NEON) && defined(ABSL_IS_LITTLE_ENDIAN)
+
+// Returns the offset of the first byte among the 16 bytes starting at "p"
+// whose value is 0 or 255, or 16 if there is no such byte.
+inline size_t FindSpecialByteIn16(const char* p) {
+  uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+  uint8x16_t special =
+      vorrq_u8(vceqq_u8(v, vdupq_n_u8(0)), vceqq_u8(v, vdupq_n_u8(0xff)));
+  // Narrow each byte of the comparison result to a nibble, so that bits
+  // 4 * i to 4 * i + 3 of the mask are set iff p[i] is special.
+  uint64_t mask = vget_lane_u64(
+      vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(special), 4)), 0);
+  if (mask == 0) {
+    return 16;
+  }
+  return LowestSetBit(mask) / 4;
+}
+
+#else
+
+// Without vector instructions, scan two words at a time.
+inline size_t FindSpecialByteIn16(const char* p) {
+  size_t offset = FindSpecialByteIn8(p);
+  return offset < 8 ? offset : 8 + FindSpecialByteIn8(p + 8);
+}
+
+#endif
+
+// Return a pointer to the first byte in the range "[start..limit)"
+// whose value is 0 or 255 (kEscape1 or kEscape2).  If no such byte
+// exists in the range, returns "limit".
+inline const char* SkipToNextSpecialByte(const char* start, const char* limit) {
+  const char* p = start;
+  if (limit - p >= 16) {
+    while (p + 16 <= limit) {
+      size_t offset = FindSpecialByteIn16(p);
+      if (offset < 16) {
+        return p + offset;
+      }
+      p += 16;
+    }
+    if (p == limit) {
+      return limit;
+    }
+    // Rescan the last 16 bytes rather than handling the tail bytewise. The
+    // bytes before "p" are already known not to be special.
+    const char* last = limit - 16;
+    return last + FindSpecialByteIn16(last);
+  }
+
+  if (p + 8 <= limit) {
+    size_t offset = FindSpecialByteIn8(p);
+    if (offset < 8) {
+      return p + offset;
     }
+    p += 8;
   }
   if (p + 4 <= limit) {
     uint32_t v_32 = UNALIGNED_LOAD32(p);
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_UTIL_PHASE_TIMER_H_
+#define FIRESTORE_CORE_SRC_UTIL_PHASE_TIMER_H_
+
+#include <chrono>  // NOLINT(build/c++11)
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+/**
+ * Measures the consecutive phases of an operation. The first phase starts when
+ * the timer is created and each call to `EndPhase()` starts the next one, so
+ * the phases add up to the time spent in the whole operation:
+ *
+ *     PhaseTimer timer;
+ *     OpenFiles();
+ *     timings.open = timer.EndPhase();
+ *     ReadFiles();
+ *     timings.read = timer.EndPhase();
+ */
+class PhaseTimer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  PhaseTimer() : phase_start_(Clock::now()) {
+  }
+
+  /** Returns the duration of the current phase and starts the next one. */
+  std::chrono::microseconds EndPhase() {
+    Clock::time_point now = Clock::now();
+    Clock::duration elapsed = now - phase_start_;
+    phase_start_ = now;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+  }
+
+ private:
+  Clock::time_point phase_start_;
+};
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_UTIL_PHASE_TIMER_H_
@@ -184,6 +184,19 @@ TEST(Settings, EqualityAndHash) {
     EXPECT_NE(settings1, settings2);
     EXPECT_NE(settings1.Hash(), settings2.Hash());
   }
+  {
+    Settings settings1;
+    settings1.set_local_cache_settings(PersistentCacheSettings{});
+
+    Settings settings2;
+    settings2.set_local_cache_settings(
+        PersistentCacheSettings{}.WithCompressionEnabled(true));
+
+    EXPECT_FALSE(settings1.compression_enabled());
+    EXPECT_TRUE(settings2.compression_enabled());
+    EXPECT_NE(settings1, settings2);
+    EXPECT_NE(settings1.Hash(), settings2.Hash());
+  }
 }
 
 }  // namespace
@@ -16,18 +16,24 @@
 
 #include "Firestore/core/src/core/event_manager.h"
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "Firestore/core/src/core/query_listener.h"
 #include "Firestore/core/src/core/sync_engine.h"
+#include "Firestore/core/src/core/view.h"
 #include "Firestore/core/src/core/view_snapshot.h"
 #include "Firestore/core/src/model/document_key_set.h"
 #include "Firestore/core/src/model/document_set.h"
 #include "Firestore/core/src/model/types.h"
+#include "Firestore/core/src/util/async_queue.h"
+#include "Firestore/core/src/util/empty.h"
 #include "Firestore/core/src/util/statusor.h"
+#include "Firestore/core/test/unit/testutil/async_testing.h"
 #include "Firestore/core/test/unit/testutil/testutil.h"
+#include "Firestore/core/test/unit/testutil/view_testing.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -41,10 +47,17 @@ using model::DocumentSet;
 using model::OnlineState;
 using testing::_;
 using testing::ElementsAre;
+using testing::NiceMock;
 using testing::StrictMock;
+using testutil::ApplyChanges;
+using testutil::Doc;
+using testutil::Map;
 using testutil::Query;
+using util::AsyncQueue;
+using util::Empty;
 using util::StatusOr;
 using util::StatusOrCallback;
+using util::TimerId;
 
 ViewSnapshotListener NoopViewSnapshotHandler() {
   return EventListener<ViewSnapshot>::Create(
@@ -175,6 +188,53 @@ TEST(EventManagerTest, WillForwardOnlineStateChanges) {
               ElementsAre(OnlineState::Unknown, OnlineState::Online));
 }
 
+TEST(EventManagerTest, DefersSnapshotsInSyncWhileSnapshotsAreHeldBack) {
+  std::shared_ptr<AsyncQueue> queue = testutil::AsyncQueueForTesting();
+  core::Query query = Query("rooms");
+  int limited_events = 0;
+  int unlimited_events = 0;
+  int in_sync_events = 0;
+
+  ListenOptions options =
+      ListenOptions::DefaultOptions().WithMinSnapshotInterval(
+          std::chrono::hours(1));
+  auto limited = QueryListener::Create(
+      query, options, [&](StatusOr<ViewSnapshot>) { ++limited_events; });
+  limited->set_worker_queue(queue);
+  auto unlimited = QueryListener::Create(
+      query, [&](StatusOr<ViewSnapshot>) { ++unlimited_events; });
+  std::shared_ptr<EventListener<Empty>> in_sync_listener =
+      EventListener<Empty>::Create(
+          [&](const StatusOr<Empty>&) { ++in_sync_events; });
+
+  View view(query, DocumentKeySet{});
+  ViewSnapshot snap1 =
+      ApplyChanges(&view, {Doc("rooms/a", 1, Map())}, absl::nullopt).value();
+  ViewSnapshot snap2 =
+      ApplyChanges(&view, {Doc("rooms/b", 1, Map())}, absl::nullopt).value();
+
+  NiceMock<MockEventSource> mock_event_source;
+  EventManager event_manager(&mock_event_source);
+
+  queue->EnqueueBlocking([&] {
+    event_manager.AddSnapshotsInSyncListener(in_sync_listener);
+    event_manager.AddQueryListener(limited);
+    event_manager.AddQueryListener(unlimited);
+    event_manager.OnViewSnapshots({snap1});
+    event_manager.OnViewSnapshots({snap2});
+  });
+
+  // The second snapshot was only raised by the listener without a minimum
+  // snapshot interval, so the listeners are not in sync.
+  EXPECT_EQ(limited_events, 1);
+  EXPECT_EQ(unlimited_events, 2);
+  EXPECT_EQ(in_sync_events, 2);
+
+  queue->RunScheduledOperationsUntil(TimerId::ListenerSnapshotInterval);
+  EXPECT_EQ(limited_events, 2);
+  EXPECT_EQ(in_sync_events, 3);
+}
+
 }  // namespace
 }  // namespace core
 }  // namespace firestore
@@ -16,6 +16,7 @@
 
 #include "Firestore/core/src/core/query_listener.h"
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <future>  // NOLINT(build/c++11)
 #include <memory>
 #include <utility>
@@ -29,6 +30,7 @@
 #include "Firestore/core/src/model/document_set.h"
 #include "Firestore/core/src/model/types.h"
 #include "Firestore/core/src/remote/remote_event.h"
+#include "Firestore/core/src/util/async_queue.h"
 #include "Firestore/core/src/util/delayed_constructor.h"
 #include "Firestore/core/src/util/executor.h"
 #include "Firestore/core/src/util/status.h"
@@ -48,10 +50,12 @@ using model::DocumentSet;
 using model::MutableDocument;
 using model::OnlineState;
 using remote::TargetChange;
+using util::AsyncQueue;
 using util::DelayedConstructor;
 using util::Executor;
 using util::Status;
 using util::StatusOr;
+using util::TimerId;
 
 using testing::ElementsAre;
 using testing::IsEmpty;
@@ -518,6 +522,75 @@ TEST_F(QueryListenerTest,
   ASSERT_THAT(events, ElementsAre(expected_snap));
 }
 
+TEST_F(QueryListenerTest, MergesSnapshotsWithinMinSnapshotInterval) {
+  std::shared_ptr<AsyncQueue> queue = testutil::AsyncQueueForTesting();
+  std::vector<ViewSnapshot> accum;
+
+  Query query = testutil::Query("rooms");
+  MutableDocument doc1 = Doc("rooms/Eros", 1, Map("name", "Eros"));
+  MutableDocument doc2 = Doc("rooms/Hades", 2, Map("name", "Hades"));
+  MutableDocument doc2prime =
+      Doc("rooms/Hades", 3, Map("name", "Hades", "owner", "Jonny"));
+  MutableDocument doc3 = Doc("rooms/Other", 4, Map("name", "Other"));
+
+  ListenOptions options =
+      ListenOptions::DefaultOptions().WithMinSnapshotInterval(
+          std::chrono::hours(1));
+  auto listener = QueryListener::Create(query, options, Accumulating(&accum));
+  listener->set_worker_queue(queue);
+
+  View view(query, DocumentKeySet{});
+  ViewSnapshot snap1 = ApplyChanges(&view, {doc1, doc2}, absl::nullopt).value();
+  ViewSnapshot snap2 = ApplyChanges(&view, {doc2prime}, absl::nullopt).value();
+  ViewSnapshot snap3 = ApplyChanges(&view, {doc3}, absl::nullopt).value();
+
+  queue->EnqueueBlocking([&] {
+    listener->OnViewSnapshot(snap1);
+    listener->OnViewSnapshot(snap2);
+    listener->OnViewSnapshot(snap3);
+  });
+
+  // Only the first snapshot is raised before the interval has passed.
+  ASSERT_THAT(accum, ElementsAre(snap1));
+
+  queue->RunScheduledOperationsUntil(TimerId::ListenerSnapshotInterval);
+
+  DocumentViewChange change3{doc2prime, DocumentViewChange::Type::Modified};
+  DocumentViewChange change4{doc3, DocumentViewChange::Type::Added};
+  ASSERT_EQ(2u, accum.size());
+  ASSERT_EQ(snap3.documents(), accum[1].documents());
+  ASSERT_EQ(snap2.old_documents(), accum[1].old_documents());
+  ASSERT_THAT(accum[1].document_changes(), ElementsAre(change4, change3));
+}
+
+TEST_F(QueryListenerTest, DropsDeferredSnapshotWhenCancelled) {
+  std::shared_ptr<AsyncQueue> queue = testutil::AsyncQueueForTesting();
+  std::vector<ViewSnapshot> accum;
+
+  Query query = testutil::Query("rooms");
+  MutableDocument doc1 = Doc("rooms/Eros", 1, Map("name", "Eros"));
+  MutableDocument doc2 = Doc("rooms/Hades", 2, Map("name", "Hades"));
+
+  ListenOptions options =
+      ListenOptions::DefaultOptions().WithMinSnapshotInterval(
+          std::chrono::hours(1));
+  auto listener = QueryListener::Create(query, options, Accumulating(&accum));
+  listener->set_worker_queue(queue);
+
+  View view(query, DocumentKeySet{});
+  ViewSnapshot snap1 = ApplyChanges(&view, {doc1}, absl::nullopt).value();
+  ViewSnapshot snap2 = ApplyChanges(&view, {doc2}, absl::nullopt).value();
+
+  queue->EnqueueBlocking([&] {
+    listener->OnViewSnapshot(snap1);
+    listener->OnViewSnapshot(snap2);
+    listener->CancelPendingSnapshot();
+  });
+
+  ASSERT_FALSE(queue->IsScheduled(TimerId::ListenerSnapshotInterval));
+  ASSERT_THAT(accum, ElementsAre(snap1));
+}
+
 }  // namespace core
 }  // namespace firestore
 }  // namespace firebase
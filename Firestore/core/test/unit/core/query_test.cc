@@ -1016,6 +1016,25 @@ TEST(QueryTest, CanonicalIDs) {
                                      "desc|lb:b:OAK1000|ub:a:SFO2000"));
 }
 
+TEST(QueryTest, CopiesShareCanonicalIdAndHash) {
+  auto query = testutil::Query("coll")
+                   .AddingFilter(testutil::Filter("str", "==", "foo"))
+                   .WithLimitToLast(3);
+  auto copy = query;
+
+  // The canonical ID is computed once and shared with copies.
+  EXPECT_EQ(&query.CanonicalId(), &copy.CanonicalId());
+  EXPECT_EQ(query.Hash(), copy.Hash());
+
+  // Equal queries built separately have equal hashes.
+  auto rebuilt = testutil::Query("coll")
+                     .AddingFilter(testutil::Filter("str", "==", "foo"))
+                     .WithLimitToLast(3);
+  EXPECT_EQ(query.Hash(), rebuilt.Hash());
+  EXPECT_EQ(query, rebuilt);
+  EXPECT_NE(query, query.WithLimitToLast(4));
+}
+
 TEST(QueryTest, MatchesAllDocuments) {
   auto base_query = testutil::Query("coll");
   EXPECT_TRUE(base_query.MatchesAllDocuments());
@@ -0,0 +1,326 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/core/sync_engine.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Firestore/core/include/firebase/firestore/firestore_errors.h"
+#include "Firestore/core/src/core/database_info.h"
+#include "Firestore/core/src/core/sync_engine_callback.h"
+#include "Firestore/core/src/core/view_snapshot.h"
+#include "Firestore/core/src/credentials/user.h"
+#include "Firestore/core/src/local/local_store.h"
+#include "Firestore/core/src/local/memory_persistence.h"
+#include "Firestore/core/src/local/query_engine.h"
+#include "Firestore/core/src/model/database_id.h"
+#include "Firestore/core/src/model/document_key.h"
+#include "Firestore/core/src/model/document_key_set.h"
+#include "Firestore/core/src/model/mutable_document.h"
+#include "Firestore/core/src/model/types.h"
+#include "Firestore/core/src/remote/existence_filter.h"
+#include "Firestore/core/src/remote/firebase_metadata_provider.h"
+#include "Firestore/core/src/remote/firebase_metadata_provider_noop.h"
+#include "Firestore/core/src/remote/remote_store.h"
+#include "Firestore/core/src/remote/watch_change.h"
+#include "Firestore/core/src/util/async_queue.h"
+#include "Firestore/core/src/util/status.h"
+#include "Firestore/core/test/unit/local/persistence_testing.h"
+#include "Firestore/core/test/unit/remote/create_noop_connectivity_monitor.h"
+#include "Firestore/core/test/unit/remote/fake_datastore.h"
+#include "Firestore/core/test/unit/testutil/async_testing.h"
+#include "Firestore/core/test/unit/testutil/testutil.h"
+#include "absl/memory/memory.h"
+#include "absl/types/optional.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace firestore {
+namespace core {
+namespace {
+
+using credentials::User;
+using local::LocalStore;
+using local::Persistence;
+using local::QueryEngine;
+using model::DatabaseId;
+using model::DocumentKey;
+using model::DocumentKeySet;
+using model::MutableDocument;
+using model::OnlineState;
+using model::TargetId;
+using remote::ConnectivityMonitor;
+using remote::DocumentWatchChange;
+using remote::ExistenceFilter;
+using remote::ExistenceFilterWatchChange;
+using remote::FakeDatastore;
+using remote::FakeWatchStream;
+using remote::FirebaseMetadataProvider;
+using remote::RemoteStore;
+using remote::WatchTargetChange;
+using remote::WatchTargetChangeState;
+using util::AsyncQueue;
+using util::Status;
+
+using testutil::Doc;
+using testutil::Key;
+using testutil::Map;
+using testutil::Version;
+
+/** Records the view snapshots and errors raised by the `SyncEngine`. */
+class SnapshotCapture : public SyncEngineCallback {
+ public:
+  void HandleOnlineStateChange(OnlineState) override {
+  }
+
+  void OnViewSnapshots(std::vector<ViewSnapshot>&& snapshots) override {
+    for (ViewSnapshot& snapshot : snapshots) {
+      this->snapshots.push_back(std::move(snapshot));
+    }
+  }
+
+  void OnError(const Query&, const Status& error) override {
+    errors.push_back(error);
+  }
+
+  std::vector<ViewSnapshot> snapshots;
+  std::vector<Status> errors;
+};
+
+class SyncEngineTest : public testing::Test {
+ public:
+  SyncEngineTest()
+      : database_info_{DatabaseId{"p", "d"}, "", "localhost", false},
+        worker_queue_{testutil::AsyncQueueForTesting()},
+        persistence_{local::MemoryPersistenceWithEagerGcForTesting()},
+        local_store_{persistence_.get(), &query_engine_,
+                     User::Unauthenticated()},
+        connectivity_monitor_{remote::CreateNoOpConnectivityMonitor()},
+        firebase_metadata_provider_{
+            remote::CreateFirebaseMetadataProviderNoOp()},
+        datastore_{std::make_shared<FakeDatastore>(
+            database_info_, worker_queue_, connectivity_monitor_.get(),
+            firebase_metadata_provider_.get())} {
+  }
+
+  ~SyncEngineTest() override {
+    worker_queue_->EnqueueBlocking([&] {
+      if (remote_store_) {
+        remote_store_->Shutdown();
+      }
+    });
+  }
+
+ protected:
+  void StartSyncEngine(size_t max_documents_per_limbo_target) {
+    local_store_.Start();
+    remote_store_ = absl::make_unique<RemoteStore>(
+        &local_store_, datastore_, worker_queue_, connectivity_monitor_.get(),
+        [this](OnlineState online_state) {
+          sync_engine_->HandleOnlineStateChange(online_state);
+        });
+    sync_engine_ = absl::make_unique<SyncEngine>(
+        &local_store_, remote_store_.get(), User::Unauthenticated(),
+        /* max_concurrent_limbo_resolutions= */ 100,
+        max_documents_per_limbo_target);
+    remote_store_->set_sync_engine(sync_engine_.get());
+    sync_engine_->SetCallback(&capture_);
+    remote_store_->Start();
+  }
+
+  /**
+   * Listens to "coll" and syncs `paths` into its view, then resets the query's
+   * target without resending them, which puts all of them in limbo.
+   */
+  void PutDocumentsInLimbo(const std::vector<std::string>& paths) {
+    query_target_id_ = sync_engine_->Listen(testutil::Query("coll"));
+    SendTargetChange(WatchTargetChangeState::Added, query_target_id_);
+    for (const std::string& path : paths) {
+      SendDocument(query_target_id_, Doc(path, 1000, Map()));
+    }
+    SendTargetChange(WatchTargetChangeState::Current, query_target_id_);
+    SendSnapshot(1000);
+
+    SendTargetChange(WatchTargetChangeState::Reset, query_target_id_);
+    SendTargetChange(WatchTargetChangeState::Current, query_target_id_);
+    SendSnapshot(2000);
+  }
+
+  FakeWatchStream* watch_stream() {
+    return datastore_->watch_stream();
+  }
+
+  void SendTargetChange(WatchTargetChangeState state, TargetId target_id) {
+    watch_stream()->SendWatchChange(WatchTargetChange{state, {target_id}});
+  }
+
+  void SendDocument(TargetId target_id, const MutableDocument& document) {
+    watch_stream()->SendWatchChange(
+        DocumentWatchChange{{target_id}, {}, document.key(), document});
+  }
+
+  void SendSnapshot(int64_t version) {
+    watch_stream()->SendWatchChange(
+        WatchTargetChange{WatchTargetChangeState::NoChange, {}},
+        Version(version));
+  }
+
+  /** Returns the keys the watch stream was asked to listen to for a target. */
+  DocumentKeySet WatchedKeys(TargetId target_id) {
+    return watch_stream()
+        ->active_targets()
+        .at(target_id)
+        .target()
+        .GetDocumentKeys();
+  }
+
+  /** Returns the keys of the documents in the most recent view snapshot. */
+  std::vector<DocumentKey> LatestDocumentKeys() {
+    std::vector<DocumentKey> keys;
+    for (const auto& document : capture_.snapshots.back().documents()) {
+      keys.push_back(document->key());
+    }
+    return keys;
+  }
+
+  DatabaseInfo database_info_;
+  std::shared_ptr<AsyncQueue> worker_queue_;
+  std::unique_ptr<Persistence> persistence_;
+  QueryEngine query_engine_;
+  LocalStore local_store_;
+  std::unique_ptr<ConnectivityMonitor> connectivity_monitor_;
+  std::unique_ptr<FirebaseMetadataProvider> firebase_metadata_provider_;
+  std::shared_ptr<FakeDatastore> datastore_;
+  std::unique_ptr<RemoteStore> remote_store_;
+  std::unique_ptr<SyncEngine> sync_engine_;
+  SnapshotCapture capture_;
+  TargetId query_target_id_ = 0;
+};
+
+TEST_F(SyncEngineTest, GroupsLimboDocumentsIntoTargets) {
+  worker_queue_->EnqueueBlocking([&] {
+    StartSyncEngine(2);
+    PutDocumentsInLimbo({"coll/a", "coll/b", "coll/c"});
+
+    std::map<DocumentKey, TargetId> limbo =
+        sync_engine_->GetActiveLimboDocumentResolutions();
+    ASSERT_EQ(limbo.size(), 3u);
+    TargetId first = limbo.at(Key("coll/a"));
+    TargetId second = limbo.at(Key("coll/c"));
+    EXPECT_EQ(limbo.at(Key("coll/b")), first);
+    EXPECT_NE(first, second);
+
+    EXPECT_EQ(WatchedKeys(first),
+              (DocumentKeySet{Key("coll/a"), Key("coll/b")}));
+    EXPECT_EQ(WatchedKeys(second), DocumentKeySet{Key("coll/c")});
+  });
+}
+
+TEST_F(SyncEngineTest, SynthesizesDeleteForEachMissingLimboDocument) {
+  worker_queue_->EnqueueBlocking([&] {
+    StartSyncEngine(3);
+    PutDocumentsInLimbo({"coll/a", "coll/b", "coll/c"});
+    TargetId limbo_target_id =
+        sync_engine_->GetActiveLimboDocumentResolutions().at(Key("coll/a"));
+    EXPECT_EQ(WatchedKeys(limbo_target_id),
+              (DocumentKeySet{Key("coll/a"), Key("coll/b"), Key("coll/c")}));
+
+    // Only "coll/b" still exists: the other two are deleted.
+    SendTargetChange(WatchTargetChangeState::Added, limbo_target_id);
+    SendDocument(limbo_target_id, Doc("coll/b", 3000, Map()));
+    SendTargetChange(WatchTargetChangeState::Current, limbo_target_id);
+    SendSnapshot(3000);
+
+    EXPECT_EQ(LatestDocumentKeys(), std::vector<DocumentKey>{Key("coll/b")});
+    std::map<DocumentKey, TargetId> limbo =
+        sync_engine_->GetActiveLimboDocumentResolutions();
+    ASSERT_EQ(limbo.size(), 1u);
+    EXPECT_EQ(limbo.at(Key("coll/b")), limbo_target_id);
+    EXPECT_EQ(watch_stream()->active_targets().count(limbo_target_id), 1u);
+
+    // The limbo target is released once its last document leaves limbo.
+    SendDocument(query_target_id_, Doc("coll/b", 3000, Map()));
+    SendSnapshot(4000);
+
+    EXPECT_TRUE(sync_engine_->GetActiveLimboDocumentResolutions().empty());
+    EXPECT_EQ(watch_stream()->active_targets().count(limbo_target_id), 0u);
+  });
+}
+
+TEST_F(SyncEngineTest, ResetsLimboTargetOnExistenceFilterMismatch) {
+  worker_queue_->EnqueueBlocking([&] {
+    StartSyncEngine(3);
+    PutDocumentsInLimbo({"coll/a", "coll/b", "coll/c"});
+    TargetId limbo_target_id =
+        sync_engine_->GetActiveLimboDocumentResolutions().at(Key("coll/a"));
+
+    SendTargetChange(WatchTargetChangeState::Added, limbo_target_id);
+    SendDocument(limbo_target_id, Doc("coll/a", 3000, Map()));
+    SendDocument(limbo_target_id, Doc("coll/b", 3000, Map()));
+    SendTargetChange(WatchTargetChangeState::Current, limbo_target_id);
+    SendSnapshot(3000);
+    EXPECT_EQ(LatestDocumentKeys(),
+              (std::vector<DocumentKey>{Key("coll/a"), Key("coll/b")}));
+    EXPECT_EQ(watch_stream()->watch_count(limbo_target_id), 1);
+
+    // The backend only counts one of the two documents it sent, so the target
+    // is listened to again from scratch.
+    watch_stream()->SendWatchChange(ExistenceFilterWatchChange{
+        ExistenceFilter{1, absl::nullopt}, limbo_target_id});
+    SendSnapshot(4000);
+    EXPECT_EQ(watch_stream()->watch_count(limbo_target_id), 2);
+
+    // The new listen no longer returns "coll/b".
+    SendTargetChange(WatchTargetChangeState::Removed, limbo_target_id);
+    SendTargetChange(WatchTargetChangeState::Added, limbo_target_id);
+    SendDocument(limbo_target_id, Doc("coll/a", 5000, Map()));
+    SendTargetChange(WatchTargetChangeState::Current, limbo_target_id);
+    SendSnapshot(5000);
+
+    EXPECT_EQ(LatestDocumentKeys(), std::vector<DocumentKey>{Key("coll/a")});
+    std::map<DocumentKey, TargetId> limbo =
+        sync_engine_->GetActiveLimboDocumentResolutions();
+    ASSERT_EQ(limbo.size(), 1u);
+    EXPECT_EQ(limbo.at(Key("coll/a")), limbo_target_id);
+  });
+}
+
+TEST_F(SyncEngineTest, DeletesAllDocumentsOfRejectedLimboTarget) {
+  worker_queue_->EnqueueBlocking([&] {
+    StartSyncEngine(3);
+    PutDocumentsInLimbo({"coll/a", "coll/b", "coll/c"});
+    TargetId limbo_target_id =
+        sync_engine_->GetActiveLimboDocumentResolutions().at(Key("coll/a"));
+
+    watch_stream()->SendWatchChange(WatchTargetChange{
+        WatchTargetChangeState::Removed,
+        {limbo_target_id},
+        Status{Error::kErrorPermissionDenied, "Permission denied"}});
+
+    EXPECT_TRUE(sync_engine_->GetActiveLimboDocumentResolutions().empty());
+    EXPECT_TRUE(LatestDocumentKeys().empty());
+    EXPECT_TRUE(capture_.errors.empty());
+  });
+}
+
+}  // namespace
+}  // namespace core
+}  // namespace firestore
+}  // namespace firebase
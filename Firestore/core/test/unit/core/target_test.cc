@@ -17,6 +17,8 @@
 #include "Firestore/core/src/core/target.h"
 
 #include <cmath>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include "Firestore/core/src/core/bound.h"
 #include "Firestore/core/src/core/query.h"
@@ -55,6 +57,7 @@ using testutil::DbId;
 using testutil::Doc;
 using testutil::Field;
 using testutil::Filter;
+using testutil::Key;
 using testutil::MakeFieldIndex;
 using testutil::Map;
 using testutil::OrderBy;
@@ -357,6 +360,50 @@ TEST(TargetTest, PartialIndexMatchQueryBound) {
   VerifyBound(upper_bound, true, {*Value("a")});
 }
 
+TEST(TargetTest, SingleDocumentTargetMatchesDocumentQuery) {
+  Target target = Target::ForDocuments(model::DocumentKeySet{Key("c/a")});
+
+  EXPECT_EQ(target, Query("c/a").ToTarget());
+  EXPECT_EQ(target.CanonicalId(), Query("c/a").ToTarget().CanonicalId());
+  EXPECT_EQ(target.GetDocumentKeys(), model::DocumentKeySet{Key("c/a")});
+}
+
+TEST(TargetTest, MultiDocumentTarget) {
+  model::DocumentKeySet keys{Key("c/b"), Key("c/a"), Key("d/c/e/f")};
+  Target target = Target::ForDocuments(keys);
+
+  EXPECT_TRUE(target.IsDocumentQuery());
+  EXPECT_EQ(target.path(), Key("c/a").path());
+  EXPECT_EQ(target.GetDocumentKeys(), keys);
+
+  EXPECT_NE(target, Query("c/a").ToTarget());
+  EXPECT_NE(target.CanonicalId(), Query("c/a").ToTarget().CanonicalId());
+  EXPECT_EQ(target, Target::ForDocuments(keys));
+  EXPECT_EQ(target.CanonicalId(), Target::ForDocuments(keys).CanonicalId());
+}
+
+TEST(TargetTest, CopiesComputeHashOnceAcrossThreads) {
+  Target target = Query("coll")
+                      .AddingFilter(Filter("a", "==", 1))
+                      .WithLimitToFirst(2)
+                      .ToTarget();
+  std::vector<Target> copies(4, target);
+
+  std::vector<size_t> hashes(copies.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < copies.size(); ++i) {
+    threads.emplace_back([&, i] { hashes[i] = copies[i].Hash(); });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t hash : hashes) {
+    EXPECT_EQ(hash, target.Hash());
+  }
+  EXPECT_EQ(&target.CanonicalId(), &copies[0].CanonicalId());
+}
+
 }  // namespace
 }  // namespace core
 }  // namespace firestore
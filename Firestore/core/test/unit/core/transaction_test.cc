@@ -0,0 +1,283 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/core/transaction.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Firestore/core/include/firebase/firestore/firestore_errors.h"
+#include "Firestore/core/src/core/database_info.h"
+#include "Firestore/core/src/model/database_id.h"
+#include "Firestore/core/src/model/document.h"
+#include "Firestore/core/src/model/document_key.h"
+#include "Firestore/core/src/remote/datastore.h"
+#include "Firestore/core/src/remote/firebase_metadata_provider.h"
+#include "Firestore/core/src/remote/firebase_metadata_provider_noop.h"
+#include "Firestore/core/src/util/async_queue.h"
+#include "Firestore/core/src/util/status.h"
+#include "Firestore/core/src/util/statusor.h"
+#include "Firestore/core/test/unit/remote/create_noop_connectivity_monitor.h"
+#include "Firestore/core/test/unit/remote/fake_credentials_provider.h"
+#include "Firestore/core/test/unit/testutil/async_testing.h"
+#include "Firestore/core/test/unit/testutil/testutil.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace firestore {
+namespace core {
+namespace {
+
+using credentials::AuthToken;
+using credentials::User;
+using model::DatabaseId;
+using model::Document;
+using model::DocumentKey;
+using remote::ConnectivityMonitor;
+using remote::CreateFirebaseMetadataProviderNoOp;
+using remote::CreateNoOpConnectivityMonitor;
+using remote::Datastore;
+using remote::FakeCredentialsProvider;
+using remote::FirebaseMetadataProvider;
+using testing::ElementsAre;
+using testing::UnorderedElementsAre;
+using testutil::DeletedDoc;
+using testutil::Doc;
+using testutil::Key;
+using util::AsyncQueue;
+using util::Status;
+using util::StatusOr;
+
+using LookupResult = StatusOr<std::vector<Document>>;
+
+/** Records lookups instead of sending them, so tests can answer them. */
+class FakeDatastore : public Datastore {
+ public:
+  using Datastore::Datastore;
+
+  void LookupDocuments(const std::vector<DocumentKey>& keys,
+                       LookupCallback&& callback) override {
+    requests.push_back(keys);
+    callbacks.push_back(std::move(callback));
+  }
+
+  std::vector<std::vector<DocumentKey>> requests;
+  std::vector<LookupCallback> callbacks;
+};
+
+class TransactionTest : public testing::Test {
+ public:
+  TransactionTest()
+      : database_info{DatabaseId{"p", "d"}, "", "localhost", false},
+        worker_queue{testutil::AsyncQueueForTesting()},
+        connectivity_monitor{CreateNoOpConnectivityMonitor()},
+        firebase_metadata_provider{CreateFirebaseMetadataProviderNoOp()},
+        datastore{std::make_shared<FakeDatastore>(
+            database_info,
+            worker_queue,
+            std::make_shared<FakeCredentialsProvider<AuthToken, User>>(),
+            std::make_shared<
+                FakeCredentialsProvider<std::string, std::string>>(),
+            connectivity_monitor.get(),
+            firebase_metadata_provider.get())} {
+  }
+
+  ~TransactionTest() override {
+    datastore->Shutdown();
+    // Ensure that nothing remains on the AsyncQueue before destroying it.
+    worker_queue->EnqueueBlocking([] {});
+  }
+
+  std::shared_ptr<Transaction> CreateTransaction() {
+    return std::make_shared<Transaction>(datastore, worker_queue);
+  }
+
+  /**
+   * Issues a lookup whose result is appended to `results`. Must be called on
+   * the worker queue.
+   */
+  void Lookup(const std::shared_ptr<Transaction>& transaction,
+              const std::vector<DocumentKey>& keys) {
+    transaction->Lookup(keys, [this](const LookupResult& result) {
+      results.push_back(result);
+    });
+  }
+
+  /**
+   * Lets the lookups issued so far join a batch and sends it: a lookup hops to
+   * the worker queue once to join the batch, and the batch is sent in the
+   * following turn.
+   */
+  void FlushLookups() {
+    worker_queue->EnqueueBlocking([] {});
+    worker_queue->EnqueueBlocking([] {});
+  }
+
+  /** Answers a request, releasing the callback the way `Datastore` does. */
+  void Respond(size_t request, const LookupResult& result) {
+    worker_queue->EnqueueBlocking([&] {
+      Datastore::LookupCallback callback =
+          std::move(datastore->callbacks.at(request));
+      datastore->callbacks.at(request) = nullptr;
+      callback(result);
+    });
+  }
+
+  DatabaseInfo database_info;
+  std::shared_ptr<AsyncQueue> worker_queue;
+  std::unique_ptr<ConnectivityMonitor> connectivity_monitor;
+  std::unique_ptr<FirebaseMetadataProvider> firebase_metadata_provider;
+  std::shared_ptr<FakeDatastore> datastore;
+
+  std::vector<LookupResult> results;
+};
+
+TEST_F(TransactionTest, BatchesLookupsIssuedTogether) {
+  std::shared_ptr<Transaction> transaction = CreateTransaction();
+  worker_queue->EnqueueBlocking([&] {
+    Lookup(transaction, {Key("coll/a")});
+    Lookup(transaction, {Key("coll/b")});
+  });
+  FlushLookups();
+
+  ASSERT_EQ(datastore->requests.size(), 1u);
+  EXPECT_THAT(datastore->requests[0],
+              UnorderedElementsAre(Key("coll/a"), Key("coll/b")));
+
+  Respond(0, std::vector<Document>{Doc("coll/a", 1), DeletedDoc("coll/b", 2)});
+
+  ASSERT_EQ(results.size(), 2u);
+  ASSERT_TRUE(results[0].ok());
+  EXPECT_THAT(results[0].ValueOrDie(), ElementsAre(Doc("coll/a", 1)));
+  ASSERT_TRUE(results[1].ok());
+  EXPECT_THAT(results[1].ValueOrDie(), ElementsAre(DeletedDoc("coll/b", 2)));
+}
+
+TEST_F(TransactionTest, ServesRepeatedReadsFromReadCache) {
+  std::shared_ptr<Transaction> transaction = CreateTransaction();
+  worker_queue->EnqueueBlocking([&] { Lookup(transaction, {Key("coll/a")}); });
+  FlushLookups();
+  Respond(0, std::vector<Document>{Doc("coll/a", 1)});
+
+  worker_queue->EnqueueBlocking([&] { Lookup(transaction, {Key("coll/a")}); });
+  FlushLookups();
+
+  EXPECT_EQ(datastore->requests.size(), 1u);
+  ASSERT_EQ(results.size(), 2u);
+  ASSERT_TRUE(results[1].ok());
+  EXPECT_THAT(results[1].ValueOrDie(), ElementsAre(Doc("coll/a", 1)));
+}
+
+TEST_F(TransactionTest, PrefetchServesSequentialReadsOfRetriedAttempt) {
+  // The first attempt reads its documents one after another.
+  std::shared_ptr<Transaction> first_attempt = CreateTransaction();
+  worker_queue->EnqueueBlocking(
+      [&] { Lookup(first_attempt, {Key("coll/a")}); });
+  FlushLookups();
+  Respond(0, std::vector<Document>{Doc("coll/a", 1)});
+  worker_queue->EnqueueBlocking(
+      [&] { Lookup(first_attempt, {Key("coll/b")}); });
+  FlushLookups();
+  Respond(1, std::vector<Document>{Doc("coll/b", 1)});
+  ASSERT_EQ(datastore->requests.size(), 2u);
+  EXPECT_THAT(first_attempt->GetReadKeys(),
+              UnorderedElementsAre(Key("coll/a"), Key("coll/b")));
+
+  // The retried attempt fetches the previous read set with one request, and
+  // the same sequential reads don't cause any more requests.
+  std::shared_ptr<Transaction> second_attempt = CreateTransaction();
+  worker_queue->EnqueueBlocking([&] {
+    second_attempt->Prefetch(first_attempt->GetReadKeys());
+    Lookup(second_attempt, {Key("coll/a")});
+  });
+  FlushLookups();
+  ASSERT_EQ(datastore->requests.size(), 3u);
+  EXPECT_THAT(datastore->requests[2],
+              UnorderedElementsAre(Key("coll/a"), Key("coll/b")));
+  EXPECT_EQ(results.size(), 2u);
+
+  Respond(2, std::vector<Document>{Doc("coll/a", 2), Doc("coll/b", 2)});
+  ASSERT_EQ(results.size(), 3u);
+  ASSERT_TRUE(results[2].ok());
+  EXPECT_THAT(results[2].ValueOrDie(), ElementsAre(Doc("coll/a", 2)));
+
+  worker_queue->EnqueueBlocking(
+      [&] { Lookup(second_attempt, {Key("coll/b")}); });
+  FlushLookups();
+  EXPECT_EQ(datastore->requests.size(), 3u);
+  ASSERT_EQ(results.size(), 4u);
+  ASSERT_TRUE(results[3].ok());
+  EXPECT_THAT(results[3].ValueOrDie(), ElementsAre(Doc("coll/b", 2)));
+}
+
+TEST_F(TransactionTest, FailedPrefetchFallsBackToLookup) {
+  std::shared_ptr<Transaction> transaction = CreateTransaction();
+  worker_queue->EnqueueBlocking([&] {
+    transaction->Prefetch({Key("coll/a")});
+    Lookup(transaction, {Key("coll/a")});
+  });
+  FlushLookups();
+  ASSERT_EQ(datastore->requests.size(), 1u);
+
+  Respond(0, Status(Error::kErrorUnavailable, "Unavailable"));
+  FlushLookups();
+  ASSERT_EQ(datastore->requests.size(), 2u);
+  EXPECT_THAT(datastore->requests[1], ElementsAre(Key("coll/a")));
+  EXPECT_TRUE(results.empty());
+
+  Respond(1, std::vector<Document>{Doc("coll/a", 1)});
+  ASSERT_EQ(results.size(), 1u);
+  EXPECT_TRUE(results[0].ok());
+}
+
+TEST_F(TransactionTest, FailsLookupsForKeysMissingFromResponse) {
+  std::shared_ptr<Transaction> transaction = CreateTransaction();
+  worker_queue->EnqueueBlocking([&] {
+    Lookup(transaction, {Key("coll/a"), Key("coll/b")});
+    Lookup(transaction, {Key("coll/a")});
+  });
+  FlushLookups();
+  ASSERT_EQ(datastore->requests.size(), 1u);
+
+  Respond(0, std::vector<Document>{Doc("coll/a", 1)});
+
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_EQ(results[0].status().code(), Error::kErrorInternal);
+  ASSERT_TRUE(results[1].ok());
+  EXPECT_THAT(results[1].ValueOrDie(), ElementsAre(Doc("coll/a", 1)));
+}
+
+TEST_F(TransactionTest, KeepsTransactionAliveUntilLookupCompletes) {
+  std::shared_ptr<Transaction> transaction = CreateTransaction();
+  std::weak_ptr<Transaction> weak_transaction = transaction;
+  worker_queue->EnqueueBlocking([&] { Lookup(transaction, {Key("coll/a")}); });
+  transaction.reset();
+  FlushLookups();
+  EXPECT_FALSE(weak_transaction.expired());
+
+  Respond(0, std::vector<Document>{Doc("coll/a", 1)});
+  ASSERT_EQ(results.size(), 1u);
+  EXPECT_TRUE(results[0].ok());
+  EXPECT_TRUE(weak_transaction.expired());
+}
+
+}  // namespace
+}  // namespace core
+}  // namespace firestore
+}  // namespace firebase
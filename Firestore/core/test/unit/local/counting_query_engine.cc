@@ -185,6 +185,16 @@ model::MutableDocumentMap WrappedRemoteDocumentCache::GetAll(
   return result;
 }
 
+model::MutableDocumentMap WrappedRemoteDocumentCache::GetDocumentsInCollection(
+    const model::ResourcePath& collection,
+    const absl::optional<model::DocumentKey>& start_after,
+    size_t limit) const {
+  auto result =
+      subject_->GetDocumentsInCollection(collection, start_after, limit);
+  query_engine_->documents_read_by_query_ += result.size();
+  return result;
+}
+
 model::MutableDocumentMap WrappedRemoteDocumentCache::GetDocumentsMatchingQuery(
     const core::Query& query,
     const model::IndexOffset& offset,
@@ -240,6 +250,19 @@ OverlayByDocumentKeyMap WrappedDocumentOverlayCache::GetOverlays(
   return result;
 }
 
+OverlayByDocumentKeyMap WrappedDocumentOverlayCache::GetOverlaysInRange(
+    const model::ResourcePath& collection,
+    const absl::optional<model::DocumentKey>& start_after,
+    const absl::optional<model::DocumentKey>& end_at) const {
+  auto result = subject_->GetOverlaysInRange(collection, start_after, end_at);
+  query_engine_->overlays_read_by_collection_ += result.size();
+  for (const auto& r : result) {
+    query_engine_->overlay_types_.emplace(r.first, r.second.mutation().type());
+  }
+
+  return result;
+}
+
 OverlayByDocumentKeyMap WrappedDocumentOverlayCache::GetOverlays(
     absl::string_view collection_group,
     int since_batch_id,
@@ -253,6 +276,15 @@ OverlayByDocumentKeyMap WrappedDocumentOverlayCache::GetOverlays(
   return result;
 }
 
+bool WrappedDocumentOverlayCache::HasOverlays(
+    const model::ResourcePath& collection) const {
+  return subject_->HasOverlays(collection);
+}
+
+bool WrappedDocumentOverlayCache::HasAnyOverlays() const {
+  return subject_->HasAnyOverlays();
+}
+
 int WrappedDocumentOverlayCache::GetOverlayCount() const {
   HARD_FAIL("WrappedDocumentOverlayCache::GetOverlayCount() not implemented");
 }
@@ -59,6 +59,11 @@ class CountingQueryEngine : public QueryEngine {
 
   void Initialize(LocalDocumentsView* local_document) override;
 
+  /** Returns the view over the counting caches. */
+  LocalDocumentsView* local_documents() const {
+    return local_documents_.get();
+  }
+
   /**
    * Returns the number of documents returned by the RemoteDocumentCache's
    * `GetAll()` API (since the last call to `ResetCounts()`)
@@ -196,6 +201,11 @@ class WrappedRemoteDocumentCache : public RemoteDocumentCache {
                                    const model::IndexOffset& offset,
                                    size_t limit) const override;
 
+  model::MutableDocumentMap GetDocumentsInCollection(
+      const model::ResourcePath& collection,
+      const absl::optional<model::DocumentKey>& start_after,
+      size_t limit) const override;
+
   model::MutableDocumentMap GetDocumentsMatchingQuery(
       const core::Query& query,
       const model::IndexOffset& offset,
@@ -238,10 +248,19 @@ class WrappedDocumentOverlayCache final : public DocumentOverlayCache {
   model::OverlayByDocumentKeyMap GetOverlays(
       const model::ResourcePath& collection, int since_batch_id) const override;
 
+  model::OverlayByDocumentKeyMap GetOverlaysInRange(
+      const model::ResourcePath& collection,
+      const absl::optional<model::DocumentKey>& start_after,
+      const absl::optional<model::DocumentKey>& end_at) const override;
+
   model::OverlayByDocumentKeyMap GetOverlays(absl::string_view collection_group,
                                              int since_batch_id,
                                              std::size_t count) const override;
 
+  bool HasOverlays(const model::ResourcePath& collection) const override;
+
+  bool HasAnyOverlays() const override;
+
  private:
   int GetOverlayCount() const override;
 
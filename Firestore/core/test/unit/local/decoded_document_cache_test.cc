@@ -0,0 +1,93 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/decoded_document_cache.h"
+
+#include "Firestore/core/src/model/mutable_document.h"
+#include "Firestore/core/test/unit/testutil/testutil.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+namespace {
+
+using model::MutableDocument;
+using testutil::Doc;
+using testutil::Field;
+using testutil::Key;
+using testutil::Map;
+using testutil::Value;
+
+TEST(DecodedDocumentCacheTest, ReturnsCachedDocuments) {
+  DecodedDocumentCache cache;
+  MutableDocument doc = Doc("coll/a", 1, Map("value", 1));
+  cache.Put(doc, 10);
+
+  EXPECT_EQ(cache.Get(Key("coll/a")), doc);
+  EXPECT_EQ(cache.Get(Key("coll/b")), absl::nullopt);
+  EXPECT_EQ(cache.stats().hits, 1);
+  EXPECT_EQ(cache.stats().misses, 1);
+}
+
+TEST(DecodedDocumentCacheTest, ReturnsCopies) {
+  DecodedDocumentCache cache;
+  cache.Put(Doc("coll/a", 1, Map("value", 1)), 10);
+
+  MutableDocument copy = *cache.Get(Key("coll/a"));
+  copy.data().Set(Field("value"), Value(2));
+
+  EXPECT_EQ(cache.Get(Key("coll/a")), Doc("coll/a", 1, Map("value", 1)));
+}
+
+TEST(DecodedDocumentCacheTest, InvalidatesDocuments) {
+  DecodedDocumentCache cache;
+  cache.Put(Doc("coll/a", 1, Map()), 10);
+  cache.Invalidate(Key("coll/a"));
+
+  EXPECT_EQ(cache.Get(Key("coll/a")), absl::nullopt);
+  EXPECT_EQ(cache.byte_size(), 0u);
+}
+
+TEST(DecodedDocumentCacheTest, EvictsLeastRecentlyUsedDocuments) {
+  DecodedDocumentCache cache(30);
+  cache.Put(Doc("coll/a", 1, Map()), 10);
+  cache.Put(Doc("coll/b", 1, Map()), 10);
+  cache.Put(Doc("coll/c", 1, Map()), 10);
+
+  // Reading `a` makes `b` the least recently used document.
+  EXPECT_NE(cache.Get(Key("coll/a")), absl::nullopt);
+  cache.Put(Doc("coll/d", 1, Map()), 10);
+
+  EXPECT_EQ(cache.Get(Key("coll/b")), absl::nullopt);
+  EXPECT_NE(cache.Get(Key("coll/a")), absl::nullopt);
+  EXPECT_NE(cache.Get(Key("coll/c")), absl::nullopt);
+  EXPECT_NE(cache.Get(Key("coll/d")), absl::nullopt);
+  EXPECT_EQ(cache.byte_size(), 30u);
+}
+
+TEST(DecodedDocumentCacheTest, SkipsDocumentsLargerThanCapacity) {
+  DecodedDocumentCache cache(10);
+  cache.Put(Doc("coll/a", 1, Map()), 11);
+
+  EXPECT_EQ(cache.Get(Key("coll/a")), absl::nullopt);
+  EXPECT_EQ(cache.byte_size(), 0u);
+}
+
+}  // namespace
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
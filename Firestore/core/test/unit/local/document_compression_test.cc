@@ -0,0 +1,101 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/document_compression.h"
+
+#include <string>
+#include <vector>
+
+#include "Firestore/core/src/local/local_serializer.h"
+#include "Firestore/core/src/nanopb/message.h"
+#include "Firestore/core/test/unit/local/persistence_testing.h"
+#include "Firestore/core/test/unit/testutil/testutil.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+namespace {
+
+using nanopb::MakeStdString;
+using testutil::Doc;
+using testutil::Map;
+
+std::string EncodedDocument(const std::string& id) {
+  LocalSerializer serializer = MakeLocalSerializer();
+  return MakeStdString(serializer.EncodeMaybeDocument(
+      Doc("users/" + id, 1,
+          Map("display_name", "user " + id, "status", "active", "country",
+              "Switzerland", "preferred_language", "English"))));
+}
+
+TEST(DocumentCompressionTest, RoundTripsDocuments) {
+  std::string dictionary = BuildCompressionDictionary(
+      {EncodedDocument("a"), EncodedDocument("b"), EncodedDocument("c")});
+  std::string encoded = EncodedDocument("d");
+
+  absl::optional<std::string> compressed =
+      CompressDocument(encoded, dictionary);
+  ASSERT_TRUE(compressed.has_value());
+  EXPECT_LT(compressed->size(), encoded.size());
+  EXPECT_TRUE(IsCompressedDocument(*compressed));
+  EXPECT_FALSE(IsCompressedDocument(encoded));
+
+  util::StatusOr<std::string> decompressed =
+      DecompressDocument(*compressed, dictionary);
+  ASSERT_TRUE(decompressed.ok());
+  EXPECT_EQ(decompressed.ValueOrDie(), encoded);
+}
+
+TEST(DocumentCompressionTest, KeepsDocumentsThatDoNotShrink) {
+  EXPECT_EQ(CompressDocument("\x12\x01x", ""), absl::nullopt);
+}
+
+TEST(DocumentCompressionTest, FailsWithWrongDictionary) {
+  std::string dictionary = BuildCompressionDictionary({EncodedDocument("a")});
+  absl::optional<std::string> compressed =
+      CompressDocument(EncodedDocument("b"), dictionary);
+  ASSERT_TRUE(compressed.has_value());
+
+  EXPECT_FALSE(DecompressDocument(*compressed, "other dictionary").ok());
+  EXPECT_FALSE(DecompressDocument(compressed->substr(0, 4), dictionary).ok());
+}
+
+TEST(DocumentCompressionTest, RejectsOversizedDocuments) {
+  std::string dictionary = BuildCompressionDictionary({EncodedDocument("a")});
+  EXPECT_EQ(CompressDocument(std::string(kMaxCompressedDocumentSize + 1, 'a'),
+                             dictionary),
+            absl::nullopt);
+
+  // A compression marker followed by a decompressed size of 2^32 - 1 bytes.
+  std::string stored("\x00\xff\xff\xff\xff\x0f", 6);
+  EXPECT_FALSE(DecompressDocument(stored, dictionary).ok());
+}
+
+TEST(DocumentCompressionTest, LimitsDictionarySize) {
+  std::vector<std::string> samples(
+      2, std::string(kMaxCompressionDictionarySize, 'a'));
+  samples.push_back("end");
+
+  std::string dictionary = BuildCompressionDictionary(samples);
+  EXPECT_EQ(dictionary.size(), kMaxCompressionDictionarySize);
+  EXPECT_EQ(dictionary.substr(dictionary.size() - 3), "end");
+}
+
+}  // namespace
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
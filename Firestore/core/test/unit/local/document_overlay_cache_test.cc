@@ -188,6 +188,29 @@ TEST_P(DocumentOverlayCacheTest, CanReadSavedOverlaysInBatches) {
   });
 }
 
+TEST_P(DocumentOverlayCacheTest, BatchLookupSkipsSubcollectionOverlays) {
+  this->persistence_->Run("BatchLookupSkipsSubcollectionOverlays", [&] {
+    auto m1 = SetMutation("coll/a/sub/x", Map("x", 1));
+    auto m2 = SetMutation("coll/b", Map("b", 2));
+    auto m3 = SetMutation("coll/b/sub/y", Map("y", 3));
+    auto m4 = SetMutation("coll/d", Map("d", 4));
+    this->SaveOverlaysWithMutations(1, {m1, m2});
+    this->SaveOverlaysWithMutations(2, {m3, m4});
+
+    model::OverlayByDocumentKeyMap result;
+    const auto lookup = std::set<DocumentKey>{
+        testutil::Key("coll/a"), testutil::Key("coll/b"),
+        testutil::Key("coll/c"), testutil::Key("coll/d"),
+        testutil::Key("coll/e")};
+    this->cache_->GetOverlays(result, lookup);
+    ASSERT_EQ(result.size(), 2u);
+    EXPECT_EQ(m2, result[testutil::Key("coll/b")].mutation());
+    EXPECT_EQ(1, result[testutil::Key("coll/b")].largest_batch_id());
+    EXPECT_EQ(m4, result[testutil::Key("coll/d")].mutation());
+    EXPECT_EQ(2, result[testutil::Key("coll/d")].largest_batch_id());
+  });
+}
+
 TEST_P(DocumentOverlayCacheTest, CanReadSavedOverlay) {
   this->persistence_->Run("CanReadSavedOverlay", [&] {
     Mutation mutation = PatchMutation("coll/doc1", Map("foo", "bar"));
@@ -313,6 +336,37 @@ TEST_P(DocumentOverlayCacheTest, GetAllOverlaysForCollection) {
   });
 }
 
+TEST_P(DocumentOverlayCacheTest, GetOverlaysInKeyRange) {
+  this->persistence_->Run("GetOverlaysInKeyRange", [&] {
+    this->SaveOverlaysWithSetMutations(
+        2, {"coll/a", "coll/b", "coll/b/sub/a", "coll/c", "coll/d", "other/a"});
+    this->SaveOverlaysWithSetMutations(3, {"coll/e"});
+
+    {
+      SCOPED_TRACE("verify bounded range");
+      const auto overlays = this->cache_->GetOverlaysInRange(
+          ResourcePath{"coll"}, testutil::Key("coll/a"),
+          testutil::Key("coll/c"));
+      VerifyOverlayContains(overlays, {"coll/b", "coll/c"});
+    }
+
+    {
+      SCOPED_TRACE("verify unbounded range");
+      const auto overlays = this->cache_->GetOverlaysInRange(
+          ResourcePath{"coll"}, absl::nullopt, absl::nullopt);
+      VerifyOverlayContains(
+          overlays, {"coll/a", "coll/b", "coll/c", "coll/d", "coll/e"});
+    }
+
+    {
+      SCOPED_TRACE("verify range after the last overlay");
+      const auto overlays = this->cache_->GetOverlaysInRange(
+          ResourcePath{"coll"}, testutil::Key("coll/e"), absl::nullopt);
+      VerifyOverlayContains(overlays, {});
+    }
+  });
+}
+
 TEST_P(DocumentOverlayCacheTest, GetAllOverlaysSinceBatchId) {
   this->persistence_->Run("GetAllOverlaysSinceBatchId", [&] {
     this->SaveOverlaysWithSetMutations(2, {"coll/doc1", "coll/doc2"});
@@ -326,6 +380,22 @@ TEST_P(DocumentOverlayCacheTest, GetAllOverlaysSinceBatchId) {
   });
 }
 
+TEST_P(DocumentOverlayCacheTest,
+       GetAllOverlaysSinceBatchIdSkipsSubcollections) {
+  this->persistence_->Run("GetAllOverlaysSinceBatchIdSkipsSubcollections", [&] {
+    this->SaveOverlaysWithSetMutations(1, {"coll/doc1", "coll/doc1/sub/a"});
+    this->SaveOverlaysWithSetMutations(2, {"coll/doc2/sub/b", "coll/doc3"});
+    this->SaveOverlaysWithSetMutations(3, {"coll/doc2", "coll/doc3/sub/c"});
+
+    const auto overlays = this->cache_->GetOverlays(ResourcePath{"coll"}, 1);
+
+    SCOPED_TRACE("verify overlay");
+    VerifyOverlayContains(overlays, {"coll/doc2", "coll/doc3"});
+    EXPECT_EQ(overlays.at(testutil::Key("coll/doc2")).largest_batch_id(), 3);
+    EXPECT_EQ(overlays.at(testutil::Key("coll/doc3")).largest_batch_id(), 2);
+  });
+}
+
 TEST_P(DocumentOverlayCacheTest,
        GetAllOverlaysFromCollectionGroupEnforcesCollectionGroup) {
   this->persistence_->Run(
@@ -385,6 +455,37 @@ TEST_P(DocumentOverlayCacheTest,
       });
 }
 
+TEST_P(DocumentOverlayCacheTest, TracksWhichCollectionsHaveOverlays) {
+  this->persistence_->Run("TracksWhichCollectionsHaveOverlays", [&] {
+    EXPECT_FALSE(this->cache_->HasAnyOverlays());
+    EXPECT_FALSE(this->cache_->HasOverlays(ResourcePath{"coll"}));
+
+    this->SaveOverlaysWithSetMutations(1, {"coll/doc1", "coll/doc1/sub/a"});
+    this->SaveOverlaysWithSetMutations(2, {"coll/doc2"});
+    // Overwriting an overlay must not count it twice.
+    this->SaveOverlaysWithSetMutations(3, {"coll/doc1"});
+
+    EXPECT_TRUE(this->cache_->HasAnyOverlays());
+    EXPECT_TRUE(this->cache_->HasOverlays(ResourcePath{"coll"}));
+    EXPECT_TRUE(this->cache_->HasOverlays(ResourcePath{"coll", "doc1", "sub"}));
+    EXPECT_FALSE(this->cache_->HasOverlays(ResourcePath{"other"}));
+    EXPECT_FALSE(
+        this->cache_->HasOverlays(ResourcePath{"coll", "doc2", "sub"}));
+
+    this->cache_->RemoveOverlaysForBatchId(1);
+    EXPECT_FALSE(
+        this->cache_->HasOverlays(ResourcePath{"coll", "doc1", "sub"}));
+    EXPECT_TRUE(this->cache_->HasOverlays(ResourcePath{"coll"}));
+
+    this->cache_->RemoveOverlaysForBatchId(2);
+    EXPECT_TRUE(this->cache_->HasOverlays(ResourcePath{"coll"}));
+
+    this->cache_->RemoveOverlaysForBatchId(3);
+    EXPECT_FALSE(this->cache_->HasOverlays(ResourcePath{"coll"}));
+    EXPECT_FALSE(this->cache_->HasAnyOverlays());
+  });
+}
+
 TEST_P(DocumentOverlayCacheTest, UpdateDocumentOverlay) {
   this->persistence_->Run("UpdateDocumentOverlay", [&] {
     Mutation mutation1 = PatchMutation("coll/doc", Map("foo", "bar1"));
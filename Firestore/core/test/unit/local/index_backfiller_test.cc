@@ -112,6 +112,10 @@ class IndexBackfillerTest : public ::testing::Test {
     index_backfiller_->SetMaxDocumentsToProcess(new_max);
   }
 
+  void SetMaxDocumentsToProcessInBulk(int new_max) const {
+    index_backfiller_->SetMaxDocumentsToProcessInBulk(new_max);
+  }
+
   void VerifyQueryResults(
       const core::Query& query,
       const std::unordered_set<std::string>& expected_keys) const {
@@ -256,6 +260,40 @@ TEST_F(IndexBackfillerTest, WritesOldestDocumentFirst) {
   VerifyQueryResults("coll1", {"coll1/docA", "coll1/docB", "coll1/docC"});
 }
 
+TEST_F(IndexBackfillerTest, BackfillsInBulkWhenDocumentsRemain) {
+  SetMaxDocumentsToProcess(2);
+  SetMaxDocumentsToProcessInBulk(3);
+
+  AddFieldIndex("coll1", "foo");
+  std::unordered_set<std::string> expected_keys;
+  for (int i = 0; i < 10; ++i) {
+    std::string path = "coll1/doc" + std::to_string(i);
+    AddDoc(path, Version(10 + i), "foo", i);
+    expected_keys.insert(path);
+  }
+
+  int documents_processed = local_store_.Backfill(std::chrono::minutes(1));
+  ASSERT_EQ(10, documents_processed);
+  EXPECT_TRUE(local_store_.backfill_progress().up_to_date);
+  EXPECT_EQ(10, local_store_.backfill_progress().documents_processed);
+
+  VerifyQueryResults("coll1", expected_keys);
+}
+
+TEST_F(IndexBackfillerTest, DoesNotBackfillInBulkWithoutTimeBudget) {
+  SetMaxDocumentsToProcess(2);
+
+  AddFieldIndex("coll1", "foo");
+  AddDoc("coll1/docA", Version(10), "foo", 1);
+  AddDoc("coll1/docB", Version(10), "foo", 1);
+  AddDoc("coll1/docC", Version(10), "foo", 1);
+
+  int documents_processed =
+      local_store_.Backfill(std::chrono::milliseconds::zero());
+  ASSERT_EQ(2, documents_processed);
+  EXPECT_FALSE(local_store_.backfill_progress().up_to_date);
+}
+
 TEST_F(IndexBackfillerTest, UsesDocumentKeyOffsetForLargeSnapshots) {
   SetMaxDocumentsToProcess(2);
 
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/lazy_document.h"
+
+#include <string>
+
+#include "Firestore/core/src/core/query.h"
+#include "Firestore/core/src/local/local_serializer.h"
+#include "Firestore/core/src/model/mutable_document.h"
+#include "Firestore/core/src/nanopb/message.h"
+#include "Firestore/core/test/unit/local/persistence_testing.h"
+#include "Firestore/core/test/unit/testutil/testutil.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+namespace {
+
+using model::MutableDocument;
+using nanopb::MakeStdString;
+using testutil::DeletedDoc;
+using testutil::Doc;
+using testutil::Filter;
+using testutil::Key;
+using testutil::Map;
+using testutil::OrderBy;
+using testutil::Query;
+
+class LazyDocumentTest : public testing::Test {
+ protected:
+  std::string Encode(const MutableDocument& document) {
+    return MakeStdString(serializer_.EncodeMaybeDocument(document));
+  }
+
+  LocalSerializer serializer_ = MakeLocalSerializer();
+};
+
+TEST_F(LazyDocumentTest, CollectsTopLevelFieldsOfFiltersAndOrderBys) {
+  core::Query query = Query("coll")
+                          .AddingFilter(Filter("a.b", "==", 1))
+                          .AddingFilter(Filter("c", ">", 1))
+                          .AddingOrderBy(OrderBy("d"))
+                          .AddingOrderBy(OrderBy("__name__"));
+
+  EXPECT_EQ(LazyDocument::FieldsToMatch(query),
+            (LazyDocument::FieldNames{"a", "c", "d"}));
+}
+
+TEST_F(LazyDocumentTest, MatchesOnlyDecodedFields) {
+  std::string encoded =
+      Encode(Doc("coll/a", 1,
+                 Map("status", "open", "nested", Map("count", 3), "other",
+                     "ignored")));
+  LazyDocument document(Key("coll/a"), encoded);
+  ASSERT_TRUE(document.is_found_document());
+
+  core::Query open = Query("coll").AddingFilter(Filter("status", "==", "open"));
+  EXPECT_TRUE(document.Matches(open, LazyDocument::FieldsToMatch(open)));
+
+  core::Query closed =
+      Query("coll").AddingFilter(Filter("status", "==", "closed"));
+  EXPECT_FALSE(document.Matches(closed, LazyDocument::FieldsToMatch(closed)));
+
+  core::Query nested =
+      Query("coll").AddingFilter(Filter("nested.count", ">", 2));
+  EXPECT_TRUE(document.Matches(nested, LazyDocument::FieldsToMatch(nested)));
+}
+
+TEST_F(LazyDocumentTest, DoesNotMatchDocumentsMissingOrderByFields) {
+  std::string encoded = Encode(Doc("coll/a", 1, Map("status", "open")));
+  LazyDocument document(Key("coll/a"), encoded);
+
+  core::Query query = Query("coll").AddingOrderBy(OrderBy("missing"));
+  EXPECT_FALSE(document.Matches(query, LazyDocument::FieldsToMatch(query)));
+}
+
+TEST_F(LazyDocumentTest, DoesNotMatchDeletedDocuments) {
+  std::string encoded = Encode(DeletedDoc("coll/a", 1));
+  LazyDocument document(Key("coll/a"), encoded);
+
+  core::Query query = Query("coll");
+  EXPECT_FALSE(document.is_found_document());
+  EXPECT_FALSE(document.Matches(query, LazyDocument::FieldsToMatch(query)));
+}
+
+}  // namespace
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
@@ -427,6 +427,28 @@ TEST(RemoteDocumentReadTimeKeyTest, Description) {
       RemoteDocumentReadTimeKey("coll", 1000001, "doc"));
 }
 
+TEST(RemoteDocumentDictionaryKeyTest, EncodeDecodeCycle) {
+  LevelDbRemoteDocumentDictionaryKey key;
+
+  std::vector<std::string> collection_paths{"foo", "foo/doc/bar"};
+  for (const auto& collection_path : collection_paths) {
+    auto encoded = LevelDbRemoteDocumentDictionaryKey::Key(
+        testutil::Resource(collection_path));
+    ASSERT_TRUE(absl::StartsWith(
+        encoded, LevelDbRemoteDocumentDictionaryKey::KeyPrefix()));
+    bool ok = key.Decode(encoded);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(testutil::Resource(collection_path), key.collection_path());
+  }
+}
+
+TEST(RemoteDocumentDictionaryKeyTest, Description) {
+  AssertExpectedKeyDescription(
+      "[remote_document_dictionary: path=foo/doc/bar]",
+      LevelDbRemoteDocumentDictionaryKey::Key(
+          testutil::Resource("foo/doc/bar")));
+}
+
 TEST(BundleKeyTest, Prefixing) {
   auto table_key = LevelDbBundleKey::KeyPrefix();
 
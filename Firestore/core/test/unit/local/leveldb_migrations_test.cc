@@ -272,6 +272,64 @@ TEST_F(LevelDbMigrationsTest, AddsSentinelRows) {
   }
 }
 
+TEST_F(LevelDbMigrationsTest, AddsSentinelRowsInChunks) {
+  LevelDbMigrations::RunMigrations(db_.get(), 3, *serializer_);
+  {
+    LevelDbTransaction transaction(db_.get(), "Setup");
+    for (int i = 0; i < 2500; i++) {
+      DocumentKey key = DocumentKey::FromSegments({"docs", std::to_string(i)});
+      transaction.Put(LevelDbRemoteDocumentKey::Key(key), "");
+    }
+    transaction.Commit();
+  }
+
+  LevelDbMigrations::RunMigrations(db_.get(), 4, *serializer_);
+  {
+    LevelDbTransaction transaction(db_.get(), "Verify");
+    std::string buffer;
+    for (int i = 0; i < 2500; i++) {
+      DocumentKey key = DocumentKey::FromSegments({"docs", std::to_string(i)});
+      ASSERT_TRUE(
+          transaction.Get(LevelDbDocumentTargetKey::SentinelKey(key), &buffer)
+              .ok());
+    }
+
+    // The resume cursor is removed once the migration completes.
+    ASSERT_TRUE(
+        transaction
+            .Get(LevelDbDataMigrationKey::SentinelRowsCursorKey(), &buffer)
+            .IsNotFound());
+  }
+}
+
+TEST_F(LevelDbMigrationsTest, ResumesAddingSentinelRowsFromCursor) {
+  LevelDbMigrations::RunMigrations(db_.get(), 3, *serializer_);
+  {
+    LevelDbTransaction transaction(db_.get(), "Setup");
+    for (int i = 0; i < 10; i++) {
+      DocumentKey key = DocumentKey::FromSegments({"docs", std::to_string(i)});
+      transaction.Put(LevelDbRemoteDocumentKey::Key(key), "");
+    }
+
+    // Pretend that an earlier run was interrupted after visiting docs/4.
+    transaction.Put(LevelDbDataMigrationKey::SentinelRowsCursorKey(),
+                    LevelDbRemoteDocumentKey::Key(Key("docs/4")));
+    transaction.Commit();
+  }
+
+  LevelDbMigrations::RunMigrations(db_.get(), 4, *serializer_);
+  {
+    LevelDbTransaction transaction(db_.get(), "Verify");
+    std::string buffer;
+    for (int i = 0; i < 10; i++) {
+      DocumentKey key = DocumentKey::FromSegments({"docs", std::to_string(i)});
+      Status status =
+          transaction.Get(LevelDbDocumentTargetKey::SentinelKey(key), &buffer);
+      ASSERT_EQ(i > 4, status.ok()) << "docs/" << i;
+    }
+  }
+}
+
 TEST_F(LevelDbMigrationsTest, RemovesMutationBatches) {
   std::string empty_buffer;
   DocumentKey test_write_foo = DocumentKey::FromPathString("docs/foo");
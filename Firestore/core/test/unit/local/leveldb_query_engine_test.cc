@@ -19,11 +19,14 @@
 #include "Firestore/core/src/core/query.h"
 #include "Firestore/core/src/local/leveldb_persistence.h"
 #include "Firestore/core/src/local/query_engine.h"
+#include "Firestore/core/src/model/aggregate_field.h"
 #include "Firestore/core/src/model/document_set.h"
 #include "Firestore/core/src/model/field_index.h"
 #include "Firestore/core/src/model/mutable_document.h"
+#include "Firestore/core/src/model/object_value.h"
 #include "Firestore/core/src/model/patch_mutation.h"
 #include "Firestore/core/src/model/set_mutation.h"
+#include "Firestore/core/test/unit/local/counting_query_engine.h"
 #include "Firestore/core/test/unit/local/persistence_testing.h"
 #include "Firestore/core/test/unit/local/query_engine_test.h"
 #include "Firestore/core/test/unit/testutil/testutil.h"
@@ -34,7 +37,11 @@ namespace firestore {
 namespace local {
 namespace {
 
+using model::AggregateAlias;
+using model::AggregateField;
+using model::DocumentKeySet;
 using model::DocumentSet;
+using model::ObjectValue;
 using model::SnapshotVersion;
 using testutil::AndFilters;
 using testutil::Array;
@@ -638,6 +645,56 @@ TEST_F(LevelDbQueryEngineTest, OrderByEquality) {
   });
 }
 
+TEST_F(LevelDbQueryEngineTest, CountsUsingIndexEntries) {
+  persistence_->Run("CountsUsingIndexEntries", [&] {
+    mutation_queue_->Start();
+    index_manager_->Start();
+
+    CountingQueryEngine query_engine;
+    query_engine.Initialize(&local_documents_view_);
+
+    auto doc1 = Doc("coll/a", 1, Map("foo", true));
+    auto doc2 = Doc("coll/b", 2, Map("foo", true));
+    auto doc3 = Doc("coll/c", 3, Map("foo", false));
+    // A document in a different collection with the same collection ID shares
+    // the collection group's index entries.
+    auto doc4 = Doc("other/a/coll/d", 4, Map("foo", true));
+    auto doc5 = Doc("coll/e", 5, Map("foo", true));
+
+    index_manager_->AddFieldIndex(
+        MakeFieldIndex("coll", "foo", model::Segment::kAscending));
+
+    AddDocuments({doc1, doc2, doc3, doc4});
+    index_manager_->UpdateIndexEntries(DocumentMap({doc1, doc2, doc3, doc4}));
+    index_manager_->UpdateCollectionGroup(
+        "coll", model::IndexOffset::FromDocument(doc4));
+
+    core::Query query = Query("coll").AddingFilter(Filter("foo", "==", true));
+    std::vector<AggregateField> aggregates;
+    aggregates.emplace_back(AggregateField::OpKind::Count,
+                            AggregateAlias("count"));
+
+    // The index is up to date, so no documents are read.
+    ObjectValue result = query_engine.ComputeAggregates(query, aggregates);
+    EXPECT_EQ(result.Get("count")->integer_value, 2);
+    EXPECT_EQ(query_engine.documents_read_by_query(), 0u);
+    EXPECT_EQ(query_engine.documents_read_by_key(), 0u);
+
+    core::Query group_query = testutil::CollectionGroupQuery("coll")
+                                  .AddingFilter(Filter("foo", "==", true));
+    result = query_engine.ComputeAggregates(group_query, aggregates);
+    EXPECT_EQ(result.Get("count")->integer_value, 3);
+    EXPECT_EQ(query_engine.documents_read_by_query(), 0u);
+    EXPECT_EQ(query_engine.documents_read_by_key(), 0u);
+
+    // A document that has not been indexed yet requires reading documents.
+    AddDocuments({doc5});
+    result = query_engine.ComputeAggregates(query, aggregates);
+    EXPECT_EQ(result.Get("count")->integer_value, 3);
+    EXPECT_GT(query_engine.documents_read_by_query(), 0u);
+  });
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
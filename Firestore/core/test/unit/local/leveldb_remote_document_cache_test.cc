@@ -18,11 +18,17 @@
 #include <memory>
 #include <string>
 
+#include "Firestore/core/src/local/document_compression.h"
+#include "Firestore/core/src/local/leveldb_key.h"
 #include "Firestore/core/src/local/leveldb_persistence.h"
+#include "Firestore/core/src/local/leveldb_remote_document_cache.h"
 #include "Firestore/core/src/local/remote_document_cache.h"
+#include "Firestore/core/src/model/document_key_set.h"
+#include "Firestore/core/src/model/mutable_document.h"
 #include "Firestore/core/src/util/ordered_code.h"
 #include "Firestore/core/test/unit/local/persistence_testing.h"
 #include "Firestore/core/test/unit/local/remote_document_cache_test.h"
+#include "Firestore/core/test/unit/testutil/testutil.h"
 #include "absl/memory/memory.h"
 #include "leveldb/db.h"
 
@@ -32,6 +38,15 @@ namespace local {
 namespace {
 
 using leveldb::WriteOptions;
+using model::DocumentKeySet;
+using model::MutableDocument;
+using testutil::Doc;
+using testutil::Filter;
+using testutil::Key;
+using testutil::Map;
+using testutil::Query;
+using testutil::Resource;
+using testutil::Version;
 using util::OrderedCode;
 
 // A dummy document value, useful for testing code that's known to examine only
@@ -84,6 +99,165 @@ INSTANTIATE_TEST_SUITE_P(LevelDbRemoteDocumentCacheTest,
                          RemoteDocumentCacheTest,
                          testing::Values(PersistenceFactory));
 
+TEST(LevelDbRemoteDocumentCacheTest, ServesRepeatedReadsFromDecodedCache) {
+  auto persistence = LevelDbPersistenceForTesting();
+  LevelDbRemoteDocumentCache* cache = persistence->remote_document_cache();
+
+  persistence->Run("test", [&] {
+    cache->Add(Doc("coll/a", 1, Map("value", 1)), Version(1));
+
+    EXPECT_EQ(cache->Get(Key("coll/a")), Doc("coll/a", 1, Map("value", 1)));
+    EXPECT_EQ(cache->decoded_document_stats().misses, 1);
+
+    EXPECT_EQ(cache->Get(Key("coll/a")), Doc("coll/a", 1, Map("value", 1)));
+    EXPECT_EQ(cache->decoded_document_stats().hits, 1);
+  });
+}
+
+TEST(LevelDbRemoteDocumentCacheTest, InvalidatesDecodedCacheOnWrite) {
+  auto persistence = LevelDbPersistenceForTesting();
+  LevelDbRemoteDocumentCache* cache = persistence->remote_document_cache();
+
+  persistence->Run("test", [&] {
+    cache->Add(Doc("coll/a", 1, Map("value", 1)), Version(1));
+    cache->Get(Key("coll/a"));
+
+    cache->Add(Doc("coll/a", 2, Map("value", 2)), Version(2));
+    EXPECT_EQ(cache->Get(Key("coll/a")), Doc("coll/a", 2, Map("value", 2)));
+
+    cache->Remove(Key("coll/a"));
+    EXPECT_EQ(cache->Get(Key("coll/a")),
+              MutableDocument::InvalidDocument(Key("coll/a")));
+  });
+}
+
+TEST(LevelDbRemoteDocumentCacheTest, CompressesDocuments) {
+  auto persistence = LevelDbPersistenceForTesting();
+  LevelDbRemoteDocumentCache* cache = persistence->remote_document_cache();
+  cache->set_compression_enabled(true);
+
+  auto doc = [](int i) {
+    return Doc("coll/doc" + std::to_string(i), 1,
+               Map("status", "active", "country", "Switzerland", "index", i));
+  };
+
+  persistence->Run("test", [&] {
+    for (int i = 0; i < 40; ++i) {
+      cache->Add(doc(i), Version(1));
+    }
+
+    LevelDbTransaction* transaction = persistence->current_transaction();
+    std::string dictionary;
+    EXPECT_TRUE(transaction
+                    ->Get(LevelDbRemoteDocumentDictionaryKey::Key(
+                              Resource("coll")),
+                          &dictionary)
+                    .ok());
+    std::string stored;
+    ASSERT_TRUE(
+        transaction->Get(LevelDbRemoteDocumentKey::Key(Key("coll/doc39")),
+                         &stored)
+            .ok());
+    EXPECT_TRUE(IsCompressedDocument(stored));
+
+    EXPECT_EQ(cache->Get(Key("coll/doc39")), doc(39));
+    DocumentKeySet keys{Key("coll/doc0"), Key("coll/doc39")};
+    EXPECT_EQ(cache->GetAll(keys).size(), 2u);
+    EXPECT_EQ(cache->GetDocumentsMatchingQuery(
+                        Query("coll").AddingFilter(Filter("index", ">=", 38)),
+                        model::IndexOffset::None())
+                  .size(),
+              2u);
+  });
+}
+
+TEST(LevelDbRemoteDocumentCacheTest, DeletesDictionaryOfEmptiedCollection) {
+  auto persistence = LevelDbPersistenceForTesting();
+  LevelDbRemoteDocumentCache* cache = persistence->remote_document_cache();
+  cache->set_compression_enabled(true);
+
+  auto doc = [](int i) {
+    return Doc("coll/doc" + std::to_string(i), 1,
+               Map("status", "active", "country", "Switzerland", "index", i));
+  };
+
+  std::string dictionary_key =
+      LevelDbRemoteDocumentDictionaryKey::Key(Resource("coll"));
+  auto has_dictionary = [&] {
+    std::string dictionary;
+    return persistence->current_transaction()
+        ->Get(dictionary_key, &dictionary)
+        .ok();
+  };
+
+  persistence->Run("test", [&] {
+    for (int i = 0; i < 40; ++i) {
+      cache->Add(doc(i), Version(1));
+    }
+    cache->Add(Doc("coll/doc0/sub/a", 1, Map()), Version(1));
+  });
+
+  persistence->Run("test", [&] {
+    for (int i = 0; i < 39; ++i) {
+      cache->Remove(Key("coll/doc" + std::to_string(i)));
+    }
+  });
+
+  persistence->Run("test", [&] {
+    EXPECT_TRUE(has_dictionary());
+    EXPECT_EQ(cache->Get(Key("coll/doc39")), doc(39));
+
+    // Emptying the collection and adding a document back in the same
+    // transaction keeps the dictionary.
+    cache->Remove(Key("coll/doc39"));
+    cache->Add(doc(39), Version(2));
+  });
+
+  persistence->Run("test", [&] {
+    EXPECT_TRUE(has_dictionary());
+    cache->Remove(Key("coll/doc39"));
+  });
+
+  persistence->Run("test", [&] {
+    EXPECT_FALSE(has_dictionary());
+    EXPECT_EQ(cache->Get(Key("coll/doc0/sub/a")),
+              Doc("coll/doc0/sub/a", 1, Map()));
+  });
+}
+
+TEST(LevelDbRemoteDocumentCacheTest, LimitsSampledCollections) {
+  auto persistence = LevelDbPersistenceForTesting();
+  LevelDbRemoteDocumentCache* cache = persistence->remote_document_cache();
+  cache->set_compression_enabled(true);
+
+  auto add_docs = [&](const std::string& collection, int count) {
+    for (int i = 0; i < count; ++i) {
+      cache->Add(Doc(collection + "/doc" + std::to_string(i), 1,
+                     Map("status", "active", "index", i)),
+                 Version(1));
+    }
+  };
+  auto has_dictionary = [&](const std::string& collection) {
+    std::string dictionary;
+    return persistence->current_transaction()
+        ->Get(LevelDbRemoteDocumentDictionaryKey::Key(Resource(collection)),
+              &dictionary)
+        .ok();
+  };
+
+  persistence->Run("test", [&] {
+    // Starts sampling the first 16 collections.
+    for (int i = 0; i < 16; ++i) {
+      add_docs("coll" + std::to_string(i), 1);
+    }
+
+    add_docs("other", 40);
+    EXPECT_FALSE(has_dictionary("other"));
+    add_docs("coll0", 40);
+    EXPECT_TRUE(has_dictionary("coll0"));
+  });
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+
+#include "Firestore/core/src/local/leveldb_transaction.h"
+#include "Firestore/core/src/util/hard_assert.h"
+#include "Firestore/core/src/util/path.h"
+#include "Firestore/core/test/unit/local/persistence_testing.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "leveldb/db.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+namespace {
+
+constexpr int kRowCount = 100000;
+
+std::string RowKey(int i) {
+  // Zero-padded so that lexicographic order matches numeric order.
+  std::string number = std::to_string(i);
+  return absl::StrCat("row_", std::string(6 - number.size(), '0'), number);
+}
+
+/** Opens a fresh database populated with `kRowCount` committed rows. */
+std::unique_ptr<leveldb::DB> OpenPopulatedDb() {
+  leveldb::Options options;
+  options.error_if_exists = true;
+  options.create_if_missing = true;
+
+  leveldb::DB* db = nullptr;
+  leveldb::Status status =
+      leveldb::DB::Open(options, LevelDbDir().ToUtf8String(), &db);
+  HARD_ASSERT(status.ok(), "Failed to create db: %s", status.ToString());
+
+  LevelDbTransaction transaction(db, "Populate");
+  std::string value(100, 'v');
+  for (int i = 0; i < kRowCount; ++i) {
+    transaction.Put(RowKey(i), value);
+  }
+  transaction.Commit();
+  return std::unique_ptr<leveldb::DB>(db);
+}
+
+/**
+ * Scans all rows through a transaction iterator. The argument is the number of
+ * rows deleted in the transaction (spread evenly over the table) before
+ * scanning, to exercise merging with pending deletions.
+ */
+void BM_TransactionScan(benchmark::State& state) {
+  std::unique_ptr<leveldb::DB> db = OpenPopulatedDb();
+  const int deletions = static_cast<int>(state.range(0));
+
+  int64_t rows = 0;
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    LevelDbTransaction transaction(db.get(), "Scan");
+    for (int i = 0; i < deletions; ++i) {
+      transaction.Delete(RowKey(i * (kRowCount / deletions)));
+    }
+
+    auto it = transaction.NewIterator();
+    for (it->Seek(RowKey(0)); it->Valid(); it->Next()) {
+      ++rows;
+      bytes += it->key().size() + it->value().size();
+    }
+  }
+  state.SetItemsProcessed(rows);
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_TransactionScan)->Arg(0)->Arg(100)->Arg(10000);
+
+}  // namespace
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
@@ -290,6 +290,55 @@ TEST_F(LevelDbTransactionTest, DeletingAheadOfAnIterator) {
   ASSERT_FALSE(it->Valid());
 }
 
+TEST_F(LevelDbTransactionTest, MergesDeletionsAndMutationsWithCommitted) {
+  for (int i = 0; i < 10; ++i) {
+    Status status =
+        db_->Put(LevelDbTransaction::DefaultWriteOptions(),
+                 "key_" + std::to_string(i), "value_" + std::to_string(i));
+    ASSERT_TRUE(status.ok());
+  }
+
+  LevelDbTransaction transaction(db_.get(),
+                                 "MergesDeletionsAndMutationsWithCommitted");
+  for (int i = 1; i < 10; i += 2) {
+    transaction.Delete("key_" + std::to_string(i));
+  }
+  transaction.Put("key_4", "updated");
+
+  auto it = transaction.NewIterator();
+  it->Seek("key_0");
+  for (int i = 0; i < 10; i += 2) {
+    ASSERT_TRUE(it->Valid());
+    ASSERT_EQ("key_" + std::to_string(i), it->key());
+    ASSERT_EQ(i == 4 ? "updated" : "value_" + std::to_string(i), it->value());
+    it->Next();
+  }
+  ASSERT_FALSE(it->Valid());
+
+  // Seeking to a deleted key skips ahead to the next live one.
+  it->Seek("key_5");
+  ASSERT_TRUE(it->Valid());
+  ASSERT_EQ("key_6", it->key());
+}
+
+TEST_F(LevelDbTransactionTest, CurrentEntrySurvivesOverwrite) {
+  LevelDbTransaction transaction(db_.get(), "CurrentEntrySurvivesOverwrite");
+  transaction.Put("key_0", "value_0");
+
+  auto it = transaction.NewIterator();
+  it->Seek("key_0");
+  ASSERT_TRUE(it->Valid());
+  absl::string_view value = it->value();
+
+  // Overwriting the pending value must not invalidate the current entry.
+  transaction.Put("key_0", std::string(100, 'x'));
+  ASSERT_EQ("value_0", value);
+  ASSERT_EQ("value_0", it->value());
+
+  it->Next();
+  ASSERT_FALSE(it->Valid());
+}
+
 TEST_F(LevelDbTransactionTest, ToString) {
   std::string key = LevelDbMutationKey::Key("user1", 42);
   Message<firestore_client_WriteBatch> message;
@@ -249,6 +249,7 @@ class LocalSerializerTest : public ::testing::Test {
       const MutableDocument& model,
       const ::firestore::client::MaybeDocument& proto) {
     ByteString bytes = EncodeMaybeDocument(&serializer, model);
+    EXPECT_EQ(serializer.EncodedSize(model), bytes.size());
     auto actual = ProtobufParse<::firestore::client::MaybeDocument>(bytes);
     EXPECT_TRUE(msg_diff.Compare(proto, actual)) << message_differences;
   }
@@ -272,6 +273,7 @@ class LocalSerializerTest : public ::testing::Test {
   void ExpectSerializationRoundTrip(const TargetData& target_data,
                                     const ::firestore::client::Target& proto) {
     ByteString bytes = EncodeTargetData(&serializer, target_data);
+    EXPECT_EQ(serializer.EncodedSize(target_data), bytes.size());
     auto actual = ProtobufParse<::firestore::client::Target>(bytes);
     EXPECT_TRUE(msg_diff.Compare(proto, actual)) << message_differences;
   }
@@ -302,6 +304,7 @@ class LocalSerializerTest : public ::testing::Test {
       const MutationBatch& model,
       const ::firestore::client::WriteBatch& proto) {
     ByteString bytes = EncodeMutationBatch(&serializer, model);
+    EXPECT_EQ(serializer.EncodedSize(model), bytes.size());
     auto actual = ProtobufParse<::firestore::client::WriteBatch>(bytes);
     EXPECT_TRUE(msg_diff.Compare(proto, actual)) << message_differences;
   }
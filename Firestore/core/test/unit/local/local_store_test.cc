@@ -16,6 +16,7 @@
 
 #include "Firestore/core/test/unit/local/local_store_test.h"
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <thread>  // NOLINT(build/c++11)
 #include <unordered_map>
 #include <utility>
@@ -49,6 +50,7 @@
 #include "Firestore/core/src/remote/existence_filter.h"
 #include "Firestore/core/src/remote/remote_event.h"
 #include "Firestore/core/src/remote/watch_change.h"
+#include "Firestore/core/src/util/phase_timer.h"
 #include "Firestore/core/test/unit/remote/fake_target_metadata_provider.h"
 #include "Firestore/core/test/unit/testutil/testutil.h"
 #include "absl/memory/memory.h"
@@ -319,6 +321,21 @@ TEST_P(LocalStoreTest, MutationBatchKeys) {
   ASSERT_EQ(keys.size(), 2u);
 }
 
+TEST_P(LocalStoreTest, RecordsStartTimings) {
+  LocalStore local_store(persistence_.get(), &query_engine_,
+                         User::Unauthenticated());
+  util::PhaseTimer timer;
+  local_store.Start();
+  std::chrono::microseconds elapsed = timer.EndPhase();
+
+  // The phases are consecutive, so together they fit in the time `Start()`
+  // took.
+  const LocalStoreStartTimings& timings = local_store.start_timings();
+  EXPECT_LE(timings.mutation_queue + timings.index_manager +
+                timings.overlay_migration,
+            elapsed);
+}
+
 TEST_P(LocalStoreTest, HandlesSetMutation) {
   WriteMutation(testutil::SetMutation("foo/bar", Map("foo", "bar")));
   FSTAssertChanged(Doc("foo/bar", 0, Map("foo", "bar")).SetHasLocalMutations());
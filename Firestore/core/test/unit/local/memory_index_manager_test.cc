@@ -18,8 +18,11 @@
 
 #include "Firestore/core/src/local/memory_index_manager.h"
 #include "Firestore/core/src/local/memory_persistence.h"
+#include "Firestore/core/src/local/memory_remote_document_cache.h"
 #include "Firestore/core/src/local/reference_delegate.h"
+#include "Firestore/core/src/model/field_index.h"
 #include "Firestore/core/test/unit/local/persistence_testing.h"
+#include "Firestore/core/test/unit/testutil/testutil.h"
 #include "absl/memory/memory.h"
 #include "gtest/gtest.h"
 
@@ -29,6 +32,20 @@ namespace local {
 
 namespace {
 
+using credentials::User;
+using model::IndexOffset;
+using model::Segment;
+using testutil::Array;
+using testutil::Doc;
+using testutil::Filter;
+using testutil::Key;
+using testutil::MakeFieldIndex;
+using testutil::Map;
+using testutil::OrderBy;
+using testutil::OrFilters;
+using testutil::Query;
+using testutil::Version;
+
 std::unique_ptr<Persistence> PersistenceFactory() {
   return MemoryPersistenceWithEagerGcForTesting();
 }
@@ -39,6 +56,152 @@ INSTANTIATE_TEST_SUITE_P(MemoryIndexManagerTest,
                          IndexManagerTest,
                          ::testing::Values(PersistenceFactory));
 
+class MemoryIndexManagerTest : public ::testing::Test {
+ public:
+  MemoryIndexManagerTest() : persistence_{PersistenceFactory()} {
+    index_manager_ = persistence_->GetIndexManager(User::Unauthenticated());
+    remote_document_cache_ = persistence_->remote_document_cache();
+    remote_document_cache_->SetIndexManager(index_manager_);
+  }
+
+  void AddDoc(const std::string& key,
+              int64_t version,
+              nanopb::Message<google_firestore_v1_Value> data) const {
+    remote_document_cache_->Add(Doc(key, version, std::move(data)),
+                                Version(version));
+  }
+
+  void VerifyResults(const core::Query& query,
+                     const std::vector<std::string>& documents) const {
+    const auto& target = query.ToTarget();
+    absl::optional<std::vector<model::DocumentKey>> results =
+        index_manager_->GetDocumentsMatchingTarget(target);
+    EXPECT_TRUE(results.has_value()) << "Target cannot be served from index.";
+    std::vector<model::DocumentKey> expected;
+    for (const auto& key : documents) {
+      expected.push_back(Key(key));
+    }
+    EXPECT_EQ(expected, results.value())
+        << "Query returned unexpected documents.";
+  }
+
+  std::unique_ptr<Persistence> persistence_;
+  IndexManager* index_manager_;
+  RemoteDocumentCache* remote_document_cache_;
+};
+
+TEST_F(MemoryIndexManagerTest, IndexesDocumentsAsTheyAreAdded) {
+  persistence_->Run("IndexesDocumentsAsTheyAreAdded", [&]() {
+    index_manager_->AddFieldIndex(
+        MakeFieldIndex("coll", "count", Segment::kAscending));
+    AddDoc("coll/val1", 1, Map("count", 1));
+    AddDoc("coll/val2", 1, Map("count", 2));
+    AddDoc("coll/val3", 1, Map("not-count", 3));
+    AddDoc("other/val4", 1, Map("count", 4));
+
+    VerifyResults(Query("coll").AddingFilter(Filter("count", ">", 0)),
+                  {"coll/val1", "coll/val2"});
+  });
+}
+
+TEST_F(MemoryIndexManagerTest, IndexesExistingDocumentsWhenIndexIsAdded) {
+  persistence_->Run("IndexesExistingDocumentsWhenIndexIsAdded", [&]() {
+    AddDoc("coll/val1", 1, Map("count", 1));
+    AddDoc("coll/val2", 2, Map("count", 2));
+    index_manager_->AddFieldIndex(
+        MakeFieldIndex("coll", "count", Segment::kAscending));
+    AddDoc("coll/val3", 3, Map("count", 3));
+
+    VerifyResults(Query("coll").AddingOrderBy(OrderBy("count")),
+                  {"coll/val1", "coll/val2", "coll/val3"});
+  });
+}
+
+TEST_F(MemoryIndexManagerTest, UpdatesEntriesWhenDocumentsChange) {
+  persistence_->Run("UpdatesEntriesWhenDocumentsChange", [&]() {
+    index_manager_->AddFieldIndex(
+        MakeFieldIndex("coll", "value", Segment::kContains));
+    AddDoc("coll/doc1", 1, Map("value", Array("a", "b")));
+    AddDoc("coll/doc2", 1, Map("value", Array("b")));
+    auto query = Query("coll").AddingFilter(
+        Filter("value", "array-contains", "a"));
+    VerifyResults(query, {"coll/doc1"});
+
+    AddDoc("coll/doc1", 2, Map("value", Array("b")));
+    AddDoc("coll/doc2", 2, Map("value", Array("a")));
+    VerifyResults(query, {"coll/doc2"});
+
+    remote_document_cache_->Remove(Key("coll/doc2"));
+    VerifyResults(query, {});
+  });
+}
+
+TEST_F(MemoryIndexManagerTest, AppliesOrderingAndLimit) {
+  persistence_->Run("AppliesOrderingAndLimit", [&]() {
+    index_manager_->AddFieldIndex(
+        MakeFieldIndex("coll", "value", Segment::kDescending));
+    AddDoc("coll/doc1", 1, Map("value", 1));
+    AddDoc("coll/doc2", 1, Map("value", 2));
+    AddDoc("coll/doc3", 1, Map("value", 2));
+    AddDoc("coll/doc4", 1, Map("value", 3));
+    auto query = Query("coll")
+                     .AddingFilter(Filter("value", "not-in", Array(3)))
+                     .AddingOrderBy(OrderBy("value", "desc"))
+                     .WithLimitToFirst(2);
+    VerifyResults(query, {"coll/doc3", "coll/doc2"});
+  });
+}
+
+TEST_F(MemoryIndexManagerTest, ServesOrQueries) {
+  persistence_->Run("ServesOrQueries", [&]() {
+    index_manager_->AddFieldIndex(
+        MakeFieldIndex("coll", "a", Segment::kAscending));
+    index_manager_->AddFieldIndex(
+        MakeFieldIndex("coll", "b", Segment::kAscending));
+    AddDoc("coll/doc1", 1, Map("a", 1, "b", 0));
+    AddDoc("coll/doc2", 1, Map("a", 2, "b", 1));
+    AddDoc("coll/doc3", 1, Map("a", 3, "b", 2));
+    auto query = Query("coll").AddingFilter(
+        OrFilters({Filter("a", "==", 1), Filter("b", "==", 1)}));
+    EXPECT_EQ(index_manager_->GetIndexType(query.ToTarget()),
+              IndexManager::IndexType::FULL);
+    VerifyResults(query, {"coll/doc1", "coll/doc2"});
+  });
+}
+
+TEST_F(MemoryIndexManagerTest, CreatesIndexesForTargets) {
+  persistence_->Run("CreatesIndexesForTargets", [&]() {
+    AddDoc("coll/doc1", 1, Map("value", 1));
+    AddDoc("coll/doc2", 1, Map("value", 2));
+    auto query = Query("coll").AddingFilter(Filter("value", "==", 2));
+    EXPECT_EQ(index_manager_->GetIndexType(query.ToTarget()),
+              IndexManager::IndexType::NONE);
+
+    index_manager_->CreateTargetIndexes(query.ToTarget());
+    EXPECT_EQ(index_manager_->GetIndexType(query.ToTarget()),
+              IndexManager::IndexType::FULL);
+    VerifyResults(query, {"coll/doc2"});
+  });
+}
+
+TEST_F(MemoryIndexManagerTest, MinOffsetCoversAllCachedDocuments) {
+  persistence_->Run("MinOffsetCoversAllCachedDocuments", [&]() {
+    index_manager_->AddFieldIndex(
+        MakeFieldIndex("coll", "value", Segment::kAscending));
+    AddDoc("coll/doc1", 1, Map("value", 1));
+    AddDoc("coll/doc2", 5, Map("value", 2));
+
+    IndexOffset offset = index_manager_->GetMinOffset("coll");
+    EXPECT_EQ(offset, IndexOffset::CreateSuccessor(Version(5)));
+    EXPECT_TRUE(remote_document_cache_->GetAll("coll", offset, 10).empty());
+    EXPECT_EQ(remote_document_cache_
+                  ->GetAll("coll", IndexOffset::CreateSuccessor(Version(1)), 10)
+                  .size(),
+              1u);
+    EXPECT_FALSE(index_manager_->GetNextCollectionGroupToUpdate().has_value());
+  });
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
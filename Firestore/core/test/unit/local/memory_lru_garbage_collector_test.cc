@@ -14,11 +14,26 @@
  * limitations under the License.
  */
 
+#include <memory>
+#include <unordered_map>
+
+#include "Firestore/core/include/firebase/firestore/timestamp.h"
+#include "Firestore/core/src/core/query.h"
+#include "Firestore/core/src/credentials/user.h"
 #include "Firestore/core/src/local/memory_lru_reference_delegate.h"
+#include "Firestore/core/src/local/memory_mutation_queue.h"
 #include "Firestore/core/src/local/memory_persistence.h"
+#include "Firestore/core/src/local/memory_remote_document_cache.h"
+#include "Firestore/core/src/local/memory_target_cache.h"
+#include "Firestore/core/src/local/proto_sizer.h"
+#include "Firestore/core/src/local/target_data.h"
 #include "Firestore/core/src/model/document_key.h"
+#include "Firestore/core/src/model/mutable_document.h"
+#include "Firestore/core/src/model/mutation_batch.h"
+#include "Firestore/core/src/model/set_mutation.h"
 #include "Firestore/core/test/unit/local/lru_garbage_collector_test.h"
 #include "Firestore/core/test/unit/local/persistence_testing.h"
+#include "Firestore/core/test/unit/testutil/testutil.h"
 #include "gtest/gtest.h"
 
 namespace firebase {
@@ -26,7 +41,15 @@ namespace firestore {
 namespace local {
 namespace {
 
+using credentials::User;
 using model::DocumentKey;
+using model::MutableDocument;
+using model::MutationBatch;
+using model::TargetId;
+using testutil::Doc;
+using testutil::Map;
+using testutil::SetMutation;
+using testutil::Version;
 
 class TestHelper : public LruGarbageCollectorTestHelper {
  public:
@@ -56,6 +79,105 @@ INSTANTIATE_TEST_SUITE_P(MemoryLruGarbageCollectorTest,
                          LruGarbageCollectorTest,
                          ::testing::Values(Factory));
 
+class MemoryLruByteSizeTest : public testing::Test {
+ public:
+  MemoryLruByteSizeTest()
+      : persistence_(MemoryPersistenceWithLruGcForTesting()),
+        sizer_(MakeLocalSerializer()) {
+  }
+
+ protected:
+  TargetData MakeTargetData(TargetId target_id, absl::string_view path) {
+    return TargetData(testutil::Query(path).ToTarget(), target_id,
+                      /* sequence_number= */ target_id, QueryPurpose::Listen);
+  }
+
+  std::unique_ptr<MemoryPersistence> persistence_;
+  ProtoSizer sizer_;
+};
+
+TEST_F(MemoryLruByteSizeTest, TracksRemoteDocumentByteSize) {
+  MemoryRemoteDocumentCache* cache = persistence_->remote_document_cache();
+  MutableDocument a = Doc("coll/a", 1, Map("value", 1));
+  MutableDocument updated_a = Doc("coll/a", 2, Map("value", "longer value"));
+  MutableDocument b = Doc("coll/b", 1, Map());
+
+  persistence_->Run("test", [&] {
+    // Documents added before the first call are counted in full.
+    cache->Add(a, Version(1));
+    EXPECT_EQ(cache->CalculateByteSize(sizer_), sizer_.CalculateByteSize(a));
+
+    cache->Add(b, Version(1));
+    cache->Add(updated_a, Version(2));
+    EXPECT_EQ(cache->CalculateByteSize(sizer_),
+              sizer_.CalculateByteSize(updated_a) +
+                  sizer_.CalculateByteSize(b));
+
+    cache->Remove(b.key());
+    EXPECT_EQ(cache->CalculateByteSize(sizer_),
+              sizer_.CalculateByteSize(updated_a));
+
+    // Nothing references the remaining document, so GC removes it.
+    auto delegate = static_cast<MemoryLruReferenceDelegate*>(
+        persistence_->reference_delegate());
+    cache->RemoveOrphanedDocuments(delegate, /* upper_bound= */ 100);
+    EXPECT_EQ(cache->CalculateByteSize(sizer_), 0);
+  });
+}
+
+TEST_F(MemoryLruByteSizeTest, TracksTargetByteSize) {
+  MemoryTargetCache* cache = persistence_->target_cache();
+  TargetData first = MakeTargetData(1, "coll");
+  TargetData second = MakeTargetData(2, "other");
+  TargetData updated_first =
+      first.WithResumeToken(testutil::ResumeToken(1000), Version(1000));
+
+  persistence_->Run("test", [&] {
+    cache->AddTarget(first);
+    EXPECT_EQ(cache->CalculateByteSize(sizer_),
+              sizer_.CalculateByteSize(first));
+
+    cache->AddTarget(second);
+    cache->UpdateTarget(updated_first);
+    EXPECT_EQ(cache->CalculateByteSize(sizer_),
+              sizer_.CalculateByteSize(updated_first) +
+                  sizer_.CalculateByteSize(second));
+
+    cache->RemoveTarget(second);
+    EXPECT_EQ(cache->CalculateByteSize(sizer_),
+              sizer_.CalculateByteSize(updated_first));
+
+    // No target is live, so GC removes the remaining one.
+    cache->RemoveTargets(/* upper_bound= */ 100, {});
+    EXPECT_EQ(cache->CalculateByteSize(sizer_), 0);
+  });
+}
+
+TEST_F(MemoryLruByteSizeTest, TracksMutationBatchByteSize) {
+  User user = User::Unauthenticated();
+  MemoryMutationQueue* queue = persistence_->GetMutationQueue(
+      user, persistence_->GetIndexManager(user));
+
+  persistence_->Run("test", [&] {
+    queue->Start();
+    MutationBatch first = queue->AddMutationBatch(
+        Timestamp::Now(), {}, {SetMutation("coll/a", Map("value", 1))});
+    EXPECT_EQ(queue->CalculateByteSize(sizer_),
+              sizer_.CalculateByteSize(first));
+
+    MutationBatch second = queue->AddMutationBatch(
+        Timestamp::Now(), {},
+        {SetMutation("coll/b", Map()), SetMutation("coll/c", Map())});
+    EXPECT_EQ(queue->CalculateByteSize(sizer_),
+              sizer_.CalculateByteSize(first) +
+                  sizer_.CalculateByteSize(second));
+
+    queue->RemoveMutationBatch(first);
+    EXPECT_EQ(queue->CalculateByteSize(sizer_),
+              sizer_.CalculateByteSize(second));
+  });
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
@@ -0,0 +1,331 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/query_cursor.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Firestore/core/src/credentials/user.h"
+#include "Firestore/core/src/local/document_overlay_cache.h"
+#include "Firestore/core/src/local/index_manager.h"
+#include "Firestore/core/src/local/leveldb_persistence.h"
+#include "Firestore/core/src/local/local_documents_view.h"
+#include "Firestore/core/src/local/memory_persistence.h"
+#include "Firestore/core/src/local/mutation_queue.h"
+#include "Firestore/core/src/local/persistence.h"
+#include "Firestore/core/src/local/remote_document_cache.h"
+#include "Firestore/core/src/model/delete_mutation.h"
+#include "Firestore/core/src/model/mutable_document.h"
+#include "Firestore/core/src/model/mutation_batch.h"
+#include "Firestore/core/src/model/set_mutation.h"
+#include "Firestore/core/test/unit/local/counting_query_engine.h"
+#include "Firestore/core/test/unit/local/persistence_testing.h"
+#include "Firestore/core/test/unit/testutil/testutil.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+namespace {
+
+using credentials::User;
+using model::Document;
+using model::MutableDocument;
+using model::Mutation;
+using model::MutationBatch;
+using testutil::DbId;
+using testutil::DeleteMutation;
+using testutil::Doc;
+using testutil::Filter;
+using testutil::MakeFieldIndex;
+using testutil::Map;
+using testutil::OrderBy;
+using testutil::Query;
+using testutil::SetMutation;
+
+using FactoryFunc = std::unique_ptr<Persistence> (*)();
+
+std::unique_ptr<Persistence> MemoryPersistenceFactory() {
+  return MemoryPersistenceWithEagerGcForTesting();
+}
+
+std::unique_ptr<Persistence> LevelDbPersistenceFactory() {
+  return LevelDbPersistenceForTesting();
+}
+
+model::DocumentMap ToDocumentMap(const std::vector<MutableDocument>& docs) {
+  model::DocumentMap doc_map;
+  for (const auto& doc : docs) {
+    doc_map = doc_map.insert(doc.key(), doc);
+  }
+  return doc_map;
+}
+
+using Pages = std::vector<std::vector<std::string>>;
+
+class QueryCursorTest : public testing::TestWithParam<FactoryFunc> {
+ public:
+  QueryCursorTest()
+      : persistence_(GetParam()()),
+        remote_document_cache_(persistence_->remote_document_cache()),
+        document_overlay_cache_(
+            persistence_->GetDocumentOverlayCache(User::Unauthenticated())),
+        index_manager_(persistence_->GetIndexManager(User::Unauthenticated())),
+        mutation_queue_(persistence_->GetMutationQueue(User::Unauthenticated(),
+                                                       index_manager_)),
+        local_documents_view_(remote_document_cache_,
+                              mutation_queue_,
+                              document_overlay_cache_,
+                              index_manager_) {
+    remote_document_cache_->SetIndexManager(index_manager_);
+    query_engine_.Initialize(&local_documents_view_);
+  }
+
+ protected:
+  void AddDocuments(const std::vector<MutableDocument>& docs) {
+    for (const MutableDocument& doc : docs) {
+      remote_document_cache_->Add(doc, doc.version());
+    }
+  }
+
+  void AddMutation(Mutation mutation) {
+    MutationBatch batch =
+        mutation_queue_->AddMutationBatch(Timestamp::Now(), {}, {mutation});
+    model::MutationByDocumentKeyMap overlays{{mutation.key(), mutation}};
+    document_overlay_cache_->SaveOverlays(batch.batch_id(), overlays);
+  }
+
+  std::vector<Document> NextPage(QueryCursor& cursor) {
+    return cursor.NextPage(query_engine_.local_documents(), &query_engine_);
+  }
+
+  /** Reads all pages of the cursor and returns the paths of their documents. */
+  Pages ReadPages(QueryCursor& cursor) {
+    Pages pages;
+    while (!cursor.exhausted()) {
+      std::vector<std::string> paths;
+      for (const Document& doc : NextPage(cursor)) {
+        paths.push_back(doc->key().ToString());
+      }
+      if (!paths.empty()) {
+        pages.push_back(std::move(paths));
+      }
+    }
+    return pages;
+  }
+
+  std::unique_ptr<Persistence> persistence_;
+  RemoteDocumentCache* remote_document_cache_ = nullptr;
+  DocumentOverlayCache* document_overlay_cache_ = nullptr;
+  IndexManager* index_manager_ = nullptr;
+  MutationQueue* mutation_queue_ = nullptr;
+  LocalDocumentsView local_documents_view_;
+  CountingQueryEngine query_engine_;
+};
+
+TEST_P(QueryCursorTest, ReturnsPagesInKeyOrder) {
+  persistence_->Run("ReturnsPagesInKeyOrder", [&] {
+    mutation_queue_->Start();
+    index_manager_->Start();
+
+    AddDocuments({Doc("coll/a", 1, Map("matches", true)),
+                  Doc("coll/a/sub/a", 1, Map("matches", true)),
+                  Doc("coll/b", 1, Map("matches", false)),
+                  Doc("coll/c", 1, Map("matches", true)),
+                  Doc("coll/d", 1, Map("matches", true)),
+                  Doc("coll/e", 1, Map("matches", true)),
+                  Doc("other/a", 1, Map("matches", true))});
+
+    QueryCursor cursor(
+        Query("coll").AddingFilter(Filter("matches", "==", true)), DbId(), 2);
+    EXPECT_EQ(ReadPages(cursor),
+              (Pages{{"coll/a", "coll/c"}, {"coll/d", "coll/e"}}));
+  });
+}
+
+TEST_P(QueryCursorTest, AppliesLocalMutations) {
+  persistence_->Run("AppliesLocalMutations", [&] {
+    mutation_queue_->Start();
+    index_manager_->Start();
+
+    AddDocuments({Doc("coll/a", 1, Map("n", 1)), Doc("coll/c", 1, Map("n", 3)),
+                  Doc("coll/e", 1, Map("n", 5))});
+    AddMutation(SetMutation("coll/b", Map("n", 2)));
+    AddMutation(SetMutation("coll/f", Map("n", 6)));
+    AddMutation(DeleteMutation("coll/c"));
+
+    QueryCursor cursor(Query("coll"), DbId(), 2);
+    EXPECT_EQ(ReadPages(cursor),
+              (Pages{{"coll/a", "coll/b"}, {"coll/e", "coll/f"}}));
+  });
+}
+
+TEST_P(QueryCursorTest, ReturnsPagesInQueryOrder) {
+  persistence_->Run("ReturnsPagesInQueryOrder", [&] {
+    mutation_queue_->Start();
+    index_manager_->Start();
+
+    AddDocuments({Doc("coll/a", 1, Map("n", 3)), Doc("coll/b", 1, Map("n", 1)),
+                  Doc("coll/c", 1, Map("n", 5)), Doc("coll/d", 1, Map("n", 2)),
+                  Doc("coll/e", 1, Map("n", 4))});
+    AddMutation(SetMutation("coll/f", Map("n", 0)));
+
+    QueryCursor cursor(Query("coll").AddingOrderBy(OrderBy("n", "desc")),
+                       DbId(), 2);
+    EXPECT_EQ(ReadPages(cursor), (Pages{{"coll/c", "coll/e"},
+                                        {"coll/a", "coll/d"},
+                                        {"coll/b", "coll/f"}}));
+  });
+}
+
+TEST_P(QueryCursorTest, AppliesLimits) {
+  persistence_->Run("AppliesLimits", [&] {
+    mutation_queue_->Start();
+    index_manager_->Start();
+
+    AddDocuments({Doc("coll/a", 1, Map("n", 3)), Doc("coll/b", 1, Map("n", 1)),
+                  Doc("coll/c", 1, Map("n", 5)), Doc("coll/d", 1, Map("n", 2)),
+                  Doc("coll/e", 1, Map("n", 4))});
+
+    QueryCursor first(Query("coll").WithLimitToFirst(3), DbId(), 2);
+    EXPECT_EQ(ReadPages(first), (Pages{{"coll/a", "coll/b"}, {"coll/c"}}));
+
+    QueryCursor last(
+        Query("coll").AddingOrderBy(OrderBy("n")).WithLimitToLast(3), DbId(),
+        2);
+    EXPECT_EQ(ReadPages(last), (Pages{{"coll/a", "coll/e"}, {"coll/c"}}));
+  });
+}
+
+TEST_P(QueryCursorTest, ReadsOneChunkPerPageInKeyOrder) {
+  persistence_->Run("ReadsOneChunkPerPageInKeyOrder", [&] {
+    mutation_queue_->Start();
+    index_manager_->Start();
+
+    AddDocuments({Doc("coll/a", 1, Map("n", 1)), Doc("coll/b", 1, Map("n", 2)),
+                  Doc("coll/c", 1, Map("n", 3)), Doc("coll/d", 1, Map("n", 4)),
+                  Doc("coll/e", 1, Map("n", 5)),
+                  Doc("coll/f", 1, Map("n", 6))});
+    AddMutation(SetMutation("coll/b", Map("n", 20)));
+    AddMutation(SetMutation("coll/f", Map("n", 60)));
+
+    QueryCursor cursor(Query("coll"), DbId(), 2);
+    for (size_t page = 0; page < 3; ++page) {
+      query_engine_.ResetCounts();
+      EXPECT_EQ(NextPage(cursor).size(), 2u);
+      EXPECT_EQ(query_engine_.documents_read_by_query(), 2u);
+      // Only the overlays of the page's documents are read.
+      EXPECT_EQ(query_engine_.overlays_read_by_collection(),
+                page == 1 ? 0u : 1u);
+    }
+    EXPECT_TRUE(NextPage(cursor).empty());
+    EXPECT_TRUE(cursor.exhausted());
+  });
+}
+
+TEST_P(QueryCursorTest, ReturnsPagesFromFieldIndex) {
+  persistence_->Run("ReturnsPagesFromFieldIndex", [&] {
+    mutation_queue_->Start();
+    index_manager_->Start();
+
+    MutableDocument doc1 = Doc("coll/a", 1, Map("n", 2));
+    MutableDocument doc2 = Doc("coll/b", 1, Map("n", 1));
+    MutableDocument doc3 = Doc("coll/c", 1, Map("n", 2));
+    MutableDocument doc4 = Doc("coll/d", 1, Map("n", 2));
+    MutableDocument doc5 = Doc("coll/e", 2, Map("n", 3));
+    AddDocuments({doc1, doc2, doc3, doc4, doc5});
+    index_manager_->AddFieldIndex(
+        MakeFieldIndex("coll", "n", model::Segment::kAscending));
+    index_manager_->UpdateIndexEntries(
+        ToDocumentMap({doc1, doc2, doc3, doc4, doc5}));
+    index_manager_->UpdateCollectionGroup(
+        "coll", model::IndexOffset::FromDocument(doc5));
+
+    // Neither document is in the index yet.
+    AddDocuments({Doc("coll/f", 3, Map("n", 2))});
+    AddMutation(SetMutation("coll/g", Map("n", 2)));
+
+    // The documents with `n == 2` span three pages.
+    QueryCursor cursor(Query("coll").AddingOrderBy(OrderBy("n")), DbId(), 2);
+    EXPECT_EQ(ReadPages(cursor), (Pages{{"coll/b", "coll/a"},
+                                        {"coll/c", "coll/d"},
+                                        {"coll/f", "coll/g"},
+                                        {"coll/e"}}));
+  });
+}
+
+TEST_P(QueryCursorTest, ResumesFieldIndexAfterTiedDocuments) {
+  persistence_->Run("ResumesFieldIndexAfterTiedDocuments", [&] {
+    mutation_queue_->Start();
+    index_manager_->Start();
+
+    // All documents share the same `n`, so the index entries of each page
+    // start at the same value.
+    std::vector<MutableDocument> docs;
+    for (int i = 10; i < 22; ++i) {
+      docs.push_back(Doc("coll/d" + std::to_string(i), 1, Map("n", 1)));
+    }
+    AddDocuments(docs);
+    index_manager_->AddFieldIndex(
+        MakeFieldIndex("coll", "n", model::Segment::kAscending));
+    index_manager_->UpdateIndexEntries(ToDocumentMap(docs));
+    index_manager_->UpdateCollectionGroup(
+        "coll", model::IndexOffset::FromDocument(docs.back()));
+
+    QueryCursor cursor(Query("coll").AddingOrderBy(OrderBy("n")), DbId(), 5);
+    Pages pages;
+    while (!cursor.exhausted()) {
+      query_engine_.ResetCounts();
+      std::vector<std::string> paths;
+      for (const Document& doc : NextPage(cursor)) {
+        paths.push_back(doc->key().ToString());
+      }
+      // Only the entries after the last document returned are read.
+      EXPECT_EQ(query_engine_.documents_read_by_key(), paths.size());
+      EXPECT_EQ(query_engine_.documents_read_by_query(), 0u);
+      pages.push_back(std::move(paths));
+    }
+    EXPECT_EQ(pages, (Pages{{"coll/d10", "coll/d11", "coll/d12", "coll/d13",
+                             "coll/d14"},
+                            {"coll/d15", "coll/d16", "coll/d17", "coll/d18",
+                             "coll/d19"},
+                            {"coll/d20", "coll/d21"}}));
+
+    // A pending write makes the index entry of a document unreliable, which
+    // is made up for by reading one more entry.
+    AddMutation(SetMutation("coll/d12", Map("n", 1, "edited", true)));
+    AddMutation(SetMutation("coll/d17", Map("n", 2)));
+    QueryCursor edited(Query("coll").AddingOrderBy(OrderBy("n")), DbId(), 5);
+    EXPECT_EQ(ReadPages(edited), (Pages{{"coll/d10", "coll/d11", "coll/d12",
+                                         "coll/d13", "coll/d14"},
+                                        {"coll/d15", "coll/d16", "coll/d18",
+                                         "coll/d19", "coll/d20"},
+                                        {"coll/d21", "coll/d17"}}));
+  });
+}
+
+}  // namespace
+
+INSTANTIATE_TEST_SUITE_P(QueryCursorTest,
+                         QueryCursorTest,
+                         testing::Values(MemoryPersistenceFactory,
+                                         LevelDbPersistenceFactory));
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
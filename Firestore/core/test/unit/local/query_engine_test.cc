@@ -20,6 +20,8 @@
 
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "Firestore/core/src/core/field_filter.h"
 #include "Firestore/core/src/core/view.h"
@@ -29,6 +31,7 @@
 #include "Firestore/core/src/local/persistence.h"
 #include "Firestore/core/src/local/remote_document_cache.h"
 #include "Firestore/core/src/local/target_cache.h"
+#include "Firestore/core/src/model/aggregate_field.h"
 #include "Firestore/core/src/model/delete_mutation.h"
 #include "Firestore/core/src/model/document_key_set.h"
 #include "Firestore/core/src/model/model_fwd.h"
@@ -36,6 +39,7 @@
 #include "Firestore/core/src/model/mutation_batch.h"
 #include "Firestore/core/src/model/object_value.h"
 #include "Firestore/core/src/model/precondition.h"
+#include "Firestore/core/src/model/set_mutation.h"
 #include "Firestore/core/src/model/snapshot_version.h"
 #include "Firestore/core/test/unit/testutil/testutil.h"
 
@@ -54,6 +58,8 @@ using local::Persistence;
 using local::QueryEngine;
 using local::RemoteDocumentCache;
 using local::TargetCache;
+using model::AggregateAlias;
+using model::AggregateField;
 using model::BatchId;
 using model::DeleteMutation;
 using model::DocumentKey;
@@ -79,6 +85,7 @@ using testutil::Map;
 using testutil::OrderBy;
 using testutil::OrFilters;
 using testutil::Query;
+using testutil::SetMutation;
 using testutil::Version;
 
 const int kTestTargetId = 1;
@@ -977,6 +984,94 @@ TEST_P(QueryEngineTest, InAndNotInFiltersWithObjectValues) {
   });
 }
 
+TEST_P(QueryEngineTest, ComputesAggregatesOverLocalView) {
+  persistence_->Run("ComputesAggregatesOverLocalView", [&] {
+    mutation_queue_->Start();
+    index_manager_->Start();
+
+    AddDocuments({Doc("coll/a", 1, Map("matches", true, "n", 1)),
+                  Doc("coll/b", 1, Map("matches", true, "n", 2.5)),
+                  Doc("coll/c", 1, Map("matches", true, "n", "text")),
+                  Doc("coll/d", 1, Map("matches", false, "n", 100))});
+    AddMutation(SetMutation("coll/e", Map("matches", true, "n", 3)));
+
+    core::Query query =
+        Query("coll").AddingFilter(Filter("matches", "==", true));
+    std::vector<AggregateField> aggregates;
+    aggregates.emplace_back(AggregateField::OpKind::Count,
+                            AggregateAlias("count"));
+    aggregates.emplace_back(AggregateField::OpKind::Sum, AggregateAlias("sum"),
+                            testutil::Field("n"));
+    aggregates.emplace_back(AggregateField::OpKind::Avg, AggregateAlias("avg"),
+                            testutil::Field("n"));
+
+    ObjectValue result = query_engine_.ComputeAggregates(query, aggregates);
+
+    EXPECT_EQ(result.Get("count")->integer_value, 4);
+    EXPECT_DOUBLE_EQ(result.Get("sum")->double_value, 6.5);
+    EXPECT_DOUBLE_EQ(result.Get("avg")->double_value, 6.5 / 3);
+  });
+}
+
+TEST_P(QueryEngineTest, ComputesAggregatesOverLimitedResults) {
+  persistence_->Run("ComputesAggregatesOverLimitedResults", [&] {
+    mutation_queue_->Start();
+    index_manager_->Start();
+
+    AddDocuments({Doc("coll/a", 1, Map("n", 1)), Doc("coll/b", 1, Map("n", 2)),
+                  Doc("coll/c", 1, Map("n", 3))});
+
+    std::vector<AggregateField> aggregates;
+    aggregates.emplace_back(AggregateField::OpKind::Sum, AggregateAlias("sum"),
+                            testutil::Field("n"));
+
+    ObjectValue first = query_engine_.ComputeAggregates(
+        Query("coll").AddingOrderBy(OrderBy("n")).WithLimitToFirst(2),
+        aggregates);
+    EXPECT_EQ(first.Get("sum")->integer_value, 3);
+
+    ObjectValue last = query_engine_.ComputeAggregates(
+        Query("coll").AddingOrderBy(OrderBy("n")).WithLimitToLast(2),
+        aggregates);
+    EXPECT_EQ(last.Get("sum")->integer_value, 5);
+  });
+}
+
+TEST_P(QueryEngineTest, ComputesAggregatesAcrossChunks) {
+  persistence_->Run("ComputesAggregatesAcrossChunks", [&] {
+    mutation_queue_->Start();
+    index_manager_->Start();
+
+    // Spans several chunks of remote documents, with local writes in the
+    // middle and past the end of the remote documents.
+    std::vector<MutableDocument> docs;
+    for (int i = 0; i < 250; ++i) {
+      docs.push_back(Doc("coll/doc" + std::to_string(i), 1, Map("n", 1)));
+    }
+    AddDocuments(docs);
+    AddMutation(SetMutation("coll/doc150", Map("n", 10)));
+    AddMutation(SetMutation("coll/doc999", Map("n", 100)));
+    AddMutation(DeleteMutation(Key("coll/doc0"), Precondition::None()));
+
+    std::vector<AggregateField> aggregates;
+    aggregates.emplace_back(AggregateField::OpKind::Count,
+                            AggregateAlias("count"));
+    aggregates.emplace_back(AggregateField::OpKind::Sum, AggregateAlias("sum"),
+                            testutil::Field("n"));
+
+    ObjectValue result = query_engine_.ComputeAggregates(Query("coll"),
+                                                         aggregates);
+    EXPECT_EQ(result.Get("count")->integer_value, 250);
+    EXPECT_EQ(result.Get("sum")->integer_value, 248 + 10 + 100);
+
+    ObjectValue limited = query_engine_.ComputeAggregates(
+        Query("coll").AddingOrderBy(OrderBy("n", "desc")).WithLimitToFirst(3),
+        aggregates);
+    EXPECT_EQ(limited.Get("count")->integer_value, 3);
+    EXPECT_EQ(limited.Get("sum")->integer_value, 100 + 10 + 1);
+  });
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
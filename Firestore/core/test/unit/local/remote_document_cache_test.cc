@@ -216,6 +216,55 @@ TEST_P(RemoteDocumentCacheTest, DocumentsMatchingQuery) {
   });
 }
 
+TEST_P(RemoteDocumentCacheTest, DocumentsInCollection) {
+  persistence_->Run("test_documents_in_collection", [&] {
+    SetTestDocument("a/1");
+    SetTestDocument("b/1");
+    SetTestDocument("b/1/z/1");
+    SetTestDocument("b/2");
+    SetTestDocument("b/4");
+    SetTestDocument("c/1");
+    MutableDocument deleted = DeletedDoc("b/3", kVersion);
+    cache_->Add(deleted, deleted.version());
+
+    MutableDocumentMap first_page =
+        cache_->GetDocumentsInCollection(model::ResourcePath{"b"},
+                                         absl::nullopt, 2);
+    EXPECT_THAT(first_page,
+                HasExactlyDocs(std::vector<MutableDocument>{
+                    Doc("b/1", kVersion, Map("a", 1, "b", 2)),
+                    Doc("b/2", kVersion, Map("a", 1, "b", 2)),
+                }));
+
+    // Deleted documents are included so that the scan can be resumed.
+    MutableDocumentMap second_page = cache_->GetDocumentsInCollection(
+        model::ResourcePath{"b"}, Key("b/2"), 10);
+    EXPECT_THAT(second_page,
+                HasExactlyDocs(std::vector<MutableDocument>{
+                    deleted,
+                    Doc("b/4", kVersion, Map("a", 1, "b", 2)),
+                }));
+  });
+}
+
+TEST_P(RemoteDocumentCacheTest, DocumentsInCollectionGroup) {
+  persistence_->Run("test_documents_in_collection_group", [&] {
+    SetTestDocument("a/1/b/1", /* updateTime= */ 1, /* readTime= */ 11);
+    SetTestDocument("a/2/b/2", /* updateTime= */ 2, /* readTime= */ 12);
+    SetTestDocument("b/3", /* updateTime= */ 3, /* readTime= */ 13);
+    SetTestDocument("b/3/c/4", /* updateTime= */ 4, /* readTime= */ 14);
+    SetTestDocument("bb/5", /* updateTime= */ 5, /* readTime= */ 15);
+
+    MutableDocumentMap results = cache_->GetAll(
+        "b", model::IndexOffset::CreateSuccessor(Version(11)), 10);
+    std::vector<MutableDocument> docs = {
+        Doc("a/2/b/2", 2, Map("a", 1, "b", 2)),
+        Doc("b/3", 3, Map("a", 1, "b", 2)),
+    };
+    EXPECT_THAT(results, HasExactlyDocs(docs));
+  });
+}
+
 TEST_P(RemoteDocumentCacheTest, DocumentsMatchingQuerySinceReadTime) {
   persistence_->Run("test_documents_matching_query_since_read_time", [&] {
     SetTestDocument("b/old", /* updateTime= */ 1, /* readTime= */ 11);
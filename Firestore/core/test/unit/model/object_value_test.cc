@@ -335,6 +335,30 @@ TEST_F(ObjectValueTest, DoesNotRequireSortedInserts) {
   EXPECT_EQ(*Value(2), *object_value.Get(Field("nested.nested.c")));
 }
 
+TEST_F(ObjectValueTest, FingerprintsMatchEqualObjects) {
+  ObjectValue object_value = WrapObject("a", Map("b", kFooString), "c", 1);
+  ObjectValue other = WrapObject("c", 1, "a", Map("b", kFooString));
+  EXPECT_EQ(object_value.Fingerprint(), other.Fingerprint());
+  EXPECT_EQ(object_value, other);
+
+  other.Set(Field("a.b"), Value(kBarString));
+  EXPECT_NE(object_value.Fingerprint(), other.Fingerprint());
+  EXPECT_NE(object_value, other);
+
+  other.Set(Field("a.b"), Value(kFooString));
+  EXPECT_EQ(object_value.Fingerprint(), other.Fingerprint());
+  EXPECT_EQ(object_value, other);
+}
+
+TEST_F(ObjectValueTest, FingerprintsResetOnDelete) {
+  ObjectValue object_value = WrapObject("a", 1, "b", 2);
+  uint64_t fingerprint = object_value.Fingerprint();
+
+  object_value.Delete(Field("b"));
+  EXPECT_NE(fingerprint, object_value.Fingerprint());
+  EXPECT_EQ(WrapObject("a", 1).Fingerprint(), object_value.Fingerprint());
+}
+
 }  // namespace
 
 }  // namespace model
@@ -15,6 +15,7 @@
  */
 
 #include <limits>
+#include <vector>
 
 #include "Firestore/core/include/firebase/firestore/geo_point.h"
 #include "Firestore/core/src/model/database_id.h"
@@ -545,6 +546,60 @@ TEST_F(ValueUtilTest, DeepClone) {
   VerifyDeepClone(Map("a", Array("b", Map("c", GeoPoint(30, 60)))));
 }
 
+TEST_F(ValueUtilTest, SortFields) {
+  auto keys = [](const google_firestore_v1_Value& value) {
+    std::vector<absl::string_view> result;
+    for (pb_size_t i = 0; i < value.map_value.fields_count; ++i) {
+      result.push_back(nanopb::MakeStringView(value.map_value.fields[i].key));
+    }
+    return result;
+  };
+
+  Message<google_firestore_v1_Value> sorted = Map("a", 1, "b", Map("c", 2));
+  SortFields(*sorted);
+  EXPECT_EQ(keys(*sorted), (std::vector<absl::string_view>{"a", "b"}));
+
+  Message<google_firestore_v1_Value> unsorted =
+      Map("b", 1, "a", Array(Map("d", 2, "c", 3)));
+  SortFields(*unsorted);
+  EXPECT_EQ(keys(*unsorted), (std::vector<absl::string_view>{"a", "b"}));
+  const google_firestore_v1_Value& nested =
+      unsorted->map_value.fields[0].value.array_value.values[0];
+  EXPECT_EQ(keys(nested), (std::vector<absl::string_view>{"c", "d"}));
+}
+
+TEST_F(ValueUtilTest, Fingerprint) {
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  std::vector<std::vector<Message<google_firestore_v1_Value>>> groups;
+  auto group = [&](Message<google_firestore_v1_Value> lhs,
+                   Message<google_firestore_v1_Value> rhs) {
+    std::vector<Message<google_firestore_v1_Value>> values;
+    values.push_back(std::move(lhs));
+    values.push_back(std::move(rhs));
+    groups.push_back(std::move(values));
+  };
+  group(Value(nullptr), Value(nullptr));
+  group(Value(true), Value(true));
+  group(Value(1), Value(1));
+  group(Value(1.0), Value(1.0));
+  group(Value(nan), Value(-nan));
+  group(Value("a"), Value("a"));
+  group(Value(BlobValue(1, 2)), Value(BlobValue(1, 2)));
+  group(Value(GeoPoint(0, 1)), Value(GeoPoint(-0.0, 1)));
+  group(Value(Array(1, "b")), Value(Array(1, "b")));
+  group(Map("a", 1, "b", Map("c", 2)), Map("a", 1, "b", Map("c", 2)));
+  group(Map("ab", "c"), Map("ab", "c"));
+  group(Map("a", "bc"), Map("a", "bc"));
+
+  for (size_t i = 0; i < groups.size(); ++i) {
+    EXPECT_EQ(Fingerprint(*groups[i][0]), Fingerprint(*groups[i][1]));
+    for (size_t j = i + 1; j < groups.size(); ++j) {
+      EXPECT_NE(Fingerprint(*groups[i][0]), Fingerprint(*groups[j][0]))
+          << *groups[i][0] << " and " << *groups[j][0];
+    }
+  }
+}
+
 }  // namespace
 
 }  // namespace model
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/test/unit/remote/fake_datastore.h"
+
+#include <utility>
+
+#include "Firestore/core/src/credentials/empty_credentials_provider.h"
+#include "Firestore/core/src/remote/serializer.h"
+#include "Firestore/core/src/util/hard_assert.h"
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+
+using credentials::EmptyAppCheckCredentialsProvider;
+using credentials::EmptyAuthCredentialsProvider;
+using local::TargetData;
+using model::Mutation;
+using model::MutationResult;
+using model::SnapshotVersion;
+using model::TargetId;
+using util::AsyncQueue;
+using util::Status;
+
+// FakeWatchStream
+
+FakeWatchStream::FakeWatchStream(
+    const std::shared_ptr<AsyncQueue>& worker_queue,
+    Serializer serializer,
+    GrpcConnection* grpc_connection,
+    WatchStreamCallback* callback)
+    : WatchStream{worker_queue,
+                  std::make_shared<EmptyAuthCredentialsProvider>(),
+                  std::make_shared<EmptyAppCheckCredentialsProvider>(),
+                  std::move(serializer),
+                  grpc_connection,
+                  callback},
+      callback_{callback} {
+}
+
+void FakeWatchStream::Start() {
+  HARD_ASSERT(!open_, "Trying to start already started watch stream");
+  open_ = true;
+  callback_->OnWatchStreamOpen();
+}
+
+void FakeWatchStream::Stop() {
+  open_ = false;
+  active_targets_.clear();
+}
+
+bool FakeWatchStream::IsStarted() const {
+  return open_;
+}
+
+bool FakeWatchStream::IsOpen() const {
+  return open_;
+}
+
+void FakeWatchStream::WatchQuery(const TargetData& target_data) {
+  active_targets_[target_data.target_id()] = target_data;
+  ++watch_counts_[target_data.target_id()];
+}
+
+void FakeWatchStream::UnwatchTargetId(TargetId target_id) {
+  active_targets_.erase(target_id);
+}
+
+void FakeWatchStream::SendWatchChange(const WatchChange& change,
+                                      const SnapshotVersion& snapshot_version) {
+  callback_->OnWatchStreamChange(change, snapshot_version);
+}
+
+void FakeWatchStream::FailStream(const Status& error) {
+  open_ = false;
+  active_targets_.clear();
+  callback_->OnWatchStreamClose(error);
+}
+
+int FakeWatchStream::watch_count(TargetId target_id) const {
+  auto found = watch_counts_.find(target_id);
+  return found == watch_counts_.end() ? 0 : found->second;
+}
+
+// FakeWriteStream
+
+FakeWriteStream::FakeWriteStream(
+    const std::shared_ptr<AsyncQueue>& worker_queue,
+    Serializer serializer,
+    GrpcConnection* grpc_connection,
+    WriteStreamCallback* callback)
+    : WriteStream{worker_queue,
+                  std::make_shared<EmptyAuthCredentialsProvider>(),
+                  std::make_shared<EmptyAppCheckCredentialsProvider>(),
+                  std::move(serializer),
+                  grpc_connection,
+                  callback},
+      callback_{callback} {
+}
+
+void FakeWriteStream::Start() {
+  HARD_ASSERT(!open_, "Trying to start already started write stream");
+  open_ = true;
+  sent_writes_ = {};
+  callback_->OnWriteStreamOpen();
+}
+
+void FakeWriteStream::Stop() {
+  sent_writes_ = {};
+  open_ = false;
+  SetHandshakeComplete(false);
+}
+
+bool FakeWriteStream::IsStarted() const {
+  return open_;
+}
+
+bool FakeWriteStream::IsOpen() const {
+  return open_;
+}
+
+void FakeWriteStream::WriteHandshake() {
+  SetHandshakeComplete();
+  callback_->OnWriteStreamHandshakeComplete();
+}
+
+size_t FakeWriteStream::WriteMutations(const std::vector<Mutation>& mutations) {
+  sent_writes_.push(mutations);
+  return 0;
+}
+
+void FakeWriteStream::AckWrite(const SnapshotVersion& commit_version,
+                               std::vector<MutationResult> results) {
+  callback_->OnWriteStreamMutationResult(commit_version, std::move(results));
+}
+
+void FakeWriteStream::FailStream(const Status& error) {
+  open_ = false;
+  callback_->OnWriteStreamClose(error);
+}
+
+std::vector<Mutation> FakeWriteStream::NextSentWrite() {
+  HARD_ASSERT(!sent_writes_.empty(), "No write was sent");
+  std::vector<Mutation> result = std::move(sent_writes_.front());
+  sent_writes_.pop();
+  return result;
+}
+
+// FakeDatastore
+
+FakeDatastore::FakeDatastore(
+    const core::DatabaseInfo& database_info,
+    const std::shared_ptr<AsyncQueue>& worker_queue,
+    ConnectivityMonitor* connectivity_monitor,
+    FirebaseMetadataProvider* firebase_metadata_provider)
+    : Datastore{database_info,
+                worker_queue,
+                std::make_shared<EmptyAuthCredentialsProvider>(),
+                std::make_shared<EmptyAppCheckCredentialsProvider>(),
+                connectivity_monitor,
+                firebase_metadata_provider},
+      database_id_{database_info.database_id()},
+      worker_queue_{worker_queue} {
+}
+
+std::shared_ptr<WatchStream> FakeDatastore::CreateWatchStream(
+    WatchStreamCallback* callback) {
+  watch_stream_ = std::make_shared<FakeWatchStream>(
+      worker_queue_, Serializer{database_id_}, grpc_connection(), callback);
+  return watch_stream_;
+}
+
+std::shared_ptr<WriteStream> FakeDatastore::CreateWriteStream(
+    WriteStreamCallback* callback) {
+  write_stream_ = std::make_shared<FakeWriteStream>(
+      worker_queue_, Serializer{database_id_}, grpc_connection(), callback);
+  return write_stream_;
+}
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
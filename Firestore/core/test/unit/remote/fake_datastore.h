@@ -0,0 +1,165 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_TEST_UNIT_REMOTE_FAKE_DATASTORE_H_
+#define FIRESTORE_CORE_TEST_UNIT_REMOTE_FAKE_DATASTORE_H_
+
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "Firestore/core/src/core/database_info.h"
+#include "Firestore/core/src/local/target_data.h"
+#include "Firestore/core/src/model/database_id.h"
+#include "Firestore/core/src/model/mutation.h"
+#include "Firestore/core/src/model/snapshot_version.h"
+#include "Firestore/core/src/model/types.h"
+#include "Firestore/core/src/remote/datastore.h"
+#include "Firestore/core/src/remote/watch_change.h"
+#include "Firestore/core/src/remote/watch_stream.h"
+#include "Firestore/core/src/remote/write_stream.h"
+#include "Firestore/core/src/util/async_queue.h"
+#include "Firestore/core/src/util/status.h"
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+
+class ConnectivityMonitor;
+class FirebaseMetadataProvider;
+
+/**
+ * A watch stream that never touches the network: the targets it is asked to
+ * watch are recorded and changes are injected by the test. Starting the stream
+ * opens it immediately.
+ */
+class FakeWatchStream : public WatchStream {
+ public:
+  FakeWatchStream(const std::shared_ptr<util::AsyncQueue>& worker_queue,
+                  Serializer serializer,
+                  GrpcConnection* grpc_connection,
+                  WatchStreamCallback* callback);
+
+  void Start() override;
+  void Stop() override;
+  bool IsStarted() const override;
+  bool IsOpen() const override;
+
+  void WatchQuery(const local::TargetData& target_data) override;
+  void UnwatchTargetId(model::TargetId target_id) override;
+
+  /**
+   * Delivers `change` as though it had come from the backend. A snapshot
+   * version other than `None()` marks a consistent global snapshot.
+   */
+  void SendWatchChange(const WatchChange& change,
+                       const model::SnapshotVersion& snapshot_version =
+                           model::SnapshotVersion::None());
+
+  /** Closes the stream as though the backend had failed it. */
+  void FailStream(const util::Status& error);
+
+  /** The targets currently being watched, by target ID. */
+  const std::unordered_map<model::TargetId, local::TargetData>&
+  active_targets() const {
+    return active_targets_;
+  }
+
+  /** The number of times `target_id` has been watched on any stream. */
+  int watch_count(model::TargetId target_id) const;
+
+ private:
+  bool open_ = false;
+  std::unordered_map<model::TargetId, local::TargetData> active_targets_;
+  std::unordered_map<model::TargetId, int> watch_counts_;
+  WatchStreamCallback* callback_ = nullptr;
+};
+
+/**
+ * A write stream that never touches the network: requests are recorded and
+ * responses are injected by the test. Starting the stream opens it and
+ * completes the handshake immediately.
+ */
+class FakeWriteStream : public WriteStream {
+ public:
+  FakeWriteStream(const std::shared_ptr<util::AsyncQueue>& worker_queue,
+                  Serializer serializer,
+                  GrpcConnection* grpc_connection,
+                  WriteStreamCallback* callback);
+
+  void Start() override;
+  void Stop() override;
+  bool IsStarted() const override;
+  bool IsOpen() const override;
+
+  void WriteHandshake() override;
+  size_t WriteMutations(const std::vector<model::Mutation>& mutations) override;
+
+  /** Acknowledges the oldest unacknowledged write request. */
+  void AckWrite(const model::SnapshotVersion& commit_version,
+                std::vector<model::MutationResult> results);
+
+  /** Closes the stream as though the backend had failed it. */
+  void FailStream(const util::Status& error);
+
+  /** The number of write requests not yet returned by `NextSentWrite()`. */
+  size_t sent_write_count() const {
+    return sent_writes_.size();
+  }
+
+  /** Returns the mutations of the oldest write request not yet returned. */
+  std::vector<model::Mutation> NextSentWrite();
+
+ private:
+  bool open_ = false;
+  std::queue<std::vector<model::Mutation>> sent_writes_;
+  WriteStreamCallback* callback_ = nullptr;
+};
+
+/** A `Datastore` whose streams are `FakeWatchStream` and `FakeWriteStream`. */
+class FakeDatastore : public Datastore {
+ public:
+  FakeDatastore(const core::DatabaseInfo& database_info,
+                const std::shared_ptr<util::AsyncQueue>& worker_queue,
+                ConnectivityMonitor* connectivity_monitor,
+                FirebaseMetadataProvider* firebase_metadata_provider);
+
+  std::shared_ptr<WatchStream> CreateWatchStream(
+      WatchStreamCallback* callback) override;
+  std::shared_ptr<WriteStream> CreateWriteStream(
+      WriteStreamCallback* callback) override;
+
+  FakeWatchStream* watch_stream() {
+    return watch_stream_.get();
+  }
+
+  FakeWriteStream* write_stream() {
+    return write_stream_.get();
+  }
+
+ private:
+  model::DatabaseId database_id_;
+  std::shared_ptr<util::AsyncQueue> worker_queue_;
+  std::shared_ptr<FakeWatchStream> watch_stream_;
+  std::shared_ptr<FakeWriteStream> write_stream_;
+};
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_TEST_UNIT_REMOTE_FAKE_DATASTORE_H_
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/remote/remote_store.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Firestore/core/src/core/database_info.h"
+#include "Firestore/core/src/credentials/user.h"
+#include "Firestore/core/src/local/local_store.h"
+#include "Firestore/core/src/local/local_write_result.h"
+#include "Firestore/core/src/local/memory_persistence.h"
+#include "Firestore/core/src/local/query_engine.h"
+#include "Firestore/core/src/model/database_id.h"
+#include "Firestore/core/src/model/mutation.h"
+#include "Firestore/core/src/model/mutation_batch_result.h"
+#include "Firestore/core/src/model/set_mutation.h"
+#include "Firestore/core/src/remote/firebase_metadata_provider.h"
+#include "Firestore/core/src/remote/firebase_metadata_provider_noop.h"
+#include "Firestore/core/src/remote/write_pipeline_controller.h"
+#include "Firestore/core/src/util/async_queue.h"
+#include "Firestore/core/src/util/status.h"
+#include "Firestore/core/test/unit/local/persistence_testing.h"
+#include "Firestore/core/test/unit/remote/create_noop_connectivity_monitor.h"
+#include "Firestore/core/test/unit/remote/fake_datastore.h"
+#include "Firestore/core/test/unit/testutil/async_testing.h"
+#include "Firestore/core/test/unit/testutil/testutil.h"
+#include "absl/memory/memory.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+namespace {
+
+using core::DatabaseInfo;
+using credentials::User;
+using local::LocalStore;
+using local::Persistence;
+using local::QueryEngine;
+using model::BatchId;
+using model::DatabaseId;
+using model::DocumentKeySet;
+using model::Mutation;
+using model::MutationBatchResult;
+using model::MutationResult;
+using model::OnlineState;
+using model::TargetId;
+using testutil::Map;
+using testutil::SetMutation;
+using testutil::Version;
+using util::AsyncQueue;
+using util::Status;
+
+/**
+ * Records the outcome of every batch, passing it on to the `LocalStore` like
+ * `SyncEngine` does.
+ */
+class WriteCapture : public RemoteStoreCallback {
+ public:
+  explicit WriteCapture(LocalStore* local_store) : local_store_{local_store} {
+  }
+
+  void ApplyRemoteEvent(const RemoteEvent&) override {
+  }
+  void HandleRejectedListen(TargetId, Status) override {
+  }
+
+  void HandleSuccessfulWrite(MutationBatchResult batch_result) override {
+    local_store_->AcknowledgeBatch(batch_result);
+    acknowledged.push_back(std::move(batch_result));
+  }
+
+  void HandleRejectedWrite(BatchId batch_id, Status) override {
+    local_store_->RejectBatch(batch_id);
+    rejected.push_back(batch_id);
+  }
+
+  void HandleOnlineStateChange(OnlineState) override {
+  }
+
+  DocumentKeySet GetRemoteKeys(TargetId) const override {
+    return DocumentKeySet{};
+  }
+
+  std::vector<MutationBatchResult> acknowledged;
+  std::vector<BatchId> rejected;
+
+ private:
+  LocalStore* local_store_ = nullptr;
+};
+
+std::vector<MutationResult> MutationResults(std::vector<int64_t> versions) {
+  std::vector<MutationResult> results;
+  for (int64_t version : versions) {
+    results.push_back(testutil::MutationResult(version));
+  }
+  return results;
+}
+
+class RemoteStoreTest : public testing::Test {
+ public:
+  RemoteStoreTest()
+      : database_info_{DatabaseId{"p", "d"}, "", "localhost", false},
+        worker_queue_{testutil::AsyncQueueForTesting()},
+        persistence_{local::MemoryPersistenceWithEagerGcForTesting()},
+        local_store_{persistence_.get(), &query_engine_,
+                     User::Unauthenticated()},
+        capture_{&local_store_},
+        connectivity_monitor_{CreateNoOpConnectivityMonitor()},
+        firebase_metadata_provider_{CreateFirebaseMetadataProviderNoOp()},
+        datastore_{std::make_shared<FakeDatastore>(
+            database_info_, worker_queue_, connectivity_monitor_.get(),
+            firebase_metadata_provider_.get())} {
+    worker_queue_->EnqueueBlocking([&] {
+      local_store_.Start();
+      remote_store_ = absl::make_unique<RemoteStore>(
+          &local_store_, datastore_, worker_queue_,
+          connectivity_monitor_.get(), [](OnlineState) {});
+      remote_store_->set_sync_engine(&capture_);
+      remote_store_->Start();
+    });
+  }
+
+  ~RemoteStoreTest() override {
+    worker_queue_->EnqueueBlocking([&] { remote_store_->Shutdown(); });
+  }
+
+ protected:
+  /**
+   * Makes the write pipeline observe a high round trip time, so that adjacent
+   * batches get coalesced. Must be called while no write is outstanding.
+   */
+  void SimulateHighLatency() {
+    WritePipelineController& controller =
+        remote_store_->write_pipeline_controller();
+    auto now = WritePipelineController::Clock::now();
+    controller.RecordRequestSent(1, 0, now - std::chrono::seconds(1));
+    controller.RecordResponse(now);
+    ASSERT_TRUE(controller.ShouldCoalesce());
+  }
+
+  BatchId Write(std::vector<Mutation>&& mutations) {
+    return local_store_.WriteLocally(std::move(mutations)).batch_id();
+  }
+
+  FakeWriteStream* write_stream() {
+    return datastore_->write_stream();
+  }
+
+  DatabaseInfo database_info_;
+  std::shared_ptr<AsyncQueue> worker_queue_;
+  std::unique_ptr<Persistence> persistence_;
+  QueryEngine query_engine_;
+  LocalStore local_store_;
+  WriteCapture capture_;
+  std::unique_ptr<ConnectivityMonitor> connectivity_monitor_;
+  std::unique_ptr<FirebaseMetadataProvider> firebase_metadata_provider_;
+  std::shared_ptr<FakeDatastore> datastore_;
+  std::unique_ptr<RemoteStore> remote_store_;
+};
+
+TEST_F(RemoteStoreTest, SplitsResultsOfCoalescedBatches) {
+  worker_queue_->EnqueueBlocking([&] {
+    SimulateHighLatency();
+    BatchId first = Write({SetMutation("coll/a", Map("value", 1))});
+    BatchId second = Write({SetMutation("coll/b", Map("value", 2)),
+                            SetMutation("coll/c", Map("value", 3))});
+    remote_store_->FillWritePipeline();
+
+    ASSERT_EQ(write_stream()->sent_write_count(), 1u);
+    EXPECT_EQ(write_stream()->NextSentWrite().size(), 3u);
+
+    write_stream()->AckWrite(Version(20), MutationResults({11, 12, 13}));
+
+    ASSERT_EQ(capture_.acknowledged.size(), 2u);
+    const MutationBatchResult& first_result = capture_.acknowledged[0];
+    EXPECT_EQ(first_result.batch().batch_id(), first);
+    EXPECT_EQ(first_result.commit_version(), Version(20));
+    ASSERT_EQ(first_result.mutation_results().size(), 1u);
+    EXPECT_EQ(first_result.mutation_results()[0].version(), Version(11));
+
+    const MutationBatchResult& second_result = capture_.acknowledged[1];
+    EXPECT_EQ(second_result.batch().batch_id(), second);
+    EXPECT_EQ(second_result.commit_version(), Version(20));
+    ASSERT_EQ(second_result.mutation_results().size(), 2u);
+    EXPECT_EQ(second_result.mutation_results()[0].version(), Version(12));
+    EXPECT_EQ(second_result.mutation_results()[1].version(), Version(13));
+  });
+}
+
+TEST_F(RemoteStoreTest, ResendsBatchesOfRejectedCoalescedRequestOneByOne) {
+  worker_queue_->EnqueueBlocking([&] {
+    SimulateHighLatency();
+    BatchId first = Write({SetMutation("coll/a", Map())});
+    BatchId second = Write({SetMutation("coll/b", Map())});
+    BatchId third = Write({SetMutation("coll/c", Map())});
+    remote_store_->FillWritePipeline();
+
+    ASSERT_EQ(write_stream()->sent_write_count(), 1u);
+    EXPECT_EQ(write_stream()->NextSentWrite().size(), 3u);
+
+    // None of the batches is rejected yet: the stream is restarted and each
+    // batch is resent on its own to find the offending one.
+    Status rejection{Error::kErrorInvalidArgument, "Invalid write"};
+    write_stream()->FailStream(rejection);
+    EXPECT_TRUE(capture_.rejected.empty());
+    ASSERT_EQ(write_stream()->sent_write_count(), 3u);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(write_stream()->NextSentWrite().size(), 1u);
+    }
+
+    write_stream()->AckWrite(Version(20), MutationResults({20}));
+    write_stream()->FailStream(rejection);
+    EXPECT_EQ(capture_.rejected, std::vector<BatchId>{second});
+
+    // The batch after the rejected one is still sent on its own.
+    ASSERT_EQ(write_stream()->sent_write_count(), 1u);
+    EXPECT_EQ(write_stream()->NextSentWrite().size(), 1u);
+    write_stream()->AckWrite(Version(30), MutationResults({30}));
+
+    ASSERT_EQ(capture_.acknowledged.size(), 2u);
+    EXPECT_EQ(capture_.acknowledged[0].batch().batch_id(), first);
+    EXPECT_EQ(capture_.acknowledged[1].batch().batch_id(), third);
+
+    // Later batches are coalesced again.
+    Write({SetMutation("coll/d", Map())});
+    Write({SetMutation("coll/e", Map())});
+    remote_store_->FillWritePipeline();
+    ASSERT_EQ(write_stream()->sent_write_count(), 1u);
+    EXPECT_EQ(write_stream()->NextSentWrite().size(), 2u);
+  });
+}
+
+}  // namespace
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
@@ -83,6 +83,7 @@ using model::ArrayTransform;
 using model::DatabaseId;
 using model::DeleteMutation;
 using model::DocumentKey;
+using model::DocumentKeySet;
 using model::FieldPath;
 using model::GetTypeOrder;
 using model::MutableDocument;
@@ -1125,6 +1126,22 @@ TEST_F(SerializerTest, EncodesFirstLevelKeyQueries) {
   ExpectRoundTrip(model, proto);
 }
 
+TEST_F(SerializerTest, EncodesMultiDocumentTargets) {
+  DocumentKeySet keys{Key("docs/1"), Key("docs/2"), Key("rooms/a/messages/b")};
+  TargetData model(core::Target::ForDocuments(keys), 1, 0,
+                   QueryPurpose::Listen);
+
+  v1::Target proto;
+  proto.mutable_documents()->add_documents(ResourceName("docs/1"));
+  proto.mutable_documents()->add_documents(ResourceName("docs/2"));
+  proto.mutable_documents()->add_documents(
+      ResourceName("rooms/a/messages/b"));
+  proto.set_target_id(1);
+
+  SCOPED_TRACE("EncodesMultiDocumentTargets");
+  ExpectRoundTrip(model, proto);
+}
+
 TEST_F(SerializerTest, EncodesTargetDataWithExpectedResumeType) {
   TargetData target = CreateTargetData("docs/1");
 
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/remote/write_pipeline_controller.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+
+namespace chr = std::chrono;
+
+using Clock = WritePipelineController::Clock;
+
+namespace {
+
+/** Sends and acknowledges a single-batch request that took `rtt`. */
+void RoundTrip(WritePipelineController& controller, chr::milliseconds rtt) {
+  Clock::time_point sent = Clock::now();
+  controller.RecordRequestSent(1, 100, sent);
+  controller.RecordResponse(sent + rtt);
+}
+
+}  // namespace
+
+TEST(WritePipelineControllerTest, StartsAtMinimumDepth) {
+  WritePipelineController controller;
+  EXPECT_EQ(controller.max_pending_batches(),
+            WritePipelineController::kMinPendingBatches);
+  EXPECT_FALSE(controller.ShouldCoalesce());
+
+  EXPECT_TRUE(controller.CanAddBatch(0));
+  EXPECT_TRUE(controller.CanAddBatch(9));
+  EXPECT_FALSE(controller.CanAddBatch(10));
+}
+
+TEST(WritePipelineControllerTest, StaysAtMinimumDepthOnLowLatencyLinks) {
+  WritePipelineController controller;
+  for (int i = 0; i < 20; ++i) {
+    RoundTrip(controller, chr::milliseconds(30));
+  }
+
+  EXPECT_EQ(controller.smoothed_rtt(), chr::milliseconds(30));
+  EXPECT_EQ(controller.max_pending_batches(),
+            WritePipelineController::kMinPendingBatches);
+  EXPECT_FALSE(controller.ShouldCoalesce());
+}
+
+TEST(WritePipelineControllerTest, GrowsWithLatency) {
+  WritePipelineController controller;
+  RoundTrip(controller, chr::milliseconds(800));
+
+  EXPECT_EQ(controller.max_pending_batches(), 40u);
+  EXPECT_TRUE(controller.ShouldCoalesce());
+  EXPECT_TRUE(controller.CanAddBatch(39));
+  EXPECT_FALSE(controller.CanAddBatch(40));
+}
+
+TEST(WritePipelineControllerTest, DepthIsCapped) {
+  WritePipelineController controller;
+  RoundTrip(controller, chr::seconds(60));
+
+  EXPECT_EQ(controller.max_pending_batches(),
+            WritePipelineController::kMaxPendingBatches);
+}
+
+TEST(WritePipelineControllerTest, SmoothsRoundTripTime) {
+  WritePipelineController controller;
+  RoundTrip(controller, chr::milliseconds(800));
+  RoundTrip(controller, chr::milliseconds(0));
+
+  EXPECT_EQ(controller.smoothed_rtt(), chr::milliseconds(700));
+}
+
+TEST(WritePipelineControllerTest, IgnoresQueueingBehindEarlierRequests) {
+  WritePipelineController controller;
+
+  // The backend takes 50ms to process each request, one after the other. The
+  // later requests of a burst are only acknowledged after waiting for the
+  // earlier ones.
+  for (int burst = 0; burst < 5; ++burst) {
+    Clock::time_point sent = Clock::now();
+    for (int i = 0; i < 30; ++i) {
+      controller.RecordRequestSent(1, 100, sent);
+    }
+    for (int i = 1; i <= 30; ++i) {
+      controller.RecordResponse(sent + chr::milliseconds(50 * i));
+    }
+  }
+
+  EXPECT_EQ(controller.smoothed_rtt(), chr::milliseconds(50));
+  EXPECT_EQ(controller.max_pending_batches(),
+            WritePipelineController::kMinPendingBatches);
+  EXPECT_FALSE(controller.ShouldCoalesce());
+}
+
+TEST(WritePipelineControllerTest, TracksOutstandingRequestsInOrder) {
+  WritePipelineController controller;
+  controller.RecordRequestSent(3, 300);
+  controller.RecordRequestSent(1, 50);
+
+  EXPECT_EQ(controller.sent_batch_count(), 4u);
+  EXPECT_EQ(controller.bytes_in_flight(), 350u);
+  EXPECT_EQ(controller.head_request_batch_count(), 3u);
+
+  EXPECT_EQ(controller.RecordResponse(), 3u);
+  EXPECT_EQ(controller.sent_batch_count(), 1u);
+  EXPECT_EQ(controller.bytes_in_flight(), 50u);
+  EXPECT_EQ(controller.head_request_batch_count(), 1u);
+
+  EXPECT_EQ(controller.RecordResponse(), 1u);
+  EXPECT_EQ(controller.sent_batch_count(), 0u);
+  EXPECT_EQ(controller.head_request_batch_count(), 0u);
+}
+
+TEST(WritePipelineControllerTest, LimitsBytesInFlight) {
+  WritePipelineController controller;
+  controller.RecordRequestSent(1, WritePipelineController::kMaxBytesInFlight);
+
+  // A single oversized batch must not stall the pipeline.
+  EXPECT_TRUE(controller.CanAddBatch(0));
+  EXPECT_FALSE(controller.CanAddBatch(1));
+
+  controller.ClearOutstandingRequests();
+  EXPECT_EQ(controller.bytes_in_flight(), 0u);
+  EXPECT_EQ(controller.sent_batch_count(), 0u);
+  EXPECT_TRUE(controller.CanAddBatch(1));
+}
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
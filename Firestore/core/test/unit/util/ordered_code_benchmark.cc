@@ -14,13 +14,55 @@
  * limitations under the License.
  */
 
+#include <string>
+#include <vector>
+
+#include "Firestore/core/src/util/autoid.h"
 #include "Firestore/core/src/util/ordered_code.h"
 #include "Firestore/core/src/util/secure_random.h"
 #include "benchmark/benchmark.h"
 
+using firebase::firestore::util::CreateAutoId;
 using firebase::firestore::util::OrderedCode;
 using firebase::firestore::util::SecureRandom;
 
+namespace {
+
+// The component labels used by LevelDbRemoteDocumentKey, see leveldb_key.cc.
+const int64_t kTableNameLabel = 5;
+const int64_t kPathSegmentLabel = 62;
+const int64_t kTerminatorLabel = 0;
+
+/**
+ * Creates the segments of `count` document paths with `depth` collections
+ * each, alternating short collection ids and 20 character auto ids like the
+ * document paths of a typical app.
+ */
+std::vector<std::vector<std::string>> MakeDocumentPaths(int count,
+                                                        int64_t depth) {
+  std::vector<std::vector<std::string>> paths(count);
+  for (int i = 0; i < count; ++i) {
+    for (int64_t level = 0; level < depth; ++level) {
+      paths[i].push_back("collection" + std::to_string(level));
+      paths[i].push_back(CreateAutoId());
+    }
+  }
+  return paths;
+}
+
+/** Encodes `path` the way LevelDbRemoteDocumentKey::Key() does. */
+void WriteDocumentKey(std::string* dest, const std::vector<std::string>& path) {
+  OrderedCode::WriteSignedNumIncreasing(dest, kTableNameLabel);
+  OrderedCode::WriteString(dest, "remote_document");
+  for (const std::string& segment : path) {
+    OrderedCode::WriteSignedNumIncreasing(dest, kPathSegmentLabel);
+    OrderedCode::WriteString(dest, segment);
+  }
+  OrderedCode::WriteSignedNumIncreasing(dest, kTerminatorLabel);
+}
+
+}  // namespace
+
 static void BM_SkipToNextSpecialByte(benchmark::State& state) {
   // Use enough distinct values to confuse the branch predictor
   SecureRandom rnd;
@@ -61,3 +103,96 @@ BENCHMARK(BM_SkipToNextSpecialByte)
     ->Arg(1 << 9)
     ->Arg(1 << 10)
     ->Arg(1 << 15);
+
+static void BM_WriteString(benchmark::State& state) {
+  // Path segments are mostly short identifiers without special bytes.
+  const int kValues = 1024;
+  std::vector<std::string> values(kValues);
+  for (int i = 0; i < kValues; ++i) {
+    values[i] = CreateAutoId().substr(0, static_cast<size_t>(state.range(0)));
+  }
+
+  int index = 0;
+  int64_t total_bytes = 0;
+  std::string dest;
+  for (auto _ : state) {
+    dest.clear();
+    const std::string& value = values[index++ % kValues];
+    OrderedCode::WriteString(&dest, value);
+    total_bytes += static_cast<int64_t>(value.size());
+    benchmark::DoNotOptimize(dest);
+  }
+  state.SetBytesProcessed(total_bytes);
+}
+BENCHMARK(BM_WriteString)->Arg(4)->Arg(10)->Arg(20);
+
+static void BM_ReadString(benchmark::State& state) {
+  const int kValues = 1024;
+  std::vector<std::string> encoded(kValues);
+  for (int i = 0; i < kValues; ++i) {
+    OrderedCode::WriteString(
+        &encoded[i],
+        CreateAutoId().substr(0, static_cast<size_t>(state.range(0))));
+  }
+
+  int index = 0;
+  int64_t total_bytes = 0;
+  std::string result;
+  for (auto _ : state) {
+    result.clear();
+    absl::string_view src = encoded[index++ % kValues];
+    OrderedCode::ReadString(&src, &result);
+    total_bytes += static_cast<int64_t>(result.size());
+  }
+  state.SetBytesProcessed(total_bytes);
+}
+BENCHMARK(BM_ReadString)->Arg(4)->Arg(10)->Arg(20);
+
+static void BM_WriteDocumentKey(benchmark::State& state) {
+  const int kValues = 1024;
+  std::vector<std::vector<std::string>> paths =
+      MakeDocumentPaths(kValues, state.range(0));
+
+  int index = 0;
+  int64_t total_bytes = 0;
+  for (auto _ : state) {
+    std::string key;
+    WriteDocumentKey(&key, paths[index++ % kValues]);
+    total_bytes += static_cast<int64_t>(key.size());
+    benchmark::DoNotOptimize(key);
+  }
+  state.SetBytesProcessed(total_bytes);
+}
+BENCHMARK(BM_WriteDocumentKey)->Arg(1)->Arg(3)->Arg(6);
+
+static void BM_ReadDocumentKey(benchmark::State& state) {
+  const int kValues = 1024;
+  std::vector<std::vector<std::string>> paths =
+      MakeDocumentPaths(kValues, state.range(0));
+  std::vector<std::string> keys(kValues);
+  for (int i = 0; i < kValues; ++i) {
+    WriteDocumentKey(&keys[i], paths[i]);
+  }
+
+  int index = 0;
+  int64_t total_bytes = 0;
+  for (auto _ : state) {
+    const std::string& key = keys[index++ % kValues];
+    absl::string_view src = key;
+    int64_t label = 0;
+    int64_t table_id = 0;
+    OrderedCode::ReadSignedNumIncreasing(&src, &label);
+    OrderedCode::ReadSignedNumIncreasing(&src, &table_id);
+
+    std::vector<std::string> segments;
+    while (OrderedCode::ReadSignedNumIncreasing(&src, &label) &&
+           label == kPathSegmentLabel) {
+      segments.emplace_back();
+      OrderedCode::ReadString(&src, &segments.back());
+    }
+    total_bytes += static_cast<int64_t>(key.size());
+    benchmark::DoNotOptimize(segments);
+  }
+  state.SetBytesProcessed(total_bytes);
+}
+BENCHMARK(BM_ReadDocumentKey)->Arg(1)->Arg(3)->Arg(6);
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/util/phase_timer.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+TEST(PhaseTimerTest, MeasuresEachPhase) {
+  PhaseTimer timer;
+  std::this_thread::sleep_for(milliseconds(20));
+  microseconds first = timer.EndPhase();
+  microseconds second = timer.EndPhase();
+
+  EXPECT_GE(first, milliseconds(20));
+  EXPECT_LT(second, first);
+}
+
+TEST(PhaseTimerTest, PhasesAddUpToTheWholeOperation) {
+  PhaseTimer::Clock::time_point start = PhaseTimer::Clock::now();
+  PhaseTimer timer;
+  microseconds total{0};
+  for (int i = 0; i < 3; ++i) {
+    std::this_thread::sleep_for(milliseconds(5));
+    total += timer.EndPhase();
+  }
+  PhaseTimer::Clock::duration elapsed = PhaseTimer::Clock::now() - start;
+
+  EXPECT_GE(total, milliseconds(15));
+  EXPECT_LE(total, elapsed);
+}
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
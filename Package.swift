@@ -1435,6 +1435,7 @@ func firestoreTargets() -> [Target] {
           ),
           .linkedFramework("UIKit", .when(platforms: [.iOS, .tvOS, .firebaseVisionOS])),
           .linkedLibrary("c++"),
+          .linkedLibrary("z"),
         ]
       ),
       .target(